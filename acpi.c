@@ -0,0 +1,184 @@
+/*
+ * acpi.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "acpi.h"
+#include "memory.h"
+#include "vmm.h"
+#include "stdlib.h"
+#include "string.h"
+#include "display.h"
+
+#define EBDA_SEGMENT_PTR	0x40E	//Enthält das Segment der Extended BIOS Data Area
+#define BIOS_AREA_START		0xE0000
+#define BIOS_AREA_END		0x100000
+
+typedef struct{
+		char Signature[8];
+		uint8_t Checksum;
+		char OEMID[6];
+		uint8_t Revision;
+		uint32_t RsdtAddress;
+		//Ab Revision 2
+		uint32_t Length;
+		uint64_t XsdtAddress;
+		uint8_t ExtendedChecksum;
+		uint8_t reserved[3];
+}__attribute__((packed)) rsdp_t;
+
+static acpi_header_t *rootTable = NULL;		//RSDT oder XSDT
+static size_t rootEntrySize;				//4 Bytes bei der RSDT, 8 Bytes bei der XSDT
+
+static uint8_t checksum(const void *data, size_t length)
+{
+	const uint8_t *bytes = data;
+	uint8_t sum = 0;
+	size_t i;
+	for(i = 0; i < length; i++)
+		sum += bytes[i];
+	return sum;
+}
+
+/*
+ * Sucht den RSDP in einem Speicherbereich unter 1MB (ist 1:1 gemappt)
+ */
+static rsdp_t *searchRSDP(uintptr_t start, uintptr_t end)
+{
+	uintptr_t addr;
+	//Der RSDP liegt immer an einer 16-Byte-Grenze
+	for(addr = start & ~0xF; addr + sizeof(rsdp_t) <= end; addr += 16)
+	{
+		rsdp_t *rsdp = (rsdp_t*)addr;
+		if(memcmp(rsdp->Signature, "RSD PTR ", 8) == 0 && checksum(rsdp, 20) == 0)
+			return rsdp;
+	}
+	return NULL;
+}
+
+/*
+ * Mappt einen physischen Speicherbereich in den Kernelspace
+ */
+static void *mapPhys(paddr_t phys, size_t size)
+{
+	size_t offset = phys % MM_BLOCK_SIZE;
+	size_t pages = (offset + size + MM_BLOCK_SIZE - 1) / MM_BLOCK_SIZE;
+	void *virt = getFreePages((void*)KERNELSPACE_START, (void*)KERNELSPACE_END, pages);
+	size_t i;
+
+	if(virt == NULL)
+		return NULL;
+	for(i = 0; i < pages; i++)
+		vmm_Map(virt + i * MM_BLOCK_SIZE, phys - offset + i * MM_BLOCK_SIZE, VMM_FLAGS_GLOBAL | VMM_FLAGS_NX, 0);
+	return virt + offset;
+}
+
+static void unmapPhys(void *virt, size_t size)
+{
+	size_t offset = (uintptr_t)virt % MM_BLOCK_SIZE;
+	vmm_SysUnMap(virt - offset, (offset + size + MM_BLOCK_SIZE - 1) / MM_BLOCK_SIZE);
+}
+
+/*
+ * Kopiert eine Tabelle in den Heap, da die ACPI-Tabellen irgendwo im physischen Speicher liegen
+ * Parameter:	phys = physische Adresse der Tabelle
+ * Rückgabe:	Kopie der Tabelle oder NULL, wenn die Prüfsumme nicht stimmt
+ */
+static acpi_header_t *copyTable(paddr_t phys)
+{
+	acpi_header_t *header, *table;
+	uint32_t length;
+
+	header = mapPhys(phys, sizeof(acpi_header_t));
+	if(header == NULL)
+		return NULL;
+	length = header->Length;
+	unmapPhys(header, sizeof(acpi_header_t));
+	if(length < sizeof(acpi_header_t))
+		return NULL;
+
+	header = mapPhys(phys, length);
+	if(header == NULL)
+		return NULL;
+	table = malloc(length);
+	if(table != NULL)
+		memcpy(table, header, length);
+	unmapPhys(header, length);
+
+	if(table != NULL && checksum(table, length) != 0)
+	{
+		free(table);
+		return NULL;
+	}
+	return table;
+}
+
+/*
+ * Sucht den RSDP und lädt die Root-Tabelle (XSDT, wenn vorhanden, sonst RSDT)
+ * Rückgabe:	true, wenn ACPI verfügbar ist
+ */
+bool acpi_Init(void)
+{
+	rsdp_t *rsdp;
+	uintptr_t ebda = (uintptr_t)*(uint16_t*)EBDA_SEGMENT_PTR << 4;
+
+	//Der RSDP liegt im ersten KB der EBDA oder im BIOS-Bereich
+	rsdp = ebda ? searchRSDP(ebda, ebda + 1024) : NULL;
+	if(rsdp == NULL)
+		rsdp = searchRSDP(BIOS_AREA_START, BIOS_AREA_END);
+	if(rsdp == NULL)
+	{
+		SysLogError("ACPI", "RSDP nicht gefunden");
+		return false;
+	}
+
+	if(rsdp->Revision >= 2 && rsdp->XsdtAddress != 0 && checksum(rsdp, rsdp->Length) == 0)
+	{
+		rootTable = copyTable(rsdp->XsdtAddress);
+		rootEntrySize = sizeof(uint64_t);
+	}
+	if(rootTable == NULL)
+	{
+		rootTable = copyTable(rsdp->RsdtAddress);
+		rootEntrySize = sizeof(uint32_t);
+	}
+	if(rootTable == NULL)
+	{
+		SysLogError("ACPI", "Root-Tabelle ungültig");
+		return false;
+	}
+
+	SysLog("ACPI", "Initialisierung abgeschlossen");
+	return true;
+}
+
+acpi_header_t *acpi_findTable(const char *signature)
+{
+	size_t count, i;
+
+	if(rootTable == NULL)
+		return NULL;
+
+	count = (rootTable->Length - sizeof(acpi_header_t)) / rootEntrySize;
+	for(i = 0; i < count; i++)
+	{
+		void *entry = (void*)(rootTable + 1) + i * rootEntrySize;
+		paddr_t phys = (rootEntrySize == sizeof(uint64_t)) ? *(uint64_t*)entry : *(uint32_t*)entry;
+		acpi_header_t *header = mapPhys(phys, sizeof(acpi_header_t));
+		bool found;
+
+		if(header == NULL)
+			continue;
+		found = memcmp(header->Signature, signature, 4) == 0;
+		unmapPhys(header, sizeof(acpi_header_t));
+		if(found)
+			return copyTable(phys);
+	}
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * acpi.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef ACPI_H_
+#define ACPI_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+typedef struct{
+		char Signature[4];
+		uint32_t Length;
+		uint8_t Revision;
+		uint8_t Checksum;
+		char OEMID[6];
+		char OEMTableID[8];
+		uint32_t OEMRevision;
+		uint32_t CreatorID;
+		uint32_t CreatorRevision;
+}__attribute__((packed)) acpi_header_t;
+
+bool acpi_Init(void);
+
+/*
+ * Sucht eine ACPI-Tabelle
+ * Parameter:	signature = Signatur der Tabelle (4 Zeichen)
+ * Rückgabe:	Kopie der Tabelle, muss mit free freigegeben werden. NULL wenn die Tabelle nicht existiert.
+ */
+acpi_header_t *acpi_findTable(const char *signature);
+
+#endif /* ACPI_H_ */
+
+#endif
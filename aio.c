@@ -0,0 +1,221 @@
+/*
+ * aio.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "aio.h"
+#include "vfs.h"
+#include "pit.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "stdlib.h"
+#include "semaphore.h"
+#include "list.h"
+
+typedef struct{
+	uint64_t user_data;
+	uint64_t deadline;		//Uptime, bei der der Timeout abläuft
+}aio_timeout_t;
+
+struct aio_context{
+	ioring_t *ring;
+	ioring_cqe_t *cqes;		//Wird beim Anmelden berechnet, ring->entries ist vom Prozess beschreibbar
+	uint32_t mask;
+	list_t timeouts;		//Ausstehende Timeouts
+	semaphore_t lock;		//Serialisiert aio_enter, wird auch während der I/O gehalten
+};
+
+static void aio_freeContext(struct aio_context *ctx)
+{
+	aio_timeout_t *timeout;
+	while((timeout = list_pop(ctx->timeouts)))
+		free(timeout);
+	list_destroy(ctx->timeouts);
+	semaphore_destroy(&ctx->lock);
+	free(ctx);
+}
+
+int64_t aio_setup(ioring_t *ring, uint32_t entries)
+{
+	if(entries == 0 || entries > IORING_MAX_ENTRIES || (entries & (entries - 1)))
+		return -1;
+	if((uintptr_t)ring < USERSPACE_START || (uintptr_t)ring > USERSPACE_END - IORING_SIZE(entries)
+			|| ((uintptr_t)ring & (MM_BLOCK_SIZE - 1)))
+		return -1;
+
+	//Der Ring kann nicht ausgetauscht werden, solange ein anderer Thread damit arbeiten könnte
+	if(currentProcess->aio != NULL)
+		return -1;
+
+	struct aio_context *ctx = malloc(sizeof(*ctx));
+	if(ctx == NULL)
+		return -1;
+	ctx->ring = ring;
+	ctx->mask = entries - 1;
+	ctx->cqes = IORING_CQES_N(ring, entries);
+	ctx->timeouts = list_create();
+	semaphore_init(&ctx->lock, 1);
+
+	ring->sq_head = ring->sq_tail = 0;
+	ring->cq_head = ring->cq_tail = 0;
+	ring->entries = entries;
+
+	//Erst sichtbar machen, wenn der Ring initialisiert ist
+	asm volatile("" : : : "memory");
+	if(!__sync_bool_compare_and_swap(&currentProcess->aio, NULL, ctx))
+	{
+		aio_freeContext(ctx);
+		return -1;
+	}
+
+	return 0;
+}
+
+static bool aio_complete(struct aio_context *ctx, uint64_t user_data, int64_t result)
+{
+	ioring_t *ring = ctx->ring;
+	uint32_t tail = ring->cq_tail;
+	if(tail - ring->cq_head > ctx->mask)
+		return false;
+
+	ioring_cqe_t *cqe = &ctx->cqes[tail & ctx->mask];
+	cqe->user_data = user_data;
+	cqe->result = result;
+	//Das Ergebnis muss geschrieben sein, bevor der Prozess es sieht
+	asm volatile("" : : : "memory");
+	ring->cq_tail = tail + 1;
+	return true;
+}
+
+static int64_t aio_execute(const ioring_sqe_t *sqe)
+{
+	switch(sqe->opcode)
+	{
+		case IORING_OP_NOP:
+			return 0;
+		case IORING_OP_READ:
+			return vfs_syscall_read(sqe->stream, sqe->offset, sqe->length, (void*)sqe->addr);
+		case IORING_OP_WRITE:
+			return vfs_syscall_write(sqe->stream, sqe->offset, sqe->length, (const void*)sqe->addr);
+		case IORING_OP_OPEN:
+		{
+			vfs_mode_t mode = {
+					.read = !!(sqe->open_flags & IORING_OPEN_READ),
+					.write = !!(sqe->open_flags & IORING_OPEN_WRITE),
+					.append = !!(sqe->open_flags & IORING_OPEN_APPEND),
+					.empty = !!(sqe->open_flags & IORING_OPEN_EMPTY),
+					.create = !!(sqe->open_flags & IORING_OPEN_CREATE),
+					.directory = !!(sqe->open_flags & IORING_OPEN_DIRECTORY)
+			};
+			return vfs_syscall_open((const char*)sqe->addr, mode);
+		}
+		case IORING_OP_CLOSE:
+			vfs_syscall_close(sqe->stream);
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+/*
+ * Schliesst alle abgelaufenen Timeouts ab
+ * Rückgabe:	Anzahl abgeschlossener Timeouts
+ */
+static uint32_t aio_expireTimeouts(struct aio_context *ctx, uint64_t *next_deadline)
+{
+	uint64_t now = pit_getUptime();
+	uint32_t completed = 0;
+	list_iterator_t it;
+	aio_timeout_t *timeout;
+
+	*next_deadline = -1ul;
+	list_foreach(ctx->timeouts, it, timeout)
+	{
+		if(timeout->deadline <= now)
+		{
+			if(!aio_complete(ctx, timeout->user_data, 0))
+				break;
+			list_iterator_remove(&it);
+			free(timeout);
+			completed++;
+		}
+		else if(timeout->deadline < *next_deadline)
+			*next_deadline = timeout->deadline;
+	}
+	return completed;
+}
+
+int64_t aio_enter(uint32_t min_complete)
+{
+	struct aio_context *ctx = currentProcess->aio;
+	if(ctx == NULL)
+		return -1;
+
+	ioring_t *ring = ctx->ring;
+	int64_t submitted = 0;
+	uint32_t completed = 0;
+	uint64_t next_deadline;
+
+	semaphore_acquire(&ctx->lock);
+	while(1)
+	{
+		//Alle eingetragenen Aufträge abarbeiten, solange in der Completion-Queue Platz ist
+		uint32_t head = ring->sq_head;
+		uint32_t tail = ring->sq_tail;
+		asm volatile("" : : : "memory");
+		while(head != tail && ring->cq_tail - ring->cq_head <= ctx->mask)
+		{
+			ioring_sqe_t sqe = ring->sqes[head & ctx->mask];
+			head++;
+			submitted++;
+
+			if(sqe.opcode == IORING_OP_TIMEOUT)
+			{
+				aio_timeout_t *timeout = malloc(sizeof(*timeout));
+				if(timeout != NULL)
+				{
+					uint64_t now = pit_getUptime();
+					timeout->user_data = sqe.user_data;
+					timeout->deadline = (now + sqe.length < now) ? -1ul : now + sqe.length;
+					list_push(ctx->timeouts, timeout);
+					continue;
+				}
+				aio_complete(ctx, sqe.user_data, -1);
+			}
+			else
+				aio_complete(ctx, sqe.user_data, aio_execute(&sqe));
+			completed++;
+		}
+		ring->sq_head = head;
+
+		completed += aio_expireTimeouts(ctx, &next_deadline);
+
+		//Warten lohnt sich nur, wenn noch ein Timeout aussteht
+		if(completed >= min_complete || next_deadline == -1ul)
+			break;
+
+		semaphore_release(&ctx->lock);
+		uint64_t now = pit_getUptime();
+		if(next_deadline > now)
+			pit_RegisterTimer(currentThread, next_deadline - now);
+		semaphore_acquire(&ctx->lock);
+	}
+	semaphore_release(&ctx->lock);
+
+	return submitted;
+}
+
+void aio_destroy(process_t *process)
+{
+	if(process->aio != NULL)
+	{
+		aio_freeContext(process->aio);
+		process->aio = NULL;
+	}
+}
+
+#endif
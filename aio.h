@@ -0,0 +1,37 @@
+/*
+ * aio.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef AIO_H_
+#define AIO_H_
+
+#include "stdint.h"
+#include "ioring.h"
+#include "pm.h"
+
+/*
+ * Meldet einen Ring für den aktuellen Prozess an. Pro Prozess kann nur ein Ring angemeldet werden.
+ * Parameter:	ring = Vom Prozess reservierter Speicher (pageausgerichtet, IORING_SIZE(entries) Bytes)
+ * 				entries = Anzahl Einträge pro Queue (Zweierpotenz, höchstens IORING_MAX_ENTRIES)
+ * Rückgabe:	0 bei Erfolg, -1 bei Fehler
+ */
+int64_t aio_setup(ioring_t *ring, uint32_t entries);
+
+/*
+ * Arbeitet alle eingetragenen Aufträge ab und wartet bis mindestens min_complete Aufträge
+ * abgeschlossen sind (nur abgelaufene Timeouts können noch ausstehen).
+ * Rückgabe:	Anzahl abgearbeiteter SQEs oder -1 wenn kein Ring angemeldet ist
+ */
+int64_t aio_enter(uint32_t min_complete);
+
+//Gibt die Daten des Rings eines Prozesses frei
+void aio_destroy(process_t *process);
+
+#endif /* AIO_H_ */
+
+#endif
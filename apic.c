@@ -13,6 +13,8 @@
 
 #define APIC_BASE_MSR	0x1B
 
+#define APIC_REG_ID 0x20
+#define APIC_REG_EOI 0xB0
 #define APIC_REG_SPIV 0xF0
 #define APIC_REG_ICR_LOW 0x300
 #define APIC_REG_ICR_HIGH 0x310
@@ -72,3 +74,19 @@ void apic_Write(uintptr_t offset, uint32_t value)
 	uint32_t *ptr = apic_base_virt + offset;
 	*ptr = value;
 }
+
+/*
+ * Gibt die ID des Local APICs der aktuellen CPU zurück
+ */
+uint8_t apic_getID()
+{
+	return apic_Read(APIC_REG_ID) >> 24;
+}
+
+/*
+ * Sendet den EOI (End of Interrupt) an den Local APIC
+ */
+void apic_EOI()
+{
+	apic_Write(APIC_REG_EOI, 0);
+}
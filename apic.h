@@ -15,5 +15,7 @@ void apic_Init();
 bool apic_available();
 uint32_t apic_Read(uintptr_t offset);
 void apic_Write(uintptr_t offset, uint32_t value);
+uint8_t apic_getID();
+void apic_EOI();
 
 #endif /* APIC_H_ */
@@ -0,0 +1,702 @@
+/*
+ * blkqueue.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "blkqueue.h"
+#include "ilist.h"
+#include "lock.h"
+#include "lockstat.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "pit.h"
+#include "workqueue.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdio.h"
+
+#define BLKQUEUE_BUFFER_SIZE	(64 * 1024)	//Maximale Grösse einer Anfrage an das Gerät
+#define BLKQUEUE_POOL_MAX		16			//So viele freie Puffer werden aufbewahrt
+#define BLKQUEUE_BATCH			16			//So viele Aufträge gibt ein Thread gleichzeitig auf
+#define BLKQUEUE_DEPTH			8			//Gleichzeitige Anfragen an Treiber mit asynchroner Schnittstelle
+#define BLKQUEUE_READ_DEADLINE	500			//Frist für Leseanfragen in ms
+#define BLKQUEUE_WRITE_DEADLINE	5000		//Frist für Schreibanfragen in ms
+
+#define MIN(val1, val2) ((val1 < val2) ? val1 : val2)
+#define MAX(val1, val2) ((val1 > val2) ? val1 : val2)
+
+typedef enum{
+	BLKQUEUE_PENDING, BLKQUEUE_DISPATCHED, BLKQUEUE_DONE
+}blkqueue_state_t;
+
+//Anfrage an das Gerät, kann mehrere Aufträge umfassen
+typedef struct{
+	blkqueue_t *queue;
+	bool write;
+	uint64_t start;
+	uint64_t count;
+	void *buffer;				//Aus dem Pool, BLKQUEUE_BUFFER_SIZE Bytes
+	uint64_t deadline;			//Uptime, ab der die Anfrage vorgezogen wird
+	volatile blkqueue_state_t state;
+	int result;
+	size_t copying;				//Anzahl Aufträge, die ihre Daten noch in den Puffer kopieren
+	size_t refcount;			//Anzahl Aufträge, die noch nicht freigegeben wurden
+	ilist_t bios;
+	ilist_node_t node;			//In der Warteschlange, sortiert nach Startblock
+	ilist_node_t fifo;			//Sortiert nach Frist
+	struct cdi_storage_request cdi;
+}blkqueue_request_t;
+
+//Auftrag eines Threads, liegt auf dessen Stack
+typedef struct{
+	blkqueue_request_t *request;
+	thread_t *thread;			//Schlafender Thread oder NULL
+	uint64_t start;
+	uint64_t count;
+	ilist_node_t node;
+}blkqueue_bio_t;
+
+typedef struct{
+	uint64_t bios;
+	uint64_t merges;
+	uint64_t requests;
+	uint64_t reads;
+	uint64_t writes;
+	uint64_t expired;
+	uint64_t busy;
+	uint64_t errors;
+	uint64_t queued_sum;		//Summe der Warteschlangenlänge bei jedem Auftrag
+	uint64_t queued_max;
+	uint64_t inflight_max;
+}blkqueue_stats_t;
+
+struct blkqueue{
+	struct cdi_storage_device *device;
+	spinlock_t lock;			//Wird auch im Interruptkontext verwendet
+	ilist_t pending;
+	ilist_t fifo;
+	uint64_t position;			//Block nach der zuletzt ausgegebenen Anfrage
+	size_t inflight;
+	size_t depth;
+	work_t dispatch;			//Gibt nach einem Abschluss die nächsten Anfragen an das Gerät
+	ilist_node_t node;
+	blkqueue_stats_t stats;
+};
+
+static ilist_t queues = ILIST_INIT(queues);
+static lock_t queues_lock = LOCK_UNLOCKED;
+
+static void *pool[BLKQUEUE_POOL_MAX];
+static size_t pool_count = 0;
+static lock_t pool_lock = LOCK_UNLOCKED;
+static uint64_t pool_hits, pool_misses;
+
+static void *blkqueue_getBuffer(void)
+{
+	void *buffer = NULL;
+
+	lock(&pool_lock);
+	if(pool_count > 0)
+	{
+		buffer = pool[--pool_count];
+		pool_hits++;
+	}
+	else
+		pool_misses++;
+	unlock(&pool_lock);
+
+	if(buffer == NULL)
+		buffer = malloc(BLKQUEUE_BUFFER_SIZE);
+	return buffer;
+}
+
+static void blkqueue_putBuffer(void *buffer)
+{
+	lock(&pool_lock);
+	if(pool_count < BLKQUEUE_POOL_MAX)
+	{
+		pool[pool_count++] = buffer;
+		buffer = NULL;
+	}
+	unlock(&pool_lock);
+
+	free(buffer);
+}
+
+/*
+ * Verteilt zusammenhängende Daten auf mehrere Puffer
+ * Parameter:	data = Quelldaten
+ * 				offset = Position in den Puffern, ab der geschrieben wird
+ * 				size = Anzahl Bytes
+ * 				iov = Puffer
+ * 				count = Anzahl Puffer
+ */
+static void scatter(const void *data, size_t offset, size_t size, const vfs_iovec_t *iov, size_t count)
+{
+	size_t i;
+	for(i = 0; i < count && size > 0; i++)
+	{
+		if(offset >= iov[i].length)
+		{
+			offset -= iov[i].length;
+			continue;
+		}
+		size_t length = MIN(iov[i].length - offset, size);
+		memcpy(iov[i].base + offset, data, length);
+		data += length;
+		size -= length;
+		offset = 0;
+	}
+}
+
+//Sammelt Daten aus mehreren Puffern, Gegenstück zu scatter
+static void gather(void *data, size_t offset, size_t size, const vfs_iovec_t *iov, size_t count)
+{
+	size_t i;
+	for(i = 0; i < count && size > 0; i++)
+	{
+		if(offset >= iov[i].length)
+		{
+			offset -= iov[i].length;
+			continue;
+		}
+		size_t length = MIN(iov[i].length - offset, size);
+		memcpy(data, iov[i].base + offset, length);
+		data += length;
+		size -= length;
+		offset = 0;
+	}
+}
+
+static void blkqueue_freeRequest(blkqueue_request_t *request)
+{
+	blkqueue_putBuffer(request->buffer);
+	free(request);
+}
+
+//queue->lock muss gehalten werden
+static void blkqueue_insert(blkqueue_t *queue, blkqueue_request_t *request)
+{
+	ilist_node_t *node;
+
+	ilist_foreach(node, &queue->pending)
+	{
+		if(ILIST_ENTRY(node, blkqueue_request_t, node)->start > request->start)
+			break;
+	}
+	ilist_insert_before(&queue->pending, node, &request->node);
+
+	//Leseanfragen haben eine kürzere Frist und können deshalb vor Schreibanfragen kommen
+	for(node = ilist_last(&queue->fifo); node != NULL && node != &queue->fifo.head; node = node->prev)
+	{
+		if(ILIST_ENTRY(node, blkqueue_request_t, fifo)->deadline <= request->deadline)
+			break;
+	}
+	ilist_insert_before(&queue->fifo, (node == NULL) ? &queue->fifo.head : node->next, &request->fifo);
+}
+
+/*
+ * Sucht eine wartende Anfrage, an die ein Auftrag angehängt werden kann.
+ * queue->lock muss gehalten werden.
+ */
+static blkqueue_request_t *blkqueue_findMerge(blkqueue_t *queue, bool write, uint64_t start, uint64_t count)
+{
+	uint64_t max_count = BLKQUEUE_BUFFER_SIZE / queue->device->block_size;
+	ilist_node_t *node;
+
+	ilist_foreach(node, &queue->pending)
+	{
+		blkqueue_request_t *request = ILIST_ENTRY(node, blkqueue_request_t, node);
+		if(request->start > start)
+			break;
+		if(request->write == write && request->start + request->count == start
+				&& request->count + count <= max_count)
+			return request;
+	}
+	return NULL;
+}
+
+/*
+ * Wählt die nächste Anfrage für das Gerät aus. Zuerst kommen Anfragen mit abgelaufener Frist,
+ * sonst die nächste Anfrage ab der aktuellen Position. Am Ende wird wieder vorne begonnen.
+ * queue->lock muss gehalten werden.
+ */
+static blkqueue_request_t *blkqueue_next(blkqueue_t *queue)
+{
+	blkqueue_request_t *first = NULL;
+	ilist_node_t *node;
+
+	ilist_foreach(node, &queue->fifo)
+	{
+		blkqueue_request_t *request = ILIST_ENTRY(node, blkqueue_request_t, fifo);
+		if(request->copying > 0)
+			continue;
+		if(request->deadline <= pit_getUptime())
+		{
+			queue->stats.expired++;
+			return request;
+		}
+		break;
+	}
+
+	ilist_foreach(node, &queue->pending)
+	{
+		blkqueue_request_t *request = ILIST_ENTRY(node, blkqueue_request_t, node);
+		if(request->copying > 0)
+			continue;
+		if(request->start >= queue->position)
+			return request;
+		if(first == NULL)
+			first = request;
+	}
+	return first;
+}
+
+//Weckt den Thread eines Auftrags, queue->lock muss gehalten werden
+static bool blkqueue_wake(blkqueue_bio_t *bio)
+{
+	if(bio->thread == NULL)
+		return false;
+	thread_unblock(bio->thread);
+	bio->thread = NULL;
+	return true;
+}
+
+//Wird vom Treiber aufgerufen, eventuell im Interruptkontext
+static void blkqueue_complete(struct cdi_storage_request *cdi)
+{
+	blkqueue_request_t *request = cdi->opaque;
+	blkqueue_t *queue = request->queue;
+	ilist_node_t *node, *bio_node;
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	request->result = cdi->result;
+	request->state = BLKQUEUE_DONE;
+	queue->inflight--;
+	if(cdi->result)
+		queue->stats.errors++;
+
+	ilist_foreach(bio_node, &request->bios)
+		blkqueue_wake(ILIST_ENTRY(bio_node, blkqueue_bio_t, node));
+
+	//Einen wartenden Thread wecken, damit er die nächste Anfrage an das Gerät gibt
+	ilist_foreach(node, &queue->pending)
+	{
+		bool woken = false;
+		blkqueue_request_t *pending = ILIST_ENTRY(node, blkqueue_request_t, node);
+		ilist_foreach(bio_node, &pending->bios)
+		{
+			if((woken = blkqueue_wake(ILIST_ENTRY(bio_node, blkqueue_bio_t, node))))
+				break;
+		}
+		if(woken)
+			break;
+	}
+	spin_unlock_irqrestore(&queue->lock, flags);
+
+	//Asynchrone Treiber bekommen die nächste Anfrage sofort, ohne dass ein geweckter Thread laufen muss
+	if(queue->depth > 1)
+		workqueue_queue(NULL, &queue->dispatch);
+}
+
+//Gibt Anfragen an das Gerät, bis es ausgelastet ist
+static void blkqueue_run(blkqueue_t *queue)
+{
+	while(true)
+	{
+		uint64_t flags = spin_lock_irqsave(&queue->lock);
+		blkqueue_request_t *request = NULL;
+		if(queue->inflight < queue->depth)
+			request = blkqueue_next(queue);
+		if(request == NULL)
+		{
+			spin_unlock_irqrestore(&queue->lock, flags);
+			return;
+		}
+
+		ilist_remove(&queue->pending, &request->node);
+		ilist_remove(&queue->fifo, &request->fifo);
+		request->state = BLKQUEUE_DISPATCHED;
+		queue->position = request->start + request->count;
+		queue->stats.requests++;
+		if(request->write)
+			queue->stats.writes++;
+		else
+			queue->stats.reads++;
+		if(++queue->inflight > queue->stats.inflight_max)
+			queue->stats.inflight_max = queue->inflight;
+		spin_unlock_irqrestore(&queue->lock, flags);
+
+		request->cdi = (struct cdi_storage_request){
+				.device = queue->device,
+				.write = request->write,
+				.start = request->start,
+				.count = request->count,
+				.buffer = request->buffer,
+				.result = -1,
+				.complete = blkqueue_complete,
+				.opaque = request
+		};
+		int status = cdi_storage_submit(&request->cdi);
+		if(status == CDI_STORAGE_BUSY)
+		{
+			//Das Gerät ist belegt, die Anfrage wird später nochmals versucht
+			flags = spin_lock_irqsave(&queue->lock);
+			request->state = BLKQUEUE_PENDING;
+			queue->inflight--;
+			queue->stats.requests--;
+			if(request->write)
+				queue->stats.writes--;
+			else
+				queue->stats.reads--;
+			queue->stats.busy++;
+			blkqueue_insert(queue, request);
+			spin_unlock_irqrestore(&queue->lock, flags);
+			return;
+		}
+		if(status != 0)
+			cdi_storage_request_complete(&request->cdi, -1);
+	}
+}
+
+static void blkqueue_dispatch(void *opaque)
+{
+	blkqueue_run(opaque);
+}
+
+/*
+ * Hängt einen Auftrag an eine wartende Anfrage an oder erstellt eine neue Anfrage.
+ * Parameter:	queue = Warteschlange
+ * 				bio = Auftrag
+ * 				write = true für Schreibaufträge
+ * 				start = erster Block
+ * 				count = Anzahl Blöcke (höchstens BLKQUEUE_BUFFER_SIZE Bytes)
+ * 				iov, iov_count, offset = Daten für Schreibaufträge
+ * Rückgabe:	true bei Erfolg
+ */
+static bool blkqueue_submit(blkqueue_t *queue, blkqueue_bio_t *bio, bool write, uint64_t start, uint64_t count,
+		const vfs_iovec_t *iov, size_t iov_count, size_t offset)
+{
+	uint64_t block_size = queue->device->block_size;
+	blkqueue_request_t *request, *new = NULL;
+	uint64_t flags;
+
+	bio->thread = NULL;
+	bio->start = start;
+	bio->count = count;
+
+	flags = spin_lock_irqsave(&queue->lock);
+	request = blkqueue_findMerge(queue, write, start, count);
+	if(request == NULL)
+	{
+		//Speicher ausserhalb des Locks reservieren
+		spin_unlock_irqrestore(&queue->lock, flags);
+		new = malloc(sizeof(blkqueue_request_t));
+		if(new == NULL)
+			return false;
+		new->buffer = blkqueue_getBuffer();
+		if(new->buffer == NULL)
+		{
+			free(new);
+			return false;
+		}
+		new->queue = queue;
+		new->write = write;
+		new->start = start;
+		new->count = 0;
+		new->deadline = pit_getUptime() + (write ? BLKQUEUE_WRITE_DEADLINE : BLKQUEUE_READ_DEADLINE);
+		new->state = BLKQUEUE_PENDING;
+		new->result = -1;
+		new->copying = 0;
+		new->refcount = 0;
+		ilist_init(&new->bios);
+
+		flags = spin_lock_irqsave(&queue->lock);
+		//Inzwischen könnte eine passende Anfrage dazugekommen sein
+		request = blkqueue_findMerge(queue, write, start, count);
+		if(request == NULL)
+		{
+			request = new;
+			new = NULL;
+			blkqueue_insert(queue, request);
+		}
+	}
+	if(request->count > 0)
+		queue->stats.merges++;
+	request->count += count;
+	request->refcount++;
+	if(write)
+		request->copying++;
+	ilist_push_back(&request->bios, &bio->node);
+	bio->request = request;
+
+	queue->stats.bios++;
+	queue->stats.queued_sum += ilist_size(&queue->pending);
+	if(ilist_size(&queue->pending) > queue->stats.queued_max)
+		queue->stats.queued_max = ilist_size(&queue->pending);
+	spin_unlock_irqrestore(&queue->lock, flags);
+
+	if(new != NULL)
+		blkqueue_freeRequest(new);
+
+	if(write)
+	{
+		//Die Puffer können im Userspace liegen, deshalb ohne Lock kopieren. Solange copying
+		//nicht 0 ist, wird die Anfrage nicht an das Gerät gegeben.
+		gather(request->buffer + (start - request->start) * block_size, offset, count * block_size, iov, iov_count);
+		flags = spin_lock_irqsave(&queue->lock);
+		request->copying--;
+		spin_unlock_irqrestore(&queue->lock, flags);
+	}
+
+	return true;
+}
+
+/*
+ * Wartet bis die Anfrage eines Auftrags abgeschlossen ist
+ * Rückgabe:	0 bei Erfolg, -1 bei Fehler
+ */
+static int blkqueue_wait(blkqueue_t *queue, blkqueue_bio_t *bio)
+{
+	blkqueue_request_t *request = bio->request;
+	int result;
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	while(request->state != BLKQUEUE_DONE)
+	{
+		//Ohne laufende Anfragen weckt uns niemand, z.B. wenn das Gerät von jemand anderem belegt ist
+		if(queue->inflight > 0)
+		{
+			bio->thread = currentThread;
+			//Blockieren, bevor der Lock freigegeben wird, damit kein Aufwecken verloren geht
+			thread_block(currentThread);
+		}
+		spin_unlock_irqrestore(&queue->lock, flags);
+		yield();
+		blkqueue_run(queue);
+		flags = spin_lock_irqsave(&queue->lock);
+		bio->thread = NULL;
+	}
+	result = request->result;
+	spin_unlock_irqrestore(&queue->lock, flags);
+
+	return result;
+}
+
+//Gibt einen abgeschlossenen Auftrag frei
+static void blkqueue_release(blkqueue_t *queue, blkqueue_bio_t *bio)
+{
+	blkqueue_request_t *request = bio->request;
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	ilist_remove(&request->bios, &bio->node);
+	bool last = (--request->refcount == 0);
+	spin_unlock_irqrestore(&queue->lock, flags);
+
+	if(last)
+		blkqueue_freeRequest(request);
+}
+
+/*
+ * Überträgt den Bereich [start, start + size) mit mehreren gleichzeitigen Aufträgen. Beim
+ * Schreiben müssen start und size auf Blöcke ausgerichtet sein.
+ * Parameter:	queue = Warteschlange
+ * 				write = true für Schreibzugriffe
+ * 				start = Anfangsbyte
+ * 				size = Anzahl Bytes
+ * 				iov, count = Puffer
+ * 				offset = Position in den Puffern, die start entspricht
+ * Rückgabe:	true bei Erfolg
+ */
+static bool blkqueue_transfer(blkqueue_t *queue, bool write, uint64_t start, size_t size,
+		const vfs_iovec_t *iov, size_t count, size_t offset)
+{
+	uint64_t block_size = queue->device->block_size;
+	uint64_t block = start / block_size;
+	uint64_t end = (start + size + block_size - 1) / block_size;
+	uint64_t max_count = BLKQUEUE_BUFFER_SIZE / block_size;
+	blkqueue_bio_t bios[BLKQUEUE_BATCH];
+	bool success = true;
+
+	while(success && block < end)
+	{
+		size_t n, i;
+		for(n = 0; n < BLKQUEUE_BATCH && block < end; n++)
+		{
+			uint64_t blocks = MIN(max_count, end - block);
+			if(!blkqueue_submit(queue, &bios[n], write, block, blocks, iov, count, offset + block * block_size - start))
+			{
+				success = false;
+				break;
+			}
+			block += blocks;
+		}
+
+		blkqueue_run(queue);
+
+		for(i = 0; i < n; i++)
+		{
+			blkqueue_bio_t *bio = &bios[i];
+			if(blkqueue_wait(queue, bio))
+				success = false;
+			else if(!write)
+			{
+				//Nur den angeforderten Teil der Blöcke kopieren
+				uint64_t first = MAX(bio->start * block_size, start);
+				uint64_t last = MIN((bio->start + bio->count) * block_size, start + size);
+				scatter(bio->request->buffer + (bio->start - bio->request->start) * block_size + first - bio->start * block_size,
+						offset + first - start, last - first, iov, count);
+			}
+			blkqueue_release(queue, bio);
+		}
+	}
+
+	return success;
+}
+
+blkqueue_t *blkqueue_create(struct cdi_storage_device *device)
+{
+	struct cdi_storage_driver *driver = (struct cdi_storage_driver*)device->dev.driver;
+
+	if(device->block_size == 0 || device->block_size > BLKQUEUE_BUFFER_SIZE)
+		return NULL;
+
+	blkqueue_t *queue = calloc(1, sizeof(blkqueue_t));
+	if(queue == NULL)
+		return NULL;
+	queue->device = device;
+	queue->lock = SPINLOCK_UNLOCKED;
+	ilist_init(&queue->pending);
+	ilist_init(&queue->fifo);
+	//Synchrone Treiber sind nicht reentrant
+	queue->depth = (driver->submit != NULL) ? BLKQUEUE_DEPTH : 1;
+	work_init(&queue->dispatch, blkqueue_dispatch, queue);
+
+	lock(&queues_lock);
+	ilist_push_back(&queues, &queue->node);
+	unlock(&queues_lock);
+
+	return queue;
+}
+
+size_t blkqueue_read(blkqueue_t *queue, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	uint64_t end = queue->device->block_count * queue->device->block_size;
+	size_t size = 0, i;
+
+	for(i = 0; i < count; i++)
+		size += iov[i].length;
+	if(size == 0 || start >= end)
+		return 0;
+	size = MIN(size, end - start);
+
+	return blkqueue_transfer(queue, false, start, size, iov, count, 0) ? size : 0;
+}
+
+size_t blkqueue_write(blkqueue_t *queue, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	uint64_t block_size = queue->device->block_size;
+	uint64_t end = queue->device->block_count * block_size;
+	size_t size = 0, done = 0, i;
+	uint8_t *block = NULL;
+
+	for(i = 0; i < count; i++)
+		size += iov[i].length;
+	if(size == 0 || start >= end)
+		return 0;
+	size = MIN(size, end - start);
+
+	while(done < size)
+	{
+		uint64_t position = start + done;
+		size_t skip = position % block_size;
+		size_t length;
+
+		if(skip == 0 && size - done >= block_size)
+		{
+			//Ganze Blöcke direkt schreiben
+			length = (size - done) - (size - done) % block_size;
+			if(!blkqueue_transfer(queue, true, position, length, iov, count, done))
+				break;
+		}
+		else
+		{
+			//Teilweise geschriebene Blöcke zuerst lesen
+			if(block == NULL && (block = malloc(block_size)) == NULL)
+				break;
+			vfs_iovec_t block_iov = {.base = block, .length = block_size};
+			length = MIN(block_size - skip, size - done);
+			if(!blkqueue_transfer(queue, false, position - skip, block_size, &block_iov, 1, 0))
+				break;
+			gather(block + skip, done, length, iov, count);
+			if(!blkqueue_transfer(queue, true, position - skip, block_size, &block_iov, 1, 0))
+				break;
+		}
+		done += length;
+	}
+	free(block);
+
+	return (done == size) ? size : 0;
+}
+
+#define STATS_HEADER_FORMAT	"buffers: %lu pooled, %lu hits, %lu misses\n"
+#define STATS_QUEUE_FORMAT	"%s: queued %lu, in flight %lu/%lu (max %lu), requests %lu (%lu reads, %lu writes), "\
+		"bios %lu, merged %lu, expired %lu, busy %lu, errors %lu, queue length %lu.%lu avg %lu max\n"
+
+static size_t blkqueue_readStats(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	ilist_node_t *node;
+
+	//Jede Zahl hat höchstens 20 Stellen, die Kopfzeile enthält 3 und jede Queue 15 Zahlen
+	lock(&queues_lock);
+	size_t textSize = sizeof(STATS_HEADER_FORMAT) + 3 * 20;
+	ilist_foreach(node, &queues)
+		textSize += sizeof(STATS_QUEUE_FORMAT) + 15 * 20 + strlen(ILIST_ENTRY(node, blkqueue_t, node)->device->dev.name);
+	char *text = malloc(textSize);
+	if(text == NULL)
+	{
+		unlock(&queues_lock);
+		return 0;
+	}
+
+	lock(&pool_lock);
+	size_t size = sprintf(text, STATS_HEADER_FORMAT, pool_count, pool_hits, pool_misses);
+	unlock(&pool_lock);
+
+	ilist_foreach(node, &queues)
+	{
+		blkqueue_t *queue = ILIST_ENTRY(node, blkqueue_t, node);
+		uint64_t flags = spin_lock_irqsave(&queue->lock);
+		size_t queued = ilist_size(&queue->pending), inflight = queue->inflight;
+		blkqueue_stats_t stats = queue->stats;
+		spin_unlock_irqrestore(&queue->lock, flags);
+
+		uint64_t average = stats.bios ? stats.queued_sum * 10 / stats.bios : 0;
+		size += sprintf(text + size, STATS_QUEUE_FORMAT,
+				queue->device->dev.name, queued, inflight, queue->depth, stats.inflight_max, stats.requests,
+				stats.reads, stats.writes, stats.bios, stats.merges, stats.expired, stats.busy, stats.errors,
+				average / 10, average % 10, stats.queued_max);
+	}
+	unlock(&queues_lock);
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	free(text);
+	return read;
+}
+
+void blkqueue_Init(void)
+{
+	lockstat_register(&pool_lock, "blkqueue pool");
+	vfs_RegisterInfoFile("blockqueue", blkqueue_readStats, NULL);
+}
+
+#endif
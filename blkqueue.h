@@ -0,0 +1,57 @@
+/*
+ * blkqueue.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef BLKQUEUE_H_
+#define BLKQUEUE_H_
+
+#include "stdint.h"
+#include "stddef.h"
+#include "storage.h"
+#include "vfs.h"
+
+/*
+ * Warteschlange für die Anfragen an ein Blockgerät. Aufträge werden in Anfragen von höchstens
+ * BLKQUEUE_BUFFER_SIZE Bytes aufgeteilt, an eine wartende Anfrage mit anschliessenden Blöcken
+ * angehängt und nach dem Aufzugsverfahren (aufsteigende Blocknummern) an das Gerät gegeben.
+ * Anfragen, deren Frist abgelaufen ist, werden vorgezogen. Treiber mit asynchroner Schnittstelle
+ * bekommen mehrere Anfragen gleichzeitig.
+ * Die Statistik ist unter /sysinf/blockqueue abrufbar.
+ */
+
+typedef struct blkqueue blkqueue_t;
+
+void blkqueue_Init(void);
+
+//Erstellt die Warteschlange für ein Gerät
+blkqueue_t *blkqueue_create(struct cdi_storage_device *device);
+
+/*
+ * Liest zusammenhängende Daten in mehrere Puffer
+ * Parameter:	queue = Warteschlange des Geräts
+ * 				start = Anfangsbyte
+ * 				iov = Puffer, die nacheinander gefüllt werden
+ * 				count = Anzahl Puffer
+ * Rückgabe:	Anzahl gelesener Bytes, 0 bei Fehler
+ */
+size_t blkqueue_read(blkqueue_t *queue, uint64_t start, const vfs_iovec_t *iov, size_t count);
+
+/*
+ * Schreibt Daten aus mehreren Puffern zusammenhängend auf das Gerät. Teilweise geschriebene
+ * Blöcke werden vorher gelesen.
+ * Parameter:	queue = Warteschlange des Geräts
+ * 				start = Anfangsbyte
+ * 				iov = Puffer, die nacheinander geschrieben werden
+ * 				count = Anzahl Puffer
+ * Rückgabe:	Anzahl geschriebener Bytes, 0 bei Fehler
+ */
+size_t blkqueue_write(blkqueue_t *queue, uint64_t start, const vfs_iovec_t *iov, size_t count);
+
+#endif /* BLKQUEUE_H_ */
+
+#endif
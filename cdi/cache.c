@@ -9,6 +9,7 @@
 #include "stdbool.h"
 #include "lists.h"
 #include "stdlib.h"
+#include "trace.h"
 
 typedef struct{
 		struct cdi_cache_block block;
@@ -117,15 +118,20 @@ struct cdi_cache_block* cdi_cache_block_get(struct cdi_cache* cache,
 {
 	cache_t *c;
 	block_t *b;
+	cdi_list_iterator_t it;
 	c = (cache_t*)cache;
 
 	//Erst suchen, ob er nicht schon vorhanden ist
-	size_t i = 0;
-	while((b = cdi_list_get(c->blocks, i++)))
+	cdi_list_iterator_init(c->blocks, &it);
+	while((b = cdi_list_iterator_next(&it)))
 	{
 		if(b->block.number == blocknum)
+		{
+			TRACE(TRACE_CACHE_GET, blocknum, 1);
 			goto end;
+		}
 	}
+	TRACE(TRACE_CACHE_GET, blocknum, 0);
 
 	if(c->block_used < c->block_count)
 	{
@@ -140,8 +146,8 @@ struct cdi_cache_block* cdi_cache_block_get(struct cdi_cache* cache,
 	else
 	{
 		//Nach einem Block suchen, der nicht mehr verwendet wird
-		size_t i = 0;
-		while((b = cdi_list_get(c->blocks, i)))
+		cdi_list_iterator_init(c->blocks, &it);
+		while((b = cdi_list_iterator_next(&it)))
 		{
 			if(!b->ref_count)
 				break;
@@ -161,19 +167,18 @@ struct cdi_cache_block* cdi_cache_block_get(struct cdi_cache* cache,
 		{
 			//Fehler: Cacheblock wieder freigeben
 			block_t *tmp;
-			size_t i = 0;
-			while((tmp = cdi_list_get(c->blocks, i)))
+			cdi_list_iterator_init(c->blocks, &it);
+			while((tmp = cdi_list_iterator_next(&it)))
 			{
 				if(tmp == b)
 				{
 					free(b->block.data);
 					free(b->block.private);
 					free(b);
-					cdi_list_remove(c->blocks, i);
+					cdi_list_iterator_remove(&it);
 					c->block_used--;
 					return NULL;
 				}
-				i++;
 			}
 		}
 	}
@@ -206,9 +211,10 @@ int cdi_cache_sync(struct cdi_cache* cache)
 {
 	cache_t *c = (cache_t*)cache;
 	block_t *b;
-	size_t i = 0;
+	cdi_list_iterator_t it;
 
-	while((b = (block_t*)cdi_list_get(c->blocks, i++)))
+	cdi_list_iterator_init(c->blocks, &it);
+	while((b = (block_t*)cdi_list_iterator_next(&it)))
 	{
 		if(b->dirty)
 		{
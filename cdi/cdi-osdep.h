@@ -103,6 +103,8 @@ typedef struct
  * \endenglish
  */
 typedef struct {
+	//1 wenn der Speicher nicht zum Bereich gehört (cdi_mem_describe)
+	int borrowed;
 } cdi_mem_osdep;
 
 /**
@@ -62,3 +62,35 @@ size_t cdi_fs_data_write(struct cdi_fs_filesystem* fs, uint64_t start,
 {
 	return vfs_Write(fs->osdep.fp, start, size, buffer);
 }
+
+/**
+ * Zusammenhaengende Daten vom Quellmedium in mehrere Puffer lesen
+ *
+ * @param fs Pointer auf die FS-Struktur des Dateisystems
+ * @param start Position von der an gelesen werden soll
+ * @param iov Puffer, die nacheinander gefuellt werden
+ * @param count Anzahl Puffer
+ *
+ * @return die Anzahl der gelesenen Bytes
+ */
+size_t cdi_fs_data_readv(struct cdi_fs_filesystem* fs, uint64_t start,
+    const struct cdi_fs_iovec* iov, size_t count)
+{
+	return vfs_Readv((vfs_file_t)fs->osdep.fp, start, iov, count);
+}
+
+/**
+ * Daten aus mehreren Puffern zusammenhaengend auf das Quellmedium schreiben
+ *
+ * @param fs Pointer auf die FS-Struktur des Dateisystems
+ * @param start Position an die geschrieben werden soll
+ * @param iov Puffer, die nacheinander geschrieben werden
+ * @param count Anzahl Puffer
+ *
+ * @return die Anzahl der geschriebenen Bytes
+ */
+size_t cdi_fs_data_writev(struct cdi_fs_filesystem* fs, uint64_t start,
+    const struct cdi_fs_iovec* iov, size_t count)
+{
+	return vfs_Writev((vfs_file_t)fs->osdep.fp, start, iov, count);
+}
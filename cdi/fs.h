@@ -441,6 +441,18 @@ struct cdi_fs_res_res {
         int64_t value);
 };
 
+/**
+ * Ein Puffersegment fuer vektorisierte Ein-/Ausgabe (readv/writev).
+ * Erweiterung, nicht Teil der offiziellen CDI.
+ */
+struct cdi_fs_iovec {
+    /** Anfang des Puffers */
+    void* base;
+
+    /** Laenge des Puffers in Bytes */
+    size_t length;
+};
+
 struct cdi_fs_res_file {
     /** Dateien in dieser Klasse sind grunsaetzlich ausfuehrbar, wenn in der
      *  Flag-Struktur in der Ressource nicht anders angegeben */
@@ -494,6 +506,36 @@ struct cdi_fs_res_file {
      * @return 1 bei Erfolg, im Fehlerfall 0
      */
     int (*truncate)(struct cdi_fs_stream* stream, uint64_t size);
+
+    /**
+     * Zusammenhaengende Daten aus dieser Datei in mehrere Puffer lesen.
+     * Optional (Erweiterung), wenn NULL wird read fuer jeden Puffer einzeln
+     * aufgerufen.
+     *
+     * @param stream Stream
+     * @param start Position von der an gelesen werden soll
+     * @param iov Puffer, die nacheinander gefuellt werden
+     * @param count Anzahl Puffer
+     *
+     * @return Gelesene Bytes, oder 0 im Fehlerfall
+     */
+    size_t (*readv)(struct cdi_fs_stream* stream, uint64_t start,
+        const struct cdi_fs_iovec* iov, size_t count);
+
+    /**
+     * Daten aus mehreren Puffern zusammenhaengend in diese Datei schreiben.
+     * Optional (Erweiterung), wenn NULL wird write fuer jeden Puffer einzeln
+     * aufgerufen.
+     *
+     * @param stream Stream
+     * @param start Position an die geschrieben werden soll
+     * @param iov Puffer, die nacheinander geschrieben werden
+     * @param count Anzahl Puffer
+     *
+     * @return Geschriebene Bytes oder 0 im Fehlerfall
+     */
+    size_t (*writev)(struct cdi_fs_stream* stream, uint64_t start,
+        const struct cdi_fs_iovec* iov, size_t count);
 };
 
 struct cdi_fs_res_dir {
@@ -696,6 +738,35 @@ size_t cdi_fs_data_read(struct cdi_fs_filesystem* fs, uint64_t start,
 size_t cdi_fs_data_write(struct cdi_fs_filesystem* fs, uint64_t start,
     size_t size, const void* buffer);
 
+/**
+ * Zusammenhaengende Daten vom Quellmedium in mehrere Puffer lesen. Der
+ * Datentraeger wird dabei moeglichst mit einer einzigen Anfrage gelesen.
+ * Erweiterung, nicht Teil der offiziellen CDI.
+ *
+ * @param fs Pointer auf die FS-Struktur des Dateisystems
+ * @param start Position von der an gelesen werden soll
+ * @param iov Puffer, die nacheinander gefuellt werden
+ * @param count Anzahl Puffer
+ *
+ * @return die Anzahl der gelesenen Bytes
+ */
+size_t cdi_fs_data_readv(struct cdi_fs_filesystem* fs, uint64_t start,
+    const struct cdi_fs_iovec* iov, size_t count);
+
+/**
+ * Daten aus mehreren Puffern zusammenhaengend auf das Quellmedium schreiben.
+ * Erweiterung, nicht Teil der offiziellen CDI.
+ *
+ * @param fs Pointer auf die FS-Struktur des Dateisystems
+ * @param start Position an die geschrieben werden soll
+ * @param iov Puffer, die nacheinander geschrieben werden
+ * @param count Anzahl Puffer
+ *
+ * @return die Anzahl der geschriebenen Bytes
+ */
+size_t cdi_fs_data_writev(struct cdi_fs_filesystem* fs, uint64_t start,
+    const struct cdi_fs_iovec* iov, size_t count);
+
 #ifdef __cplusplus
 }; // extern "C"
 #endif
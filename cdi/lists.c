@@ -10,7 +10,7 @@
 
 struct cdi_list_node{
 		void *Value;
-		void *Next;
+		struct cdi_list_node *Next;
 };
 
 struct cdi_list_implementation{
@@ -172,15 +172,18 @@ void* cdi_list_remove(cdi_list_t list, size_t index)
 {
 	struct cdi_list_node *prevNode, *Node;
 	void *value;
+	size_t i;
 
 	if(index == 0)
 		return cdi_list_pop(list);
 
-	Node = cdi_list_get(list, index);
-	if(Node == NULL)
+	if(!list || index >= list->Size)
 		return NULL;
 
-	prevNode = cdi_list_get(list, index - 1);
+	prevNode = list->Anchor;
+	for(i = 0; i < index - 1; i++)
+		prevNode = prevNode->Next;
+	Node = prevNode->Next;
 
 	prevNode->Next = Node->Next;
 	value = Node->Value;
@@ -210,3 +213,63 @@ size_t cdi_list_size(cdi_list_t list)
 
 	return list->Size;
 }
+
+/*
+ * Initialisiert einen Iterator, der beim ersten Element (Index 0) beginnt
+ *
+ * @param list Liste, über die iteriert werden soll
+ * @param it Zu initialisierender Iterator
+ */
+void cdi_list_iterator_init(cdi_list_t list, cdi_list_iterator_t *it)
+{
+	it->list = list;
+	it->prev = NULL;
+	it->node = NULL;
+}
+
+/*
+ * Geht zum nächsten Element weiter und gibt dessen Wert zurück
+ *
+ * @param it Iterator
+ * @return Wert des nächsten Elements oder NULL, wenn das Ende der Liste erreicht ist
+ */
+void* cdi_list_iterator_next(cdi_list_iterator_t *it)
+{
+	if(!it->list) return NULL;
+
+	struct cdi_list_node *next;
+	if(it->node != NULL)
+	{
+		it->prev = it->node;
+		next = it->node->Next;
+	}
+	else
+		next = (it->prev != NULL) ? it->prev->Next : it->list->Anchor;
+
+	it->node = next;
+	return (next != NULL) ? next->Value : NULL;
+}
+
+/*
+ * Entfernt das aktuelle Element (das zuletzt von cdi_list_iterator_next zurückgegebene) in O(1).
+ *
+ * @param it Iterator
+ * @return Wert des entfernten Elements oder NULL, wenn es kein aktuelles Element gibt
+ */
+void* cdi_list_iterator_remove(cdi_list_iterator_t *it)
+{
+	struct cdi_list_node *Node = it->node;
+	if(Node == NULL) return NULL;
+
+	void *value = Node->Value;
+	if(it->prev != NULL)
+		it->prev->Next = Node->Next;
+	else
+		it->list->Anchor = Node->Next;
+	free(Node);
+
+	it->list->Size--;
+	it->node = NULL;
+
+	return value;
+}
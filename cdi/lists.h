@@ -224,6 +224,76 @@ void* cdi_list_remove(cdi_list_t list, size_t index);
  */
 size_t cdi_list_size(cdi_list_t list);
 
+/**
+ * \german
+ * Iterator ueber eine Liste (Erweiterung, nicht Teil von CDI). Die Felder
+ * duerfen nur von den cdi_list_iterator_*-Funktionen verwendet werden.
+ * \endgerman
+ *
+ * \english
+ * Iterator over a list (extension, not part of CDI). The fields must only be
+ * accessed through the cdi_list_iterator_* functions.
+ * \endenglish
+ */
+typedef struct {
+    cdi_list_t list;
+    struct cdi_list_node* prev;
+    struct cdi_list_node* node;
+} cdi_list_iterator_t;
+
+/**
+ * \german
+ * Initialisiert einen Iterator, der beim ersten Element (Index 0) beginnt
+ *
+ * @param list Liste, ueber die iteriert werden soll
+ * @param it Zu initialisierender Iterator
+ * \endgerman
+ *
+ * \english
+ * Initialises an iterator starting at the head of the list.
+ *
+ * @param list The list to iterate over
+ * @param it The iterator to initialise
+ * \endenglish
+ */
+void cdi_list_iterator_init(cdi_list_t list, cdi_list_iterator_t* it);
+
+/**
+ * \german
+ * Geht zum naechsten Element weiter
+ *
+ * @param it Iterator
+ * @return Das naechste Element oder NULL, wenn das Ende erreicht ist
+ * \endgerman
+ *
+ * \english
+ * Advances the iterator to the next element.
+ *
+ * @param it The iterator
+ * @return The next element, or NULL at the end of the list
+ * \endenglish
+ */
+void* cdi_list_iterator_next(cdi_list_iterator_t* it);
+
+/**
+ * \german
+ * Entfernt das aktuelle Element (das zuletzt von cdi_list_iterator_next
+ * zurueckgegebene) in konstanter Zeit.
+ *
+ * @param it Iterator
+ * @return Das entfernte Element oder NULL, wenn es kein aktuelles gibt
+ * \endgerman
+ *
+ * \english
+ * Removes the current element (the one last returned by
+ * cdi_list_iterator_next) in constant time.
+ *
+ * @param it The iterator
+ * @return The removed element, or NULL if there is no current element
+ * \endenglish
+ */
+void* cdi_list_iterator_remove(cdi_list_iterator_t* it);
+
 #ifdef __cplusplus
 }; // extern "C"
 #endif
@@ -150,15 +150,108 @@ struct cdi_mem_area* cdi_mem_map(uintptr_t paddr, size_t size)
 
 /**
  * \german
- * Gibt einen durch cdi_mem_alloc oder cdi_mem_map reservierten Speicherbereich
- * frei
+ * Beschreibt einen bereits gemappten Puffer mit einer Scatter/Gather-Liste
+ * seiner physischen Adressen, damit ein Treiber direkt per DMA darauf
+ * zugreifen kann. cdi_mem_free gibt nur die Beschreibung frei, nicht den
+ * Puffer selbst.
+ *
+ * @param vaddr Virtuelle Adresse des Puffers
+ * @param size Größe des Puffers in Bytes
+ *
+ * @return Eine cdi_mem_area bei Erfolg, NULL wenn ein Teil des Puffers nicht
+ *         gemappt ist
+ * \endgerman
+ * \english
+ * Describes an already mapped buffer with a scatter/gather list of its
+ * physical addresses, so that a driver can access it directly using DMA.
+ * cdi_mem_free only frees the description, not the buffer itself.
+ *
+ * @param vaddr Virtual address of the buffer
+ * @param size Size of the buffer in bytes
+ *
+ * @return A cdi_mem_area on success, NULL if a part of the buffer isn't
+ *         mapped
+ * \endenglish
+ */
+struct cdi_mem_area* cdi_mem_describe(void* vaddr, size_t size)
+{
+	struct cdi_mem_area *area;
+	struct cdi_mem_sg_item *items;
+	uintptr_t start = (uintptr_t)vaddr;
+	uintptr_t end = start + size;
+	size_t num = 0;
+
+	if(size == 0)
+		return NULL;
+
+	//Höchstens ein Eintrag pro Page
+	items = malloc(((end - 1) / MM_BLOCK_SIZE - start / MM_BLOCK_SIZE + 1) * sizeof(*items));
+	if(items == NULL)
+		return NULL;
+
+	while(start < end)
+	{
+		uintptr_t offset = start % MM_BLOCK_SIZE;
+		size_t length = MM_BLOCK_SIZE - offset;
+		paddr_t page;
+
+		if(length > end - start)
+			length = end - start;
+		if((page = vmm_getPhysAddress((void*)start)) == 0)
+		{
+			free(items);
+			return NULL;
+		}
+
+		//Physisch zusammenhängende Pages werden zu einem Eintrag zusammengefasst
+		if(num > 0 && items[num - 1].start + items[num - 1].size == page + offset)
+			items[num - 1].size += length;
+		else
+			items[num++] = (struct cdi_mem_sg_item){
+				.start = page + offset,
+				.size = length
+			};
+		start += length;
+	}
+
+	area = malloc(sizeof(*area));
+	if(area == NULL)
+	{
+		free(items);
+		return NULL;
+	}
+	*area = (struct cdi_mem_area){
+		.size = size,
+		.vaddr = vaddr,
+		.paddr = {
+			.num = num,
+			.items = items
+		},
+		.osdep = {
+			.borrowed = 1
+		}
+	};
+
+	return area;
+}
+
+/**
+ * \german
+ * Gibt einen durch cdi_mem_alloc, cdi_mem_map oder cdi_mem_describe
+ * reservierten Speicherbereich frei
  * \endgerman
  * \english
- * Frees a memory area that was previously allocated by cdi_mem_alloc or
- * cdi_mem_map
+ * Frees a memory area that was previously allocated by cdi_mem_alloc,
+ * cdi_mem_map or cdi_mem_describe
  * \endenglish
  */
 void cdi_mem_free(struct cdi_mem_area* p)
 {
+	if(p->osdep.borrowed)
+	{
+		free(p->paddr.items);
+		free(p);
+		return;
+	}
 	vmm_SysFree((uintptr_t)p->vaddr, p->size / 4096);
 }
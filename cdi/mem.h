@@ -181,12 +181,39 @@ struct cdi_mem_area* cdi_mem_map(uintptr_t paddr, size_t size);
 
 /**
  * \german
- * Gibt einen durch cdi_mem_alloc oder cdi_mem_map reservierten Speicherbereich
- * frei
+ * Beschreibt einen bereits gemappten Puffer mit einer Scatter/Gather-Liste
+ * seiner physischen Adressen, damit ein Treiber direkt per DMA darauf
+ * zugreifen kann. cdi_mem_free gibt nur die Beschreibung frei, nicht den
+ * Puffer selbst.
+ *
+ * @param vaddr Virtuelle Adresse des Puffers
+ * @param size Größe des Puffers in Bytes
+ *
+ * @return Eine cdi_mem_area bei Erfolg, NULL wenn ein Teil des Puffers nicht
+ *         gemappt ist
+ * \endgerman
+ * \english
+ * Describes an already mapped buffer with a scatter/gather list of its
+ * physical addresses, so that a driver can access it directly using DMA.
+ * cdi_mem_free only frees the description, not the buffer itself.
+ *
+ * @param vaddr Virtual address of the buffer
+ * @param size Size of the buffer in bytes
+ *
+ * @return A cdi_mem_area on success, NULL if a part of the buffer isn't
+ *         mapped
+ * \endenglish
+ */
+struct cdi_mem_area* cdi_mem_describe(void* vaddr, size_t size);
+
+/**
+ * \german
+ * Gibt einen durch cdi_mem_alloc, cdi_mem_map oder cdi_mem_describe
+ * reservierten Speicherbereich frei
  * \endgerman
  * \english
- * Frees a memory area that was previously allocated by cdi_mem_alloc or
- * cdi_mem_map
+ * Frees a memory area that was previously allocated by cdi_mem_alloc,
+ * cdi_mem_map or cdi_mem_describe
  * \endenglish
  */
 void cdi_mem_free(struct cdi_mem_area* p);
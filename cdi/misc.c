@@ -17,7 +17,7 @@ typedef struct{
 }Handler_t;
 
 cdi_list_t IRQHandlers;
-uint64_t IRQCount[NUM_IRQ];
+uint64_t IRQCount[NUM_IRQ + NUM_MSI];
 
 void cdi_irq_handler(uint8_t irq)
 {
@@ -45,7 +45,7 @@ void cdi_irq_handler(uint8_t irq)
  */
 void cdi_register_irq(uint8_t irq, void (*handler)(struct cdi_device*), struct cdi_device* device)
 {
-	if(irq > NUM_IRQ)
+	if(irq >= NUM_IRQ + NUM_MSI)
 		return;
 
 	Handler_t *Handler;
@@ -67,7 +67,7 @@ void cdi_register_irq(uint8_t irq, void (*handler)(struct cdi_device*), struct c
  */
 int cdi_reset_wait_irq(uint8_t irq)
 {
-	if(irq > NUM_IRQ)
+	if(irq >= NUM_IRQ + NUM_MSI)
 		return -1;
 	IRQCount[irq] = 0;
 	return 0;
@@ -96,7 +96,7 @@ int cdi_reset_wait_irq(uint8_t irq)
 int cdi_wait_irq(uint8_t irq, uint32_t timeout)
 {
 	uint64_t Time = 0;
-	if(irq > NUM_IRQ)
+	if(irq >= NUM_IRQ + NUM_MSI)
 		return -1;
 
 	while(!IRQCount[irq])
@@ -110,6 +110,32 @@ void cdi_pci_device_destroy(struct cdi_pci_device* device)
 	free(device);
 }
 
+/**
+ * \german
+ * Schaltet ein Gerät auf MSI-X bzw. MSI um. Bei Erfolg enthält device->irq
+ * danach den ersten von count IRQs, die weiteren folgen direkt darauf.
+ * \endgerman
+ * \english
+ * Switches a device to MSI-X or MSI. On success device->irq contains the
+ * first of count IRQs, the others directly follow it.
+ * \endenglish
+ */
+int cdi_pci_enable_msi(struct cdi_pci_device* device, unsigned int count)
+{
+	pciDevice_t *pciDevice = pci_getDevice(device->bus, device->dev, device->function);
+	int irq;
+
+	if(pciDevice == NULL)
+		return 0;
+
+	irq = pci_enableMSI(pciDevice, count > 255 ? 255 : count);
+	if(irq < 0)
+		return 0;
+
+	device->irq = irq;
+	return pciDevice->msiCount;
+}
+
 /**
  * \if german
  * Liest ein Word (16 Bit) aus dem PCI-Konfigurationsraum eines PCI-Geraets
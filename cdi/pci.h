@@ -167,6 +167,31 @@ void cdi_pci_get_all_devices(cdi_list_t list);
  */
 void cdi_pci_device_destroy(struct cdi_pci_device* device);
 
+/**
+ * \german
+ * Schaltet ein Gerät auf MSI-X bzw. MSI um. Bei Erfolg enthält device->irq
+ * danach den ersten von count IRQs, die weiteren folgen direkt darauf. Die
+ * IRQs werden wie gewohnt mit cdi_register_irq registriert.
+ *
+ * @param device Das Gerät
+ * @param count Gewünschte Anzahl IRQs (z.B. einer pro Queue)
+ *
+ * @return Anzahl der zugewiesenen IRQs, 0 wenn das Gerät weiterhin den
+ *         Legacy-IRQ benutzt
+ * \endgerman
+ * \english
+ * Switches a device to MSI-X or MSI. On success device->irq contains the
+ * first of count IRQs, the others directly follow it. The IRQs are registered
+ * with cdi_register_irq as usual.
+ *
+ * @param device The device
+ * @param count Requested number of IRQs (e.g. one per queue)
+ *
+ * @return Number of assigned IRQs, 0 if the device keeps using the legacy IRQ
+ * \endenglish
+ */
+int cdi_pci_enable_msi(struct cdi_pci_device* device, unsigned int count);
+
 /**
  * \german
  * Reserviert die IO-Ports des PCI-Geräts für den Treiber
@@ -9,6 +9,28 @@
 #include "vfs.h"
 #include "stdlib.h"
 #include "devicemng.h"
+#include "softirq.h"
+#include "lock.h"
+
+//Im Interrupt abgeschlossene Anfragen, deren complete noch aufgerufen werden muss
+static struct cdi_storage_request *completed_head = NULL, *completed_tail = NULL;
+static spinlock_t completed_lock = SPINLOCK_UNLOCKED;
+
+static void cdi_storage_softirq(void)
+{
+	struct cdi_storage_request *request, *next;
+
+	uint64_t flags = spin_lock_irqsave(&completed_lock);
+	request = completed_head;
+	completed_head = completed_tail = NULL;
+	spin_unlock_irqrestore(&completed_lock, flags);
+
+	for(; request != NULL; request = next)
+	{
+		next = request->next;
+		request->complete(request);
+	}
+}
 
 /**
  * \german
@@ -26,6 +48,7 @@ void cdi_storage_driver_init(struct cdi_storage_driver* driver)
 {
 	driver->drv.type = CDI_STORAGE;
 	cdi_driver_init((struct cdi_driver*)driver);
+	softirq_register(SOFTIRQ_STORAGE, cdi_storage_softirq);
 }
 
 /**
@@ -66,3 +89,73 @@ void cdi_storage_device_init(struct cdi_storage_device* device)
 	device->dev.bus_data->bus_type = CDI_STORAGE;
 	dmng_registerDevice((struct cdi_device*)device);
 }
+
+/**
+ * \german
+ * Startet eine Anfrage an ein Massenspeichergerät. Treiber ohne asynchrone
+ * Schnittstelle führen die Anfrage sofort aus und schliessen sie ab, bevor
+ * diese Funktion zurückkehrt.
+ *
+ * @return 0 wenn die Anfrage gestartet wurde, CDI_STORAGE_BUSY wenn das
+ *         Gerät keine weiteren Anfragen annehmen kann, -1 im Fehlerfall.
+ * \endgerman
+ * \english
+ * Starts a request to a mass storage device. Drivers without an asynchronous
+ * interface execute and complete the request before this function returns.
+ *
+ * @return 0 if the request was started, CDI_STORAGE_BUSY if the device can't
+ *         accept any more requests, -1 in error cases.
+ * \endenglish
+ */
+int cdi_storage_submit(struct cdi_storage_request* request)
+{
+	struct cdi_storage_device *device = request->device;
+	struct cdi_storage_driver *driver = (struct cdi_storage_driver*)device->dev.driver;
+	int result;
+
+	if(driver->submit != NULL)
+		return driver->submit(device, request);
+
+	//Synchrone Treiber emulieren
+	if(request->write)
+		result = driver->write_blocks(device, request->start, request->count, request->buffer);
+	else
+		result = driver->read_blocks(device, request->start, request->count, request->buffer);
+	cdi_storage_request_complete(request, result ? -1 : 0);
+	return 0;
+}
+
+/**
+ * \german
+ * Wird vom Treiber aufgerufen, wenn eine asynchrone Anfrage abgeschlossen ist
+ *
+ * @param result 0 bei Erfolg, -1 im Fehlerfall
+ * \endgerman
+ * \english
+ * Called by the driver once an asynchronous request has completed
+ *
+ * @param result 0 on success, -1 in error cases
+ * \endenglish
+ */
+void cdi_storage_request_complete(struct cdi_storage_request* request, int result)
+{
+	request->result = result;
+	if(request->complete == NULL)
+		return;
+
+	//Im Interrupthandler nur vormerken, damit der Handler kurz bleibt
+	if(softirq_inIRQ())
+	{
+		request->next = NULL;
+		uint64_t flags = spin_lock_irqsave(&completed_lock);
+		if(completed_tail != NULL)
+			completed_tail->next = request;
+		else
+			completed_head = request;
+		completed_tail = request;
+		spin_unlock_irqrestore(&completed_lock, flags);
+		softirq_raise(SOFTIRQ_STORAGE);
+	}
+	else
+		request->complete(request);
+}
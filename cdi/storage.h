@@ -43,9 +43,22 @@
 #define _CDI_STORAGE_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <cdi.h>
 
+/**
+ * \german
+ * Rückgabewert von cdi_storage_submit, wenn das Gerät gerade keine weiteren
+ * Anfragen annehmen kann
+ * \endgerman
+ * \english
+ * Return value of cdi_storage_submit if the device can't accept any more
+ * requests at the moment
+ * \endenglish
+ */
+#define CDI_STORAGE_BUSY 1
+
 /**
  * \german
  * Repräsentiert ein Massenspeichergerät.
@@ -79,6 +92,68 @@ struct cdi_storage_device {
     uint64_t            block_count;
 };
 
+/**
+ * \german
+ * Asynchrone Anfrage an ein Massenspeichergerät
+ * \endgerman
+ * \english
+ * Asynchronous request to a mass storage device
+ * \endenglish
+ */
+struct cdi_storage_request {
+    struct cdi_storage_device*  device;
+
+    /**
+     * \german
+     * true für Schreibzugriffe, false für Lesezugriffe
+     * \endgerman
+     * \english
+     * true for writes, false for reads
+     * \endenglish
+     */
+    bool                        write;
+
+    /** Number of the first block */
+    uint64_t                    start;
+
+    /** Number of blocks */
+    uint64_t                    count;
+
+    /** Buffer for the data (must stay valid until completion) */
+    void*                       buffer;
+
+    /**
+     * \german
+     * Ergebnis: 0 bei Erfolg, -1 im Fehlerfall. Ist gültig, sobald complete
+     * aufgerufen wird.
+     * \endgerman
+     * \english
+     * Result: 0 on success, -1 in error cases. Valid once complete is called.
+     * \endenglish
+     */
+    int                         result;
+
+    /**
+     * \german
+     * Wird aufgerufen, wenn die Anfrage abgeschlossen ist. Wird die Anfrage
+     * in einem Interrupthandler abgeschlossen, läuft complete erst nach dem
+     * EOI als Softirq. Darf nicht blockieren.
+     * \endgerman
+     * \english
+     * Called when the request has completed. If the request completes in an
+     * interrupt handler, complete runs as a softirq after the EOI. Must not
+     * block.
+     * \endenglish
+     */
+    void (*complete)(struct cdi_storage_request* request);
+
+    /** Data for the caller */
+    void*                       opaque;
+
+    /** Internal: next request waiting for its completion softirq */
+    struct cdi_storage_request* next;
+};
+
 /**
  * \german
  * Beschreibt einen Treiber für Massenspeichergeräte.
@@ -140,6 +215,29 @@ struct cdi_storage_driver {
      */
     int (*write_blocks)(struct cdi_storage_device* device, uint64_t start,
         uint64_t count, void* buffer);
+
+    /**
+     * \german
+     * Startet eine asynchrone Anfrage (optional). Wenn der Treiber diese
+     * Funktion nicht anbietet, werden Anfragen mit read_blocks und
+     * write_blocks synchron ausgeführt.
+     *
+     * @return 0 wenn die Anfrage gestartet wurde, CDI_STORAGE_BUSY wenn das
+     *         Gerät keine weiteren Anfragen annehmen kann, -1 im Fehlerfall.
+     *         Nur bei 0 wird cdi_storage_request_complete aufgerufen.
+     * \endgerman
+     * \english
+     * Starts an asynchronous request (optional). If a driver doesn't provide
+     * this function, requests are executed synchronously using read_blocks
+     * and write_blocks.
+     *
+     * @return 0 if the request was started, CDI_STORAGE_BUSY if the device
+     *         can't accept any more requests, -1 in error cases. Only if 0 is
+     *         returned, cdi_storage_request_complete will be called.
+     * \endenglish
+     */
+    int (*submit)(struct cdi_storage_device* device,
+        struct cdi_storage_request* request);
 };
 
 #ifdef __cplusplus
@@ -191,6 +289,40 @@ void cdi_storage_driver_destroy(struct cdi_storage_driver* driver);
  */
 void cdi_storage_device_init(struct cdi_storage_device* device);
 
+/**
+ * \german
+ * Startet eine Anfrage an ein Massenspeichergerät. Treiber ohne asynchrone
+ * Schnittstelle führen die Anfrage sofort aus und schliessen sie ab, bevor
+ * diese Funktion zurückkehrt.
+ *
+ * @return 0 wenn die Anfrage gestartet wurde, CDI_STORAGE_BUSY wenn das
+ *         Gerät keine weiteren Anfragen annehmen kann, -1 im Fehlerfall.
+ * \endgerman
+ * \english
+ * Starts a request to a mass storage device. Drivers without an asynchronous
+ * interface execute and complete the request before this function returns.
+ *
+ * @return 0 if the request was started, CDI_STORAGE_BUSY if the device can't
+ *         accept any more requests, -1 in error cases.
+ * \endenglish
+ */
+int cdi_storage_submit(struct cdi_storage_request* request);
+
+/**
+ * \german
+ * Wird vom Treiber aufgerufen, wenn eine asynchrone Anfrage abgeschlossen ist
+ *
+ * @param result 0 bei Erfolg, -1 im Fehlerfall
+ * \endgerman
+ * \english
+ * Called by the driver once an asynchronous request has completed
+ *
+ * @param result 0 on success, -1 in error cases
+ * \endenglish
+ */
+void cdi_storage_request_complete(struct cdi_storage_request* request,
+    int result);
+
 #ifdef __cplusplus
 }; // extern "C"
 #endif
@@ -10,5 +10,7 @@
 
 //Configuration File
 //#define DEBUGMODE
+//Statistik über Locks sammeln (/sysinf/locks)
+//#define LOCK_PROFILING
 
 #endif /* CONFIG_H_ */
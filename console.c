@@ -148,6 +148,8 @@ void console_Init()
 		tty->opaque = console;
 		tty->read = console_readHandler;
 		tty->write = console_writeHandler;
+		tty->readv = NULL;
+		tty->writev = NULL;
 		tty->getValue = console_getValue;
 		vfs_RegisterDevice(tty);
 	}
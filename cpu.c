@@ -278,4 +278,15 @@ void cpu_MSRwrite(uint32_t msr, uint64_t Value)
 	asm volatile("wrmsr" : : "a" (low), "c" (msr), "d" (high));
 }
 
+/*
+ * Liest den Time Stamp Counter aus
+ * Rückgabe:	Aktueller Wert des TSC
+ */
+uint64_t cpu_rdtsc(void)
+{
+	uint32_t low, high;
+	asm volatile("rdtsc" : "=a" (low), "=d" (high));
+	return ((uint64_t)high << 32) | low;
+}
+
 #endif
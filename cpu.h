@@ -65,6 +65,7 @@ void cpu_Init(void);
 uint32_t cpu_CPUID(uint32_t Funktion, CPU_REGISTER Register);
 uint64_t cpu_MSRread(uint32_t msr);
 void cpu_MSRwrite(uint32_t msr, uint64_t Value);
+uint64_t cpu_rdtsc(void);
 
 #endif /* CPU_H_ */
 
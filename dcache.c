@@ -0,0 +1,197 @@
+/*
+ * dcache.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "dcache.h"
+#include "hashmap.h"
+#include "ilist.h"
+#include "lock.h"
+#include "lockstat.h"
+#include "vfs.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdio.h"
+
+#define DCACHE_MAX	1024	//Maximale Anzahl Einträge, danach wird der am längsten nicht verwendete verdrängt
+
+typedef struct{
+	const void *parent;
+	const char *name;
+	size_t len;
+	void *child;			//NULL bei negativen Einträgen
+	ilist_node_t lru;
+	char name_buf[];
+}dentry_t;
+
+static hashmap_t *dcache = NULL;
+static ilist_t dcache_lru = ILIST_INIT(dcache_lru);	//Am längsten nicht verwendete Einträge zuerst
+static lock_t dcache_lock = LOCK_UNLOCKED;
+
+static struct{
+	uint64_t hits;
+	uint64_t negative_hits;
+	uint64_t misses;
+	uint64_t evictions;
+}dcache_stats;
+
+//FNV-1a über den Namen, gemischt mit dem Elternelement
+static uint64_t dentry_hash(const void *key, __attribute__((unused)) void *context)
+{
+	const dentry_t *entry = key;
+	uint64_t hash = 0xCBF29CE484222325ul ^ ((uintptr_t)entry->parent >> 3);
+	size_t i;
+	for(i = 0; i < entry->len; i++)
+	{
+		hash ^= (uint8_t)entry->name[i];
+		hash *= 0x100000001B3ul;
+	}
+	return hash;
+}
+
+static bool dentry_equal(const void *a, const void *b, __attribute__((unused)) void *context)
+{
+	const dentry_t *x = a, *y = b;
+	return x->parent == y->parent && x->len == y->len && memcmp(x->name, y->name, x->len) == 0;
+}
+
+//dcache_lock muss gehalten werden
+static void dentry_remove(dentry_t *entry)
+{
+	hashmap_delete(dcache, entry);
+	ilist_remove(&dcache_lru, &entry->lru);
+	free(entry);
+}
+
+bool dcache_lookup(const void *parent, const char *name, size_t len, void **child)
+{
+	const dentry_t key = {.parent = parent, .name = name, .len = len};
+	dentry_t *entry;
+
+	if(dcache == NULL)
+		return false;
+
+	lock(&dcache_lock);
+	if(hashmap_search(dcache, &key, (void**)&entry) != HASH_MAP_SUCCESS_FOUND)
+	{
+		dcache_stats.misses++;
+		unlock(&dcache_lock);
+		return false;
+	}
+
+	//Ans Ende der LRU-Liste verschieben
+	ilist_remove(&dcache_lru, &entry->lru);
+	ilist_push_back(&dcache_lru, &entry->lru);
+
+	if(entry->child == NULL)
+		dcache_stats.negative_hits++;
+	else
+		dcache_stats.hits++;
+	*child = entry->child;
+	unlock(&dcache_lock);
+	return true;
+}
+
+void dcache_insert(const void *parent, const char *name, size_t len, void *child)
+{
+	const dentry_t key = {.parent = parent, .name = name, .len = len};
+	dentry_t *entry;
+
+	if(dcache == NULL)
+		return;
+
+	lock(&dcache_lock);
+	if(hashmap_search(dcache, &key, (void**)&entry) == HASH_MAP_SUCCESS_FOUND)
+	{
+		entry->child = child;
+		unlock(&dcache_lock);
+		return;
+	}
+
+	if(ilist_size(&dcache_lru) >= DCACHE_MAX)
+	{
+		dentry_remove(ILIST_ENTRY(ilist_first(&dcache_lru), dentry_t, lru));
+		dcache_stats.evictions++;
+	}
+
+	entry = malloc(sizeof(dentry_t) + len + 1);
+	if(entry != NULL)
+	{
+		memcpy(entry->name_buf, name, len);
+		entry->name_buf[len] = '\0';
+		entry->name = entry->name_buf;
+		entry->parent = parent;
+		entry->len = len;
+		entry->child = child;
+		if(hashmap_set(dcache, entry, entry) == HASH_MAP_SUCCESS)
+			ilist_push_back(&dcache_lru, &entry->lru);
+		else
+			free(entry);
+	}
+	unlock(&dcache_lock);
+}
+
+void dcache_invalidate(const void *parent, const char *name, size_t len)
+{
+	const dentry_t key = {.parent = parent, .name = name, .len = len};
+	dentry_t *entry;
+
+	if(dcache == NULL)
+		return;
+
+	lock(&dcache_lock);
+	if(hashmap_search(dcache, &key, (void**)&entry) == HASH_MAP_SUCCESS_FOUND)
+		dentry_remove(entry);
+	unlock(&dcache_lock);
+}
+
+void dcache_purge(const void *ptr)
+{
+	ilist_node_t *node, *tmp;
+
+	if(dcache == NULL)
+		return;
+
+	lock(&dcache_lock);
+	ilist_foreach_safe(node, tmp, &dcache_lru)
+	{
+		dentry_t *entry = ILIST_ENTRY(node, dentry_t, lru);
+		if(entry->parent == ptr || entry->child == ptr)
+			dentry_remove(entry);
+	}
+	unlock(&dcache_lock);
+}
+
+static size_t dcache_read(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	char text[256];
+
+	lock(&dcache_lock);
+	uint64_t lookups = dcache_stats.hits + dcache_stats.negative_hits + dcache_stats.misses;
+	uint64_t rate = lookups ? (dcache_stats.hits + dcache_stats.negative_hits) * 1000 / lookups : 0;
+	size_t size = sprintf(text, "entries: %lu\nhits: %lu\nnegative hits: %lu\nmisses: %lu\nevictions: %lu\nhit rate: %lu.%lu%%\n",
+			ilist_size(&dcache_lru), dcache_stats.hits, dcache_stats.negative_hits, dcache_stats.misses,
+			dcache_stats.evictions, rate / 10, rate % 10);
+	unlock(&dcache_lock);
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	return read;
+}
+
+void dcache_Init(void)
+{
+	lockstat_register(&dcache_lock, "dcache");
+	dcache = hashmap_create(dentry_hash, dentry_equal, NULL, NULL, NULL, DCACHE_MAX);
+	vfs_RegisterInfoFile("dcache", dcache_read, NULL);
+}
+
+#endif
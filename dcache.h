@@ -0,0 +1,54 @@
+/*
+ * dcache.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef DCACHE_H_
+#define DCACHE_H_
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+
+/*
+ * Cache für Verzeichniseinträge. Ein Eintrag ordnet einem Paar (Elternelement, Name) das
+ * Kindelement zu. Es werden auch negative Einträge gespeichert (Kind existiert nicht).
+ * Der Cache kennt die Elemente nicht, er wird für die Nodes des VFS und für die Ressourcen
+ * der gemounteten Dateisysteme verwendet.
+ * Die Statistik ist unter /sysinf/dcache abrufbar.
+ */
+
+void dcache_Init(void);
+
+/*
+ * Sucht einen Eintrag
+ * Parameter:	parent = Elternelement
+ * 				name = Name des Kindes (muss nicht nullterminiert sein)
+ * 				len = Länge des Namens
+ * 				child = Kindelement oder NULL, wenn ein negativer Eintrag gefunden wurde
+ * Rückgabe:	true = Eintrag gefunden, false = nicht im Cache
+ */
+bool dcache_lookup(const void *parent, const char *name, size_t len, void **child);
+
+/*
+ * Fügt einen Eintrag hinzu oder ersetzt einen vorhandenen
+ * Parameter:	parent = Elternelement
+ * 				name = Name des Kindes (muss nicht nullterminiert sein)
+ * 				len = Länge des Namens
+ * 				child = Kindelement oder NULL für einen negativen Eintrag
+ */
+void dcache_insert(const void *parent, const char *name, size_t len, void *child);
+
+//Entfernt den Eintrag (parent, name), wenn er vorhanden ist
+void dcache_invalidate(const void *parent, const char *name, size_t len);
+
+//Entfernt alle Einträge, deren Eltern- oder Kindelement ptr ist
+void dcache_purge(const void *ptr);
+
+#endif /* DCACHE_H_ */
+
+#endif
@@ -12,18 +12,23 @@
 #include "lists.h"
 #include "storage.h"
 #include "scsi.h"
+#include "blkqueue.h"
 #include "stdlib.h"
 #include "string.h"
 
 #define GET_BYTE(value, offset) (value >> offset) & 0xFF
 #define MIN(val1, val2) ((val1 < val2) ? val1 : val2)
 
+#define SCSI_SECTOR_SIZE		2048
+#define SCSI_MAX_SECTORS		32		//Maximale Anzahl Sektoren pro READ(12) und Grösse des Vorauslesepuffers
+
 static list_t devices;
 
 void dmng_Init()
 {
 	//Initialisiere Geräteliste
 	devices = list_create();
+	blkqueue_Init();
 }
 
 void dmng_registerDevice(struct cdi_device *dev)
@@ -32,11 +37,19 @@ void dmng_registerDevice(struct cdi_device *dev)
 	device->partitions = list_create();
 	device->device = dev;
 	semaphore_init(&device->semaphore, 1);
+	device->queue = NULL;
+	device->readahead.buffer = NULL;
+	device->readahead.count = 0;
+	device->readahead.next = 0;
+	if(dev->bus_data->bus_type == CDI_STORAGE)
+		device->queue = blkqueue_create((struct cdi_storage_device*)dev);
 
 	vfs_device_t *vfs_dev = malloc(sizeof(vfs_device_t));
 	vfs_dev->opaque = device;
 	vfs_dev->read = (vfs_device_read_handler_t*)dmng_Read;
-	vfs_dev->write = (vfs_device_write_handler_t*)NULL;
+	vfs_dev->write = (vfs_device_write_handler_t*)dmng_Write;
+	vfs_dev->readv = (vfs_device_readv_handler_t*)dmng_ReadVector;
+	vfs_dev->writev = (vfs_device_writev_handler_t*)dmng_WriteVector;
 	vfs_dev->getValue = (vfs_device_getValue_handler_t*)dmng_getValue;
 
 	vfs_RegisterDevice(vfs_dev);
@@ -46,6 +59,103 @@ void dmng_registerDevice(struct cdi_device *dev)
 	list_push(devices, device);
 }
 
+/*
+ * Verteilt zusammenhängende Daten auf mehrere Puffer
+ * Parameter:	data = Quelldaten
+ * 				offset = Position in den Puffern, ab der geschrieben wird
+ * 				size = Anzahl Bytes
+ * 				iov = Puffer
+ * 				count = Anzahl Puffer
+ */
+static void scatter(const void *data, size_t offset, size_t size, const vfs_iovec_t *iov, size_t count)
+{
+	size_t i;
+	for(i = 0; i < count && size > 0; i++)
+	{
+		if(offset >= iov[i].length)
+		{
+			offset -= iov[i].length;
+			continue;
+		}
+		size_t length = MIN(iov[i].length - offset, size);
+		memcpy(iov[i].base + offset, data, length);
+		data += length;
+		size -= length;
+		offset = 0;
+	}
+}
+
+/*
+ * Liest Sektoren von einem SCSI-Gerät mit einem READ(12)-Befehl
+ * Parameter:	dev = Gerät
+ * 				lba = erster Sektor
+ * 				count = Anzahl Sektoren (höchstens SCSI_MAX_SECTORS)
+ * 				buffer = Puffer für count Sektoren
+ * Rückgabe:	0 bei Erfolg, sonst Fehler
+ */
+static int dmng_scsiRead(device_t *dev, uint32_t lba, uint32_t count, void *buffer)
+{
+	struct cdi_scsi_driver *driver = (struct cdi_scsi_driver*)dev->device->driver;
+	struct cdi_scsi_device *device = (struct cdi_scsi_device*)dev->device;
+	struct cdi_scsi_packet packet = {
+		.buffer = buffer,
+		.bufsize = count * SCSI_SECTOR_SIZE,
+		.cmdsize = 12,
+		.command = {0xA8, 0, GET_BYTE(lba, 0x18), GET_BYTE(lba, 0x10), GET_BYTE(lba, 0x08), GET_BYTE(lba, 0x00),
+				GET_BYTE(count, 0x18), GET_BYTE(count, 0x10), GET_BYTE(count, 0x08), GET_BYTE(count, 0x00), 0, 0},
+		.direction = CDI_SCSI_READ
+	};
+	return driver->request(device, &packet);
+}
+
+/*
+ * Liest von einem SCSI-Gerät. Es werden so viele Sektoren wie möglich mit einem Befehl gelesen.
+ * Bei sequentiellem Lesen wird ein ganzer Puffer vorausgelesen, damit die folgenden kleinen
+ * Zugriffe (z.B. von iso9660) nicht jedes Mal auf das Gerät warten müssen.
+ * dev->semaphore muss gehalten werden.
+ * Rückgabe:	true bei Erfolg
+ */
+static bool dmng_scsiReadCached(device_t *dev, uint64_t start, size_t size, const vfs_iovec_t *iov, size_t count)
+{
+	uint64_t end_lba = (start + size + SCSI_SECTOR_SIZE - 1) / SCSI_SECTOR_SIZE;
+	bool sequential = (start / SCSI_SECTOR_SIZE == dev->readahead.next);
+	size_t offset = 0;
+
+	if(dev->readahead.buffer == NULL)
+	{
+		dev->readahead.buffer = malloc(SCSI_MAX_SECTORS * SCSI_SECTOR_SIZE);
+		if(dev->readahead.buffer == NULL)
+			return false;
+	}
+
+	while(offset < size)
+	{
+		uint64_t position = start + offset;
+		uint64_t lba = position / SCSI_SECTOR_SIZE;
+
+		if(dev->readahead.count == 0 || lba < dev->readahead.lba || lba >= dev->readahead.lba + dev->readahead.count)
+		{
+			uint32_t sectors = MIN(end_lba - lba, SCSI_MAX_SECTORS);
+			dev->readahead.count = 0;
+			//Nur bei sequentiellem Lesen den ganzen Puffer füllen. Das kann am Ende des Mediums
+			//fehlschlagen, dann werden nur die benötigten Sektoren gelesen.
+			if(sequential && sectors < SCSI_MAX_SECTORS && !dmng_scsiRead(dev, lba, SCSI_MAX_SECTORS, dev->readahead.buffer))
+				sectors = SCSI_MAX_SECTORS;
+			else if(dmng_scsiRead(dev, lba, sectors, dev->readahead.buffer))
+				return false;
+			dev->readahead.lba = lba;
+			dev->readahead.count = sectors;
+		}
+
+		size_t length = MIN((dev->readahead.lba + dev->readahead.count) * SCSI_SECTOR_SIZE - position, size - offset);
+		scatter(dev->readahead.buffer + position - dev->readahead.lba * SCSI_SECTOR_SIZE, offset, length, iov, count);
+		offset += length;
+	}
+
+	dev->readahead.next = end_lba;
+	return true;
+}
+
 /*
  * Liest von einem Datenträger
  * Parameter:	dev = Gerät von dem gelesen werden soll
@@ -56,66 +166,46 @@ void dmng_registerDevice(struct cdi_device *dev)
  */
 size_t dmng_Read(device_t *dev, uint64_t start, size_t size, void *buffer)
 {
-	if(size == 0 || buffer == NULL) return 0;
+	vfs_iovec_t iov = {
+			.base = buffer,
+			.length = size
+	};
+	if(buffer == NULL) return 0;
+	return dmng_ReadVector(dev, start, &iov, 1);
+}
+
+/*
+ * Liest zusammenhängende Daten von einem Datenträger in mehrere Puffer. Bei Blockgeräten läuft
+ * der Zugriff über die Warteschlange des Geräts.
+ * Parameter:	dev = Gerät von dem gelesen werden soll
+ * 				start = Byte an dem angefangen werden soll zu lesen
+ * 				iov = Puffer, die nacheinander gefüllt werden
+ * 				count = Anzahl Puffer
+ * Rückgabe:	0 bei Fehler und sonst die gelesenen Bytes
+ */
+size_t dmng_ReadVector(device_t *dev, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	size_t size = 0;
+	size_t i;
+	for(i = 0; i < count; i++)
+		size += iov[i].length;
+
+	if(size == 0 || iov == NULL) return 0;
 
 	if(dev->device->bus_data->bus_type == CDI_STORAGE)
 	{
-		struct cdi_storage_driver *driver = (struct cdi_storage_driver*)dev->device->driver;
-		struct cdi_storage_device *device = (struct cdi_storage_device*)dev->device;
-		uint64_t block_start = start / device->block_size;
-		uint64_t block_count = size / device->block_size + ((size % device->block_size) ? 1 : 0);
-		if(block_start + block_count > device->block_count)
-			block_count = device->block_count - block_start;
-		void *block_buffer = malloc(device->block_size * block_count);
-
-		//Gerät reservieren
-		semaphore_acquire(&dev->semaphore);
-		if(driver->read_blocks(device, block_start, block_count, block_buffer))
-		{
-			semaphore_release(&dev->semaphore);
+		if(dev->queue == NULL)
 			return 0;
-		}
-		semaphore_release(&dev->semaphore);
-
-		memcpy((void*)buffer, block_buffer + block_start % device->block_size, size);
-		free(block_buffer);
+		return blkqueue_read(dev->queue, start, iov, count);
 	}
 	else if(dev->device->bus_data->bus_type == CDI_SCSI)
 	{
-		struct cdi_scsi_driver *driver = (struct cdi_scsi_driver*)dev->device->driver;
-		struct cdi_scsi_device *device = (struct cdi_scsi_device*)dev->device;
-
-		uint32_t lba = start / 2048;
-		uint64_t tmp_size = MIN(size, 2048);
-		uint64_t offset = 0;
-		void *tmp_buffer = malloc(2048);
-		do
-		{
-			uint32_t length = 1;
-			struct cdi_scsi_packet packet = {
-				.buffer = tmp_buffer,
-				.bufsize = 2048,
-				.cmdsize = 12,
-				.command = {0xA8, 0, GET_BYTE(lba, 0x18), GET_BYTE(lba, 0x10), GET_BYTE(lba, 0x08), GET_BYTE(lba, 0x00),
-						GET_BYTE(length, 0x18), GET_BYTE(length, 0x10), GET_BYTE(length, 0x08), GET_BYTE(length, 0x00), 0, 0},
-				.direction = CDI_SCSI_READ
-			};
-
-			//Gerät reservieren
-			semaphore_acquire(&dev->semaphore);
-			if(driver->request(device, &packet))
-			{
-				semaphore_release(&dev->semaphore);
-				return 0;
-			}
-			semaphore_release(&dev->semaphore);
-
-			memcpy((void*)buffer + offset, tmp_buffer + start % 2048 + offset, tmp_size);
-			offset += tmp_size;
-			tmp_size = MIN(size - offset, 2048);
-		}
-		while(offset < size);
-		free(tmp_buffer);
+		//Gerät reservieren
+		semaphore_acquire(&dev->semaphore);
+		bool success = dmng_scsiReadCached(dev, start, size, iov, count);
+		semaphore_release(&dev->semaphore);
+		if(!success)
+			return 0;
 	}
 	else
 		return 0;
@@ -123,6 +213,40 @@ size_t dmng_Read(device_t *dev, uint64_t start, size_t size, void *buffer)
 	return size;
 }
 
+/*
+ * Schreibt auf einen Datenträger
+ * Parameter:	dev = Gerät auf das geschrieben werden soll
+ * 				start = Byte an dem angefangen werden soll zu schreiben
+ * 				size = Anzahl Bytes die geschrieben werden sollen
+ * 				buffer = Buffer aus dem die Daten gelesen werden
+ * Rückgabe:	0 bei Fehler und sonst die geschriebenen Bytes
+ */
+size_t dmng_Write(device_t *dev, uint64_t start, size_t size, const void *buffer)
+{
+	vfs_iovec_t iov = {
+			.base = (void*)buffer,
+			.length = size
+	};
+	if(buffer == NULL) return 0;
+	return dmng_WriteVector(dev, start, &iov, 1);
+}
+
+/*
+ * Schreibt Daten aus mehreren Puffern zusammenhängend auf einen Datenträger. Nur Blockgeräte
+ * können beschrieben werden.
+ * Parameter:	dev = Gerät auf das geschrieben werden soll
+ * 				start = Byte an dem angefangen werden soll zu schreiben
+ * 				iov = Puffer, die nacheinander geschrieben werden
+ * 				count = Anzahl Puffer
+ * Rückgabe:	0 bei Fehler und sonst die geschriebenen Bytes
+ */
+size_t dmng_WriteVector(device_t *dev, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	if(iov == NULL || dev->queue == NULL)
+		return 0;
+	return blkqueue_write(dev->queue, start, iov, count);
+}
+
 void *dmng_getValue(device_t *dev, vfs_device_function_t function)
 {
 	switch(function)
@@ -16,17 +16,29 @@
 #include "stddef.h"
 #include "vfs.h"
 #include "semaphore.h"
+#include "blkqueue.h"
 
 typedef struct{
 	struct cdi_device *device;
 	list_t partitions;
-	semaphore_t semaphore;
+	semaphore_t semaphore;		//Für SCSI-Geräte
+	blkqueue_t *queue;			//Für Blockgeräte
+
+	//Vorausgelesene Sektoren von SCSI-Geräten, durch semaphore geschützt
+	struct{
+		void *buffer;
+		uint64_t lba;			//Erster Sektor im Puffer
+		size_t count;			//Anzahl gültiger Sektoren
+		uint64_t next;			//Sektor nach dem letzten Zugriff, um sequentielles Lesen zu erkennen
+	}readahead;
 }device_t;
 
 void dmng_Init(void);
 void dmng_registerDevice(struct cdi_device *dev);
 size_t dmng_Read(device_t *dev, uint64_t start, size_t size, void *buffer);
+size_t dmng_ReadVector(device_t *dev, uint64_t start, const vfs_iovec_t *iov, size_t count);
 size_t dmng_Write(device_t *dev, uint64_t start, size_t size, const void *buffer);
+size_t dmng_WriteVector(device_t *dev, uint64_t start, const vfs_iovec_t *iov, size_t count);
 
 void *dmng_getValue(device_t *dev, vfs_device_function_t function);
 
@@ -41,6 +41,9 @@
 
 #define AHCI_IRQ_TIMEOUT 5000 /* ms */
 
+/* Number of command slots used per port */
+#define AHCI_MAX_SLOTS 8
+
 enum {
     ATA_CMD_READ_DMA            = 0xc8,
     ATA_CMD_READ_DMA_EXT        = 0x25,
@@ -134,6 +137,21 @@ enum {
     SATA_SIG_QEMU_CD    = 0xeb140000, /* Broken value in qemu < 2.2 */
 };
 
+struct ahci_slot {
+    /* Asynchronous request, NULL for synchronous ones */
+    struct cdi_storage_request* req;
+
+    /* DMA buffer for asynchronous requests, kept for the next request */
+    struct cdi_mem_area*        bounce;
+
+    struct cdi_mem_area*        buf;
+    uint64_t                    bytes;
+    bool                        read;
+
+    int                         result;
+    volatile int                done;
+};
+
 struct ahci_port {
     struct cdi_mem_area*        fis;
     uint64_t                    fis_phys;
@@ -142,12 +160,22 @@ struct ahci_port {
     struct cdi_mem_area*        cmd_list_mem;
     uint64_t                    cmd_list_phys;
 
-    /* TODO More than one command with one PRDT entry */
+    /* One command table with one PRDT entry per slot */
     struct cmd_table*           cmd_table;
     struct cdi_mem_area*        cmd_table_mem;
     uint64_t                    cmd_table_phys;
 
     uint32_t                    last_is;
+
+    int                         num_slots;
+    volatile uint32_t           active;     /* Allocated command slots */
+    volatile uint32_t           issued;     /* Issued, but not yet completed */
+
+    /* Set in the IRQ handler, recovery happens in the next request */
+    volatile int                need_recovery;
+    uint32_t                    recovery_is;
+
+    struct ahci_slot            slot[AHCI_MAX_SLOTS];
 };
 
 struct ahci_device {
@@ -348,6 +376,9 @@ static inline uint32_t pxreg_inl(struct ahci_device* ahci, int port, int reg)
 /* ahci/main.c */
 void ahci_port_comreset(struct ahci_device* ahci, int port);
 
+/* ahci/disk.c */
+void ahci_port_complete(struct ahci_device* ahci, int port, uint32_t is);
+
 /* ahci/disk.c */
 extern struct cdi_storage_driver ahci_disk_driver;
 extern struct cdi_scsi_driver ahci_atapi_driver;
@@ -31,14 +31,14 @@
 #include "cdi/misc.h"
 
 #include "ahci.h"
+#include "trace.h"
 
 #define DISK_DRIVER_NAME "ahci-disk"
 #define ATAPI_DRIVER_NAME "ahci-cd"
 
 /**
- * This function is called for any requests (even succeeding ones). Its job is
- * to recover from any failures and decide whether a request must return
- * failues.
+ * Recovers from failures reported in the interrupt status is. It must only be
+ * called while no command is issued on the port (see ahci_port_recover()).
  *
  * @return 0 if the command can still be completed successfully, -1 if failure
  * should be returned.
@@ -72,16 +72,136 @@ static int ahci_request_handle_error(struct ahci_disk* disk, uint32_t is)
     return 0;
 }
 
-static int ahci_request(struct ahci_disk* disk, int cmd, uint64_t lba,
-                        uint64_t bytes, struct cdi_mem_area* buf, void* acmd)
+/**
+ * Restarts the port after a fatal error was reported by the IRQ handler. This
+ * needs exclusive access to the port, so it waits until all slots are free.
+ */
+static void ahci_port_recover(struct ahci_disk* disk)
 {
     struct ahci_port *port = &disk->ahci->port[disk->port];
-    uint32_t flags, device;
+    uint32_t all = BIT(port->num_slots) - 1;
 
-    if (buf->paddr.num != 1) {
-        return -1;
+    while (port->need_recovery) {
+        if (!__sync_bool_compare_and_swap(&port->active, 0, all)) {
+            cdi_sleep_ms(1);
+            continue;
+        }
+        if (port->need_recovery) {
+            ahci_request_handle_error(disk, port->recovery_is);
+            port->need_recovery = 0;
+        }
+        __sync_fetch_and_and(&port->active, ~all);
+    }
+}
+
+/**
+ * Allocates a free command slot.
+ *
+ * @return The slot number or -1 if all slots are in use
+ */
+static int ahci_slot_alloc(struct ahci_port* port)
+{
+    uint32_t active;
+    int i;
+
+    do {
+        active = port->active;
+        for (i = 0; i < port->num_slots; i++) {
+            if (!(active & BIT(i))) {
+                break;
+            }
+        }
+        if (i == port->num_slots) {
+            return -1;
+        }
+    } while (!__sync_bool_compare_and_swap(&port->active, active,
+                                           active | BIT(i)));
+
+    return i;
+}
+
+static void ahci_slot_free(struct ahci_port* port, int slot)
+{
+    __sync_fetch_and_and(&port->active, ~BIT(slot));
+}
+
+/**
+ * Completes the command in the given slot. The caller must have removed the
+ * slot from port->issued. May be called in interrupt context.
+ */
+static void ahci_slot_complete(struct ahci_port* port, int slot, int result)
+{
+    struct ahci_slot* s = &port->slot[slot];
+    struct cdi_storage_request* req = s->req;
+
+    if (req == NULL) {
+        /* Synchronous request, the waiting thread frees the slot */
+        s->result = result;
+        __sync_synchronize();
+        s->done = 1;
+        return;
     }
 
+    if (result == 0 && s->read) {
+        memcpy(req->buffer, s->buf->vaddr, s->bytes);
+    }
+
+    s->req = NULL;
+    ahci_slot_free(port, slot);
+    TRACE(TRACE_AHCI_COMPLETE, req->start, result);
+    cdi_storage_request_complete(req, result);
+}
+
+/**
+ * Completes all issued commands whose PxCI bit has been cleared by the HBA.
+ * If a fatal error is reported in is, all issued commands are failed and the
+ * port is restarted before the next request.
+ *
+ * Called by the IRQ handler, but also by synchronous requests in case an
+ * interrupt got lost.
+ */
+void ahci_port_complete(struct ahci_device* ahci, int port, uint32_t is)
+{
+    struct ahci_port* p = &ahci->port[port];
+    uint32_t done;
+    int i;
+
+    if (p->issued == 0) {
+        return;
+    }
+
+    if (is & (PxIS_HBFS | PxIS_HBDS | PxIS_IFS | PxIS_TFES)) {
+        p->recovery_is = is;
+        p->need_recovery = 1;
+        done = p->issued;
+    } else {
+        done = p->issued & ~pxreg_inl(ahci, port, REG_PxCI);
+    }
+
+    for (i = 0; i < p->num_slots; i++) {
+        if (!(done & BIT(i))) {
+            continue;
+        }
+        /* Only one caller may complete a slot */
+        if (__sync_fetch_and_and(&p->issued, ~BIT(i)) & BIT(i)) {
+            ahci_slot_complete(p, i, p->need_recovery ? -1 : 0);
+        }
+    }
+}
+
+/**
+ * Fills the command table and command header of a slot and issues the
+ * command.
+ */
+static void ahci_slot_issue(struct ahci_disk* disk, int slot, int cmd,
+                            uint64_t lba, uint64_t bytes,
+                            struct cdi_mem_area* buf, void* acmd)
+{
+    struct ahci_port *port = &disk->ahci->port[disk->port];
+    struct cmd_table* table = (struct cmd_table*)
+        ((uint8_t*) port->cmd_table + slot * CMD_TABLE_BYTES);
+    uint32_t flags, device;
+
     device = 0;
     if (cmd == ATA_CMD_READ_DMA || cmd == ATA_CMD_READ_DMA_EXT ||
         cmd == ATA_CMD_WRITE_DMA || cmd == ATA_CMD_WRITE_DMA_EXT)
@@ -89,7 +209,7 @@ static int ahci_request(struct ahci_disk* disk, int cmd, uint64_t lba,
         device |= 0x40;
     }
 
-    port->cmd_table->cfis = (struct h2d_fis) {
+    table->cfis = (struct h2d_fis) {
         .type           = FIS_TYPE_H2D,
         .flags          = H2D_FIS_F_COMMAND,
         .command        = cmd,
@@ -102,13 +222,13 @@ static int ahci_request(struct ahci_disk* disk, int cmd, uint64_t lba,
         .device         = device,
         .sector_count   = bytes / disk->storage.block_size,
     };
-    port->cmd_table->prdt[0] = (struct ahci_prd) {
+    table->prdt[0] = (struct ahci_prd) {
         .dba        = buf->paddr.items[0].start,
         .dbc        = bytes - 1,
     };
 
     if (acmd != NULL) {
-        memcpy(port->cmd_table->acmd, acmd, 16);
+        memcpy(table->acmd, acmd, 16);
     }
 
     flags = CMD_HEADER_F_FIS_LENGTH_5_DW;
@@ -119,29 +239,67 @@ static int ahci_request(struct ahci_disk* disk, int cmd, uint64_t lba,
         flags |= CMD_HEADER_F_ATAPI;
     }
 
-    port->cmd_list[0] = (struct cmd_header) {
+    port->cmd_list[slot] = (struct cmd_header) {
         .flags      = flags,
         .prdtl      = 1,
-        .prdbc      = buf->size,
-        .ctba0      = port->cmd_table_phys,
+        .prdbc      = 0,
+        .ctba0      = port->cmd_table_phys + slot * CMD_TABLE_BYTES,
     };
 
+    port->slot[slot].buf = buf;
+    port->slot[slot].bytes = bytes;
+    port->slot[slot].done = 0;
+    __sync_synchronize();
+
+    /*
+     * The slot is marked as issued only after writing PxCI, so that the IRQ
+     * handler can't mistake it for completed. If the command completed in
+     * between, the interrupt has already been handled and we have to complete
+     * it ourselves.
+     */
+    pxreg_outl(disk->ahci, disk->port, REG_PxCI, BIT(slot));
+    __sync_fetch_and_or(&port->issued, BIT(slot));
+    if (!(pxreg_inl(disk->ahci, disk->port, REG_PxCI) & BIT(slot)) &&
+        (__sync_fetch_and_and(&port->issued, ~BIT(slot)) & BIT(slot)))
+    {
+        ahci_slot_complete(port, slot, port->need_recovery ? -1 : 0);
+    }
+}
+
+static int ahci_request(struct ahci_disk* disk, int cmd, uint64_t lba,
+                        uint64_t bytes, struct cdi_mem_area* buf, void* acmd)
+{
+    struct ahci_port *port = &disk->ahci->port[disk->port];
+    struct ahci_slot* s;
+    int slot, ret;
+
+    if (buf->paddr.num != 1) {
+        return -1;
+    }
+
+    ahci_port_recover(disk);
+    while ((slot = ahci_slot_alloc(port)) < 0) {
+        cdi_sleep_ms(1);
+    }
+    s = &port->slot[slot];
+    s->req = NULL;
+
+    TRACE(TRACE_AHCI_REQUEST, lba, bytes);
     cdi_reset_wait_irq(disk->ahci->irq);
-    pxreg_outl(disk->ahci, disk->port, REG_PxCI, 0x1);
+    ahci_slot_issue(disk, slot, cmd, lba, bytes, buf, acmd);
 
-    do {
+    while (!s->done) {
         cdi_wait_irq(disk->ahci->irq, AHCI_IRQ_TIMEOUT);
-        if (ahci_request_handle_error(disk, port->last_is) < 0) {
-            return -1;
-        }
         cdi_reset_wait_irq(disk->ahci->irq);
-    } while (pxreg_inl(disk->ahci, disk->port, REG_PxCI) & 0x1);
-
-    if (ahci_request_handle_error(disk, port->last_is) < 0) {
-        return -1;
+        ahci_port_complete(disk->ahci, disk->port, 0);
     }
 
-    return 0;
+    __sync_synchronize();
+    ret = s->result;
+    ahci_slot_free(port, slot);
+    TRACE(TRACE_AHCI_COMPLETE, lba, ret);
+
+    return ret;
 }
 
 static int ahci_identify(struct ahci_disk* disk)
@@ -204,6 +362,60 @@ static int ahci_rw_blocks(struct cdi_storage_device* device, uint64_t start,
     return ret;
 }
 
+/**
+ * Starts an asynchronous request. The data is transferred through a DMA
+ * buffer that belongs to the command slot and is reused by later requests.
+ */
+static int ahci_submit(struct cdi_storage_device* device,
+                       struct cdi_storage_request* req)
+{
+    struct ahci_disk* disk = (struct ahci_disk*) device;
+    struct ahci_port *port = &disk->ahci->port[disk->port];
+    uint64_t bytes = req->count * disk->storage.block_size;
+    struct ahci_slot* s;
+    int slot, cmd;
+
+    /* Limited by the sector count and by the single PRDT entry */
+    if (req->count == 0 || req->count > 0xffff ||
+        (!disk->lba48 && req->count > 0xff) || bytes > 0x400000)
+    {
+        return -1;
+    }
+
+    ahci_port_recover(disk);
+    slot = ahci_slot_alloc(port);
+    if (slot < 0) {
+        return CDI_STORAGE_BUSY;
+    }
+    s = &port->slot[slot];
+
+    if (s->bounce == NULL || s->bounce->size < bytes) {
+        if (s->bounce != NULL) {
+            cdi_mem_free(s->bounce);
+        }
+        s->bounce = cdi_mem_alloc(bytes,
+                                  CDI_MEM_PHYS_CONTIGUOUS | CDI_MEM_DMA_4G | 1);
+        if (s->bounce == NULL) {
+            ahci_slot_free(port, slot);
+            return -1;
+        }
+    }
+
+    if (req->write) {
+        cmd = disk->lba48 ? ATA_CMD_WRITE_DMA_EXT : ATA_CMD_WRITE_DMA;
+        memcpy(s->bounce->vaddr, req->buffer, bytes);
+    } else {
+        cmd = disk->lba48 ? ATA_CMD_READ_DMA_EXT : ATA_CMD_READ_DMA;
+    }
+
+    s->req = req;
+    s->read = !req->write;
+    TRACE(TRACE_AHCI_REQUEST, req->start, bytes);
+    ahci_slot_issue(disk, slot, cmd, req->start, bytes, s->bounce, NULL);
+
+    return 0;
+}
+
 static int ahci_read_blocks(struct cdi_storage_device* device, uint64_t start,
                             uint64_t count, void* buffer)
 {
@@ -257,9 +469,14 @@ static int ahci_disk_init(struct ahci_disk* disk)
     pxreg_outl(ahci, port, REG_PxCLB, p->cmd_list_phys);
     pxreg_outl(ahci, port, REG_PxCLBU, 0); /* TODO Support 64 bit */
 
+    p->num_slots = ahci->cmd_slots;
+    if (p->num_slots > AHCI_MAX_SLOTS) {
+        p->num_slots = AHCI_MAX_SLOTS;
+    }
+
     /* Command tables must be 128-byte aligned */
     p->cmd_table_mem =
-        cdi_mem_alloc(CMD_TABLE_BYTES,
+        cdi_mem_alloc(p->num_slots * CMD_TABLE_BYTES,
                       CDI_MEM_PHYS_CONTIGUOUS | CDI_MEM_DMA_4G | 7);
     if (p->cmd_table_mem == NULL) {
         printf("ahci: Could not allocate Command Table\n");
@@ -451,6 +668,7 @@ struct cdi_storage_driver ahci_disk_driver = {
     },
     .read_blocks        = ahci_read_blocks,
     .write_blocks       = ahci_write_blocks,
+    .submit             = ahci_submit,
 };
 
 struct cdi_scsi_driver ahci_atapi_driver = {
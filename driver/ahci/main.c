@@ -87,7 +87,8 @@ static int ahci_init_hardware(struct ahci_device* ahci)
     }
 
     /* Determine number of command slots */
-    ahci->cmd_slots = (reg_inl(ahci, REG_CAP) & CAP_NCS_MASK) >> CAP_NCS_SHIFT;
+    /* CAP.NCS is zero-based */
+    ahci->cmd_slots = ((reg_inl(ahci, REG_CAP) & CAP_NCS_MASK) >> CAP_NCS_SHIFT) + 1;
 
     /* All ports: Power On Device, Spin-Up Device, Link Active */
     for (port = 0; port < MAX_PORTS; port++) {
@@ -219,9 +220,11 @@ static void irq_handler(struct cdi_device* dev)
         port_is = pxreg_inl(ahci, port, REG_PxIS);
         pxreg_outl(ahci, port, REG_PxIS, port_is);
         p->last_is = port_is;
+
+        ahci_port_complete(ahci, port, port_is);
     }
 
-    /* For the actual interrupt handling, we use cdi_wait_irq(). */
+    /* Synchronous requests additionally wait with cdi_wait_irq(). */
     reg_outl(ahci, REG_IS, is);
 }
 
@@ -256,6 +259,8 @@ static struct cdi_device* ahci_init_device(struct cdi_bus_data* bus_data)
         goto fail;
     }
 
+    /* Prefer MSI, the legacy interrupt line may be shared */
+    cdi_pci_enable_msi(pci, 1);
     ahci->irq = pci->irq;
     cdi_register_irq(ahci->irq, irq_handler, &ahci->dev);
 
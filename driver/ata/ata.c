@@ -122,6 +122,7 @@ static int ata_drv_rw_sectors(struct ata_device* dev, int direction,
     uint64_t lba = start;
     int max_count;
     int again = 2;
+    int current_result;
     // Anzahl der Sektoren die noch uebrig sind
     size_t count_left = count;
 
@@ -192,7 +193,10 @@ static int ata_drv_rw_sectors(struct ata_device* dev, int direction,
         // TODO: CHS
         
         // Request ausfuehren
-        if (!ata_request(&request)) {
+        ata_channel_lock(dev->controller);
+        current_result = ata_request(&request);
+        ata_channel_unlock(dev->controller);
+        if (!current_result) {
             if (again) {
                 again--;
                 continue;
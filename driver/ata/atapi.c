@@ -124,6 +124,10 @@ int atapi_request(struct cdi_scsi_device* scsi,struct cdi_scsi_packet* packet)
         .error = 0
     };
 
+    int result = 0xB;
+
+    // Der Kanal muss fuer das Paket und die Daten reserviert bleiben
+    ata_channel_lock(dev->controller);
     if (ata_request(&request))
     {
         int status;
@@ -157,11 +161,12 @@ int atapi_request(struct cdi_scsi_device* scsi,struct cdi_scsi_packet* packet)
         // Bei Fehler den Sense Key zurueckgeben
         status = ata_reg_inb(dev->controller, REG_STATUS);
         if (status & STATUS_ERR) {
-            return (ata_reg_inb(dev->controller, REG_ERROR) >> 4);
+            result = (ata_reg_inb(dev->controller, REG_ERROR) >> 4);
         } else {
-            return 0;
+            result = 0;
         }
     }
+    ata_channel_unlock(dev->controller);
 
-    return 0xB;
+    return result;
 }
@@ -135,10 +135,51 @@ static int ata_bus_responsive_drv(struct ata_controller* controller)
  */
 static void ata_controller_irq(struct cdi_device* dev)
 {
-    // Hier muessen wir eigentlich garnichts tun, da wir immer nur auf IRQs
-    // warten wollen, und dafuer stellt CDI Funktionen zur Verfuegung. Doch
-    // registriert muss der IRQ dennoch werden, und dort muessen wir einen
-    // Handler angeben, sonst fliegt uns das beim ersten IRQ um die Ohren.
+    struct ata_controller* controller = ((struct ata_device*) dev)->controller;
+    struct cdi_storage_request* request = controller->async_req;
+    int result;
+
+    // Auf die IRQs von synchronen Requests wird mit den Funktionen von CDI
+    // gewartet, hier muessen nur asynchrone Requests abgeschlossen werden.
+    if (request == NULL) {
+        return;
+    }
+
+    result = ata_request_dma_finish(&controller->async);
+    if (result < 0) {
+        return;
+    }
+
+    // Der Request koennte gleichzeitig wegen Timeout abgebrochen werden
+    if (!__sync_bool_compare_and_swap(&controller->async_req, request, NULL)) {
+        return;
+    }
+    pit_StopTimer(&controller->async_timer);
+
+    ata_channel_unlock(controller);
+    cdi_storage_request_complete(request, result ? 0 : -1);
+}
+
+/**
+ * Wird aufgerufen, wenn der IRQ eines asynchronen Requests nicht rechtzeitig
+ * gekommen ist. Der Request wird mit einem Fehler abgeschlossen und der Kanal
+ * zurueckgesetzt.
+ */
+static void ata_async_timeout(void* opaque)
+{
+    struct ata_controller* controller = opaque;
+    struct cdi_storage_request* request = controller->async_req;
+
+    if (request == NULL ||
+        !__sync_bool_compare_and_swap(&controller->async_req, request, NULL))
+    {
+        return;
+    }
+
+    DEBUG("Timeout bei asynchronem DMA-Request\n");
+    ata_request_dma_abort(&controller->async);
+    ata_channel_unlock(controller);
+    cdi_storage_request_complete(request, -1);
 }
 
 /**
@@ -186,6 +227,8 @@ void ata_init_controller(struct ata_controller* controller)
     // ein IRQ-Handler registriert werden. Und dafuer brauchen wir nun mal ein
     // Geraet.
     controller->irq_dev.controller = controller;
+    controller->async_timer.callback = ata_async_timeout;
+    controller->async_timer.opaque = controller;
     cdi_register_irq(controller->irq, ata_controller_irq, (struct cdi_device*)
         &controller->irq_dev);
 
@@ -268,7 +311,7 @@ void ata_init_controller(struct ata_controller* controller)
     if (controller->port_bmr_base) {
         struct cdi_mem_area* buf;
 
-        buf = cdi_mem_alloc(sizeof(uint64_t),
+        buf = cdi_mem_alloc(ATA_PRDT_ENTRIES * sizeof(uint64_t),
             CDI_MEM_PHYS_CONTIGUOUS | CDI_MEM_DMA_4G);
         controller->prdt_virt = buf->vaddr;
         controller->prdt_phys = buf->paddr.items[0].start;
@@ -336,6 +379,91 @@ int ata_read_blocks(struct cdi_storage_device* device, uint64_t block,
     }
 }
 
+/**
+ * Asynchronen Request starten. Nur DMA-Requests, die in einem Durchgang
+ * uebertragen werden koennen, laufen asynchron und werden im IRQ-Handler
+ * abgeschlossen. Alle anderen werden sofort synchron ausgefuehrt.
+ *
+ * @return 0 wenn der Request gestartet wurde, CDI_STORAGE_BUSY wenn der Kanal
+ *         belegt ist, -1 bei einem Fehler
+ */
+int ata_submit(struct cdi_storage_device* device,
+    struct cdi_storage_request* request)
+{
+    struct ata_device* dev = (struct ata_device*) device;
+    struct ata_controller* ctrl;
+    uint64_t lba = request->start;
+    int result;
+
+    // Wenn der Pointer auf den Controller NULL ist, handelt es sich um eine
+    // Partition
+    if (dev->controller == NULL) {
+        struct ata_partition* partition = (struct ata_partition*) dev;
+        dev = partition->realdev;
+        lba += partition->start;
+    }
+    ctrl = dev->controller;
+
+    // TODO: LBA48
+    if (!dev->dma || !ctrl->dma_use || dev->atapi || request->count == 0 ||
+        request->count > ATA_DMA_MAXSIZE / ATA_SECTOR_SIZE ||
+        lba + request->count > (1 << 28))
+    {
+        if (request->write) {
+            result = ata_write_blocks(device, request->start, request->count,
+                request->buffer);
+        } else {
+            result = ata_read_blocks(device, request->start, request->count,
+                request->buffer);
+        }
+        cdi_storage_request_complete(request, result ? -1 : 0);
+        return 0;
+    }
+
+    if (!ata_channel_trylock(ctrl)) {
+        return CDI_STORAGE_BUSY;
+    }
+
+    ctrl->async = (struct ata_request) {
+        .dev = dev,
+        .protocol = DMA,
+        .flags = {
+            .direction = request->write ? WRITE : READ,
+            .poll = 0,
+            .ata = 0,
+            .lba = 1
+        },
+        .registers = {
+            .ata = {
+                .command = request->write ? WRITE_SECTORS_DMA :
+                    READ_SECTORS_DMA,
+                .count = (uint8_t) request->count,
+                .lba = lba
+            }
+        },
+        .block_count = request->count,
+        .block_size = ATA_SECTOR_SIZE,
+        .blocks_done = 0,
+        .buffer = request->buffer,
+        .error = NO_ERROR
+    };
+
+    // Muss vor dem Starten gesetzt sein, da der IRQ sofort kommen kann
+    ctrl->async_req = request;
+    pit_StartTimer(&ctrl->async_timer, ATA_ASYNC_TIMEOUT);
+    if (!ata_request_dma_start(&ctrl->async)) {
+        // Wenn der Timer schon abgelaufen ist, hat er den Request abgeschlossen
+        if (!pit_StopTimer(&ctrl->async_timer)) {
+            return 0;
+        }
+        ctrl->async_req = NULL;
+        ata_channel_unlock(ctrl);
+        return -1;
+    }
+
+    return 0;
+}
+
 /**
  * Blocks auf ein ATA(PI) Geraet schreiben
  */
@@ -38,6 +38,7 @@
 #include "cdi/io.h"
 #include "cdi/lists.h"
 #include "cdi/scsi.h"
+#include "pit.h"
 
 #define ATAPI_ENABLE
 
@@ -67,6 +68,10 @@
 // Timeout beim Warten auf einen IRQ
 #define ATA_IRQ_TIMEOUT         500
 
+// Nach dieser Zeit wird ein asynchroner DMA-Request abgebrochen, wenn sein IRQ
+// nicht gekommen ist
+#define ATA_ASYNC_TIMEOUT       5000
+
 // Normale Sektorgroesse
 #define ATA_SECTOR_SIZE         512
 
@@ -122,8 +127,10 @@
 #define BMR_STATUS_ERROR        (1 << 1)
 #define BMR_STATUS_IRQ          (1 << 2)
 
-/// Maximale Groesse eines DMA-Transfers
-#define ATA_DMA_MAXSIZE         (64 * 1024)
+/// Maximale Groesse eines DMA-Transfers (256 Sektoren mit LBA28)
+#define ATA_DMA_MAXSIZE         (256 * ATA_SECTOR_SIZE)
+/// Anzahl Eintraege in der PRDT (eine Page)
+#define ATA_PRDT_ENTRIES        512
 
 
 // Debug
@@ -347,35 +354,6 @@ struct ata_device {
         size_t count, void* dest);
 };
 
-struct ata_controller {
-    struct cdi_storage_driver   *storage;
-    struct cdi_scsi_driver      *scsi;
-
-    uint8_t                     id;
-    uint16_t                    port_cmd_base;
-    uint16_t                    port_ctl_base;
-    uint16_t                    port_bmr_base;
-    uint16_t                    irq;
-
-    // Wird auf 1 gesetzt wenn IRQs benutzt werden sollen, also das NIEN-Bit im
-    // Control register nicht aktiviert ist.
-    int                         irq_use;
-    /// Wird auf 1 gesetzt wenn DMA benutzt werden darf
-    int                         dma_use;
-    // HACKKK ;-)
-    struct ata_device           irq_dev;
-
-
-    /// Physische Adresse der Physical Region Descriptor Table (fuer DMA)
-    uintptr_t                   prdt_phys;
-    /// Virtuelle Adresse der Physical Region Descriptor Table (fuer DMA)
-    uint64_t*                   prdt_virt;
-    /// Physische Adresse des DMA-Puffers
-    uintptr_t                   dma_buf_phys;
-    /// Virtuelle Adresse des DMA-Puffers
-    void*                       dma_buf_virt;
-};
-
 struct ata_request {
     struct ata_device* dev;
     
@@ -433,6 +411,10 @@ struct ata_request {
     // Puffer in den die Daten geschrieben werden sollen/aus dem sie gelesen
     // werden sollen.
     void* buffer;
+
+    // 1 wenn die PRDT direkt auf den Puffer zeigt, 0 wenn der DMA-Puffer des
+    // Controllers benutzt wird
+    int dma_direct;
     
     // Moegliche Fehler
     enum {
@@ -443,6 +425,45 @@ struct ata_request {
     } error;
 };
 
+struct ata_controller {
+    struct cdi_storage_driver   *storage;
+    struct cdi_scsi_driver      *scsi;
+
+    uint8_t                     id;
+    uint16_t                    port_cmd_base;
+    uint16_t                    port_ctl_base;
+    uint16_t                    port_bmr_base;
+    uint16_t                    irq;
+
+    // Wird auf 1 gesetzt wenn IRQs benutzt werden sollen, also das NIEN-Bit im
+    // Control register nicht aktiviert ist.
+    int                         irq_use;
+    /// Wird auf 1 gesetzt wenn DMA benutzt werden darf
+    int                         dma_use;
+    // HACKKK ;-)
+    struct ata_device           irq_dev;
+
+
+    /// Physische Adresse der Physical Region Descriptor Table (fuer DMA)
+    uintptr_t                   prdt_phys;
+    /// Virtuelle Adresse der Physical Region Descriptor Table (fuer DMA)
+    uint64_t*                   prdt_virt;
+    /// Physische Adresse des DMA-Puffers, wird benutzt wenn der Puffer des
+    /// Requests nicht direkt fuer DMA benutzt werden kann
+    uintptr_t                   dma_buf_phys;
+    /// Virtuelle Adresse des DMA-Puffers
+    void*                       dma_buf_virt;
+
+    /// 1 solange ein Request auf dem Kanal laeuft (siehe ata_channel_lock)
+    volatile int                busy;
+    /// Laufender asynchroner Request, wird im IRQ-Handler abgeschlossen
+    struct cdi_storage_request* volatile async_req;
+    /// ATA-Request zum laufenden asynchronen Request
+    struct ata_request          async;
+    /// Bricht den asynchronen Request ab, wenn der IRQ verloren geht
+    pit_timer_t                 async_timer;
+};
+
 void ata_init_controller(struct ata_controller* controller);
 void ata_remove_controller(struct ata_controller* controller);
 void ata_init_device(struct ata_device* dev);
@@ -451,11 +472,23 @@ int ata_read_blocks(struct cdi_storage_device* device, uint64_t block,
     uint64_t count, void* buffer);
 int ata_write_blocks(struct cdi_storage_device* device, uint64_t block,
     uint64_t count, void* buffer);
+int ata_submit(struct cdi_storage_device* device,
+    struct cdi_storage_request* request);
+
+// Kanal fuer einen Request reservieren
+int ata_channel_trylock(struct ata_controller* controller);
+void ata_channel_lock(struct ata_controller* controller);
+void ata_channel_unlock(struct ata_controller* controller);
 
 
 // Einen ATA-Request absenden und ausfuehren
 int ata_request(struct ata_request* request);
 
+// DMA-Request starten und im IRQ-Handler abschliessen
+int ata_request_dma_start(struct ata_request* request);
+int ata_request_dma_finish(struct ata_request* request);
+void ata_request_dma_abort(struct ata_request* request);
+
 int ata_protocol_pio_out(struct ata_request* request);
 int ata_protocol_pio_in(struct ata_request* request);
 
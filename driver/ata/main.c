@@ -185,6 +185,7 @@ static struct cdi_storage_driver driver_storage = {
     },
     .read_blocks        = ata_read_blocks,
     .write_blocks       = ata_write_blocks,
+    .submit             = ata_submit,
 };
 
 static struct cdi_scsi_driver driver_scsi = {
@@ -34,6 +34,7 @@
 #include "cdi/storage.h"
 #include "cdi/misc.h"
 #include "cdi/io.h"
+#include "cdi/mem.h"
 
 #include "device.h"
 
@@ -412,19 +413,82 @@ int ata_protocol_pio_out(struct ata_request* request)
 }
 
 /**
- * Initialisiert DMA fuer einen Transfer
+ * Traegt einen physisch zusammenhaengenden Bereich in die PRDT ein. Ein
+ * Eintrag darf hoechstens 64K gross sein und keine 64K-Grenze ueberschreiten,
+ * groessere Bereiche werden deshalb auf mehrere Eintraege verteilt.
+ *
+ * @param n Anzahl der schon benutzten Eintraege
+ *
+ * @return Anzahl der benutzten Eintraege oder 0, wenn der Bereich nicht fuer
+ *         DMA benutzt werden kann oder die PRDT voll ist.
+ */
+static size_t ata_prdt_add(struct ata_controller* ctrl, size_t n,
+    uint64_t start, uint64_t size)
+{
+    uint64_t length;
+
+    while (size > 0) {
+        length = 0x10000 - (start & 0xFFFF);
+        if (length > size) {
+            length = size;
+        }
+
+        // Der Controller kann nur gerade Adressen unterhalb von 4G benutzen
+        if ((n >= ATA_PRDT_ENTRIES) || (start + length > 0x100000000ULL) ||
+            (start & 1) || (length & 1))
+        {
+            return 0;
+        }
+
+        // Groesse 0 == 64K
+        ctrl->prdt_virt[n++] = (uint32_t) start | ((length & 0xFFFF) << 32L);
+        start += length;
+        size -= length;
+    }
+
+    return n;
+}
+
+/**
+ * Initialisiert DMA fuer einen Transfer. Wenn moeglich wird direkt in den
+ * Puffer des Requests uebertragen, sonst ueber den DMA-Puffer des Controllers.
  */
 static int ata_request_dma_init(struct ata_request* request)
 {
     struct ata_device* dev = request->dev;
     struct ata_controller* ctrl = dev->controller;
     uint64_t size = request->block_size * request->block_count;
+    struct cdi_mem_area* area;
+    size_t n = 0;
+    size_t i;
+
+    // PRDT aus den physischen Seiten des Puffers aufbauen
+    request->dma_direct = 0;
+    area = cdi_mem_describe(request->buffer, size);
+    if (area != NULL) {
+        for (i = 0; i < area->paddr.num; i++) {
+            n = ata_prdt_add(ctrl, n, area->paddr.items[i].start,
+                area->paddr.items[i].size);
+            if (n == 0) {
+                break;
+            }
+        }
+        request->dma_direct = (n != 0);
+        cdi_mem_free(area);
+    }
+
+    if (!request->dma_direct) {
+        if (size > ATA_DMA_MAXSIZE) {
+            return 0;
+        }
+        n = ata_prdt_add(ctrl, 0, ctrl->dma_buf_phys, size);
+        if (request->flags.direction != READ) {
+            memcpy(ctrl->dma_buf_virt, request->buffer, size);
+        }
+    }
 
-    *ctrl->prdt_virt = (uint32_t) ctrl->dma_buf_phys;
-    // Groesse nicht ueber 64K, 0 == 64K
-    *ctrl->prdt_virt |= (size & (ATA_DMA_MAXSIZE - 1)) << 32L;
     // Letzter Eintrag in PRDT
-    *ctrl->prdt_virt |= (uint64_t) 1L << 63L;
+    ctrl->prdt_virt[n - 1] |= (uint64_t) 1L << 63L;
 
     // Die laufenden Transfers anhalten
     cdi_outb(ctrl->port_bmr_base + BMR_COMMAND, 0);
@@ -435,26 +499,15 @@ static int ata_request_dma_init(struct ata_request* request)
     // Adresse der PRDT eintragen
     cdi_outl(ctrl->port_bmr_base + BMR_PRDT, ctrl->prdt_phys);
 
-    if (request->flags.direction != READ) {
-        memcpy(ctrl->dma_buf_virt, request->buffer, size);
-    }
     return 1;
 }
 
 /**
- * Verarbeitet einen ATA-Request bei dem Daten ueber DMA uebertragen werden
- * sollen
+ * Busmastering fuer einen DMA-Request starten
  */
-static int ata_protocol_dma(struct ata_request* request)
+static void ata_dma_start(struct ata_request* request)
 {
-    struct ata_device* dev = request->dev;
-    struct ata_controller* ctrl = dev->controller;
-
-    // Aktueller Status im Protokoll
-    enum {
-        IRQ_WAIT,
-        CHECK_STATUS,
-    } state;
+    struct ata_controller* ctrl = request->dev->controller;
 
     // Wozu das lesen und dieser Register gut ist, weiss ich nicht, doch ich
     // habe es so in verschiedenen Treibern gesehen, deshalb gehe ich mal davon
@@ -471,7 +524,24 @@ static int ata_protocol_dma(struct ata_request* request)
     }
     cdi_inb(ctrl->port_bmr_base + BMR_COMMAND);
     cdi_inb(ctrl->port_bmr_base + BMR_STATUS);
+}
+
+/**
+ * Verarbeitet einen ATA-Request bei dem Daten ueber DMA uebertragen werden
+ * sollen
+ */
+static int ata_protocol_dma(struct ata_request* request)
+{
+    struct ata_device* dev = request->dev;
+    struct ata_controller* ctrl = dev->controller;
+
+    // Aktueller Status im Protokoll
+    enum {
+        IRQ_WAIT,
+        CHECK_STATUS,
+    } state;
 
+    ata_dma_start(request);
 
     if (request->flags.poll) {
         state = CHECK_STATUS;
@@ -508,13 +578,129 @@ static int ata_protocol_dma(struct ata_request* request)
     }
 
 out_success:
-    if (request->flags.direction == READ) {
+    if ((request->flags.direction == READ) && !request->dma_direct) {
         memcpy(request->buffer, ctrl->dma_buf_virt,
             request->block_size * request->block_count);
     }
     return 1;
 }
 
+/**
+ * Startet einen DMA-Request ohne auf dessen Ende zu warten. Der Kanal muss
+ * reserviert sein. Das Ende des Requests wird im IRQ-Handler mit
+ * ata_request_dma_finish() verarbeitet.
+ *
+ * @return 1 wenn der Request gestartet wurde, 0 sonst
+ */
+int ata_request_dma_start(struct ata_request* request)
+{
+    if (!ata_request_dma_init(request)) {
+        return 0;
+    }
+
+    if (!ata_request_command(request)) {
+        DEBUG("Fehler bei der Befehlsausfuehrung\n");
+        return 0;
+    }
+
+    ata_dma_start(request);
+    return 1;
+}
+
+/**
+ * Schliesst einen mit ata_request_dma_start() gestarteten Request ab. Wird im
+ * IRQ-Handler aufgerufen und darf deshalb nicht warten.
+ *
+ * @return 1 wenn der Request erfolgreich war, 0 bei einem Fehler und -1 wenn
+ *         der IRQ nicht vom Request ausgeloest wurde
+ */
+int ata_request_dma_finish(struct ata_request* request)
+{
+    struct ata_controller* ctrl = request->dev->controller;
+    uint8_t bmr_status, status;
+
+    bmr_status = cdi_inb(ctrl->port_bmr_base + BMR_STATUS);
+    if (!(bmr_status & BMR_STATUS_IRQ)) {
+        return -1;
+    }
+
+    // Das Lesen des Statusregisters bestaetigt den IRQ beim Geraet
+    status = ata_reg_inb(ctrl, REG_STATUS);
+    if (status & STATUS_BSY) {
+        return -1;
+    }
+
+    cdi_outb(ctrl->port_bmr_base + BMR_COMMAND, 0);
+    cdi_outb(ctrl->port_bmr_base + BMR_STATUS,
+        bmr_status | BMR_STATUS_ERROR | BMR_STATUS_IRQ);
+
+    if ((status & (STATUS_ERR | STATUS_DF)) ||
+        (bmr_status & BMR_STATUS_ERROR))
+    {
+        return 0;
+    }
+
+    if ((request->flags.direction == READ) && !request->dma_direct) {
+        memcpy(request->buffer, ctrl->dma_buf_virt,
+            request->block_size * request->block_count);
+    }
+    return 1;
+}
+
+/**
+ * Bricht einen mit ata_request_dma_start() gestarteten Request ab, dessen IRQ
+ * nicht gekommen ist. Das Busmastering wird angehalten und der Kanal mit einem
+ * Software-Reset zurueckgesetzt. Wird im Timerinterrupt aufgerufen und wartet
+ * deshalb nicht, bis die Geraete wieder bereit sind, das erledigt der naechste
+ * Request in ata_request_command().
+ */
+void ata_request_dma_abort(struct ata_request* request)
+{
+    struct ata_controller* ctrl = request->dev->controller;
+    int i;
+
+    cdi_outb(ctrl->port_bmr_base + BMR_COMMAND, 0);
+    cdi_outb(ctrl->port_bmr_base + BMR_STATUS,
+        cdi_inb(ctrl->port_bmr_base + BMR_STATUS) | BMR_STATUS_ERROR |
+        BMR_STATUS_IRQ);
+
+    // SRST muss mindestens 5 us gesetzt bleiben
+    ata_reg_outb(ctrl, REG_CONTROL, CONTROL_SRST | CONTROL_NIEN);
+    for (i = 0; i < 20; i++) {
+        ATA_DELAY(ctrl);
+    }
+    ata_reg_outb(ctrl, REG_CONTROL, ctrl->irq_use ? 0 : CONTROL_NIEN);
+}
+
+/**
+ * Kanal reservieren, falls er frei ist. Auf einem Kanal kann immer nur ein
+ * Request gleichzeitig laufen, auch wenn Master und Slave angeschlossen sind.
+ *
+ * @return 1 wenn der Kanal reserviert wurde, 0 wenn er belegt ist
+ */
+int ata_channel_trylock(struct ata_controller* controller)
+{
+    return !__sync_lock_test_and_set(&controller->busy, 1);
+}
+
+/**
+ * Kanal reservieren und wenn noetig warten, bis er frei ist
+ */
+void ata_channel_lock(struct ata_controller* controller)
+{
+    while (!ata_channel_trylock(controller)) {
+        cdi_sleep_ms(1);
+    }
+}
+
+/**
+ * Kanal wieder freigeben
+ */
+void ata_channel_unlock(struct ata_controller* controller)
+{
+    __sync_lock_release(&controller->busy);
+}
+
 /**
  * Fuehrt einen ATA-Request aus.
  *
@@ -16,6 +16,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <stdlib.h>
+
 #include "cdi/fs.h"
 #include "cdi/cache.h"
 
@@ -40,3 +42,37 @@ size_t iso9660_fs_file_read(struct cdi_fs_stream *stream,uint64_t start,size_t s
   //cdi_cache_entry_read(res->cache_entry,start,size,buffer);
   return size;
 }
+
+/**
+ * Reads from file into several buffers. The data of a file is stored
+ * contiguously on the medium, so the whole range is read with one request.
+ *  @param stream CDI FS stream
+ *  @param start Offset in file
+ *  @param iov Buffers to fill one after another
+ *  @param count Number of buffers
+ *  @return How many bytes read
+ */
+size_t iso9660_fs_file_readv(struct cdi_fs_stream *stream,uint64_t start,const struct cdi_fs_iovec *iov,size_t count) {
+  debug("iso9660_fs_file_readv(0x%x,0x%x,0x%x,0x%x)\n",stream,start,iov,count);
+  struct iso9660_fs_res *res = (struct iso9660_fs_res*)stream->res;
+  uint64_t pos = res->data_sector*res->voldesc->sector_size+start;
+  size_t size = 0;
+  size_t i;
+
+  if (start>=res->data_size) return 0;
+  for (i=0;i<count;i++) size += iov[i].length;
+  if (start+size<=res->data_size) return cdi_fs_data_readv(stream->fs,pos,iov,count);
+
+  // Don't read beyond the end of the file
+  struct cdi_fs_iovec *trimmed = malloc(count*sizeof(struct cdi_fs_iovec));
+  if (trimmed==NULL) return 0;
+  size_t rem_size = res->data_size-start;
+  for (i=0;i<count && rem_size>0;i++) {
+    trimmed[i].base = iov[i].base;
+    trimmed[i].length = iov[i].length<rem_size?iov[i].length:rem_size;
+    rem_size -= trimmed[i].length;
+  }
+  size = cdi_fs_data_readv(stream->fs,pos,trimmed,i);
+  free(trimmed);
+  return size;
+}
@@ -72,6 +72,7 @@ int64_t iso9660_fs_res_meta_read(struct cdi_fs_stream *stream,cdi_fs_meta_t meta
 
 // file.c
 size_t iso9660_fs_file_read(struct cdi_fs_stream *stream,uint64_t start,size_t size,void *buffer);
+size_t iso9660_fs_file_readv(struct cdi_fs_stream *stream,uint64_t start,const struct cdi_fs_iovec *iov,size_t count);
 
 // dir.c
 cdi_list_t iso9660_dir_load(struct iso9660_fs_res *res);
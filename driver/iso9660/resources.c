@@ -30,6 +30,7 @@ struct cdi_fs_res_file iso9660_fs_res_file = {
     .executable = 1,
 
     .read = iso9660_fs_file_read,
+    .readv = iso9660_fs_file_readv,
 };
 
 struct cdi_fs_res_dir iso9660_fs_res_dir = {
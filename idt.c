@@ -49,6 +49,23 @@ extern int44;
 extern int45;
 extern int46;
 extern int47;
+//MSI
+extern int64;
+extern int65;
+extern int66;
+extern int67;
+extern int68;
+extern int69;
+extern int70;
+extern int71;
+extern int72;
+extern int73;
+extern int74;
+extern int75;
+extern int76;
+extern int77;
+extern int78;
+extern int79;
 //Syscalls
 extern int48;
 extern int255;
@@ -95,6 +112,24 @@ void IDT_Init(void)
 	IDT_SetEntry(46, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int46);
 	IDT_SetEntry(47, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int47);
 
+	//MSI
+	IDT_SetEntry(64, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int64);
+	IDT_SetEntry(65, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int65);
+	IDT_SetEntry(66, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int66);
+	IDT_SetEntry(67, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int67);
+	IDT_SetEntry(68, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int68);
+	IDT_SetEntry(69, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int69);
+	IDT_SetEntry(70, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int70);
+	IDT_SetEntry(71, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int71);
+	IDT_SetEntry(72, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int72);
+	IDT_SetEntry(73, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int73);
+	IDT_SetEntry(74, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int74);
+	IDT_SetEntry(75, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int75);
+	IDT_SetEntry(76, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int76);
+	IDT_SetEntry(77, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int77);
+	IDT_SetEntry(78, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int78);
+	IDT_SetEntry(79, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_KERNEL | IDT_PRESENT, (uintptr_t)&int79);
+
 	//Syscall
 	IDT_SetEntry(48, 0x8, IDT_TYPE_TRAP_GATE | IDT_DPL_USER | IDT_PRESENT, (uintptr_t)&int48);
 	IDT_SetEntry(255, 0x8, IDT_TYPE_INTERRUPT | IDT_DPL_USER | IDT_PRESENT, (uintptr_t)&int255);
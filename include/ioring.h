@@ -0,0 +1,110 @@
+/*
+ * ioring.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifndef IORING_H_
+#define IORING_H_
+
+#include "stdint.h"
+
+/*
+ * Gemeinsamer Speicherbereich zwischen Prozess und Kernel für gebündelte I/O-Aufträge.
+ * Der Prozess trägt Aufträge (SQE) in die Submission-Queue ein und erhöht sq_tail, der Kernel
+ * arbeitet sie beim Syscall ioring_enter ab und trägt die Ergebnisse (CQE) in die
+ * Completion-Queue ein. Der Prozess liest die Ergebnisse ohne Syscall und erhöht cq_head.
+ * Die Indizes laufen frei und werden mit (Anzahl Einträge - 1) maskiert.
+ */
+
+#define IORING_MAX_ENTRIES	4096
+
+//Operationen
+#define IORING_OP_NOP		0
+#define IORING_OP_READ		1	//stream, offset, addr = Buffer, length
+#define IORING_OP_WRITE		2	//stream, offset, addr = Buffer, length
+#define IORING_OP_OPEN		3	//addr = Pfad, open_flags; Ergebnis ist der neue Stream
+#define IORING_OP_CLOSE		4	//stream
+#define IORING_OP_TIMEOUT	5	//length = Zeit in ms; wird nach Ablauf abgeschlossen
+
+//Modus für IORING_OP_OPEN
+#define IORING_OPEN_READ		0x01
+#define IORING_OPEN_WRITE		0x02
+#define IORING_OPEN_APPEND		0x04
+#define IORING_OPEN_EMPTY		0x08
+#define IORING_OPEN_CREATE		0x10
+#define IORING_OPEN_DIRECTORY	0x20
+
+typedef struct{
+	uint8_t opcode;
+	uint8_t open_flags;
+	uint16_t reserved[3];
+	uint64_t user_data;		//Wird unverändert in das CQE übernommen
+	uint64_t stream;
+	uint64_t offset;
+	uint64_t addr;
+	uint64_t length;
+}ioring_sqe_t;
+
+typedef struct{
+	uint64_t user_data;
+	int64_t result;			//Rückgabewert der Operation, -1 bei Fehler
+}ioring_cqe_t;
+
+typedef struct{
+	volatile uint32_t sq_head;		//Wird vom Kernel erhöht
+	volatile uint32_t sq_tail;		//Wird vom Prozess erhöht
+	volatile uint32_t cq_head;		//Wird vom Prozess erhöht
+	volatile uint32_t cq_tail;		//Wird vom Kernel erhöht
+	uint32_t entries;				//Anzahl Einträge pro Queue (Zweierpotenz)
+	uint32_t reserved[3];
+	ioring_sqe_t sqes[];			//Danach folgen die CQEs (IORING_CQES)
+}ioring_t;
+
+//Grösse des Speicherbereichs für eine Ring mit entries Einträgen
+#define IORING_SIZE(entries)	(sizeof(ioring_t) + (entries) * (sizeof(ioring_sqe_t) + sizeof(ioring_cqe_t)))
+#define IORING_CQES(ring)		((ioring_cqe_t*)&(ring)->sqes[(ring)->entries])
+//Der Kernel verwendet nur die beim Anmelden übergebene Anzahl, da der Prozess entries ändern kann
+#define IORING_CQES_N(ring, entries)	((ioring_cqe_t*)&(ring)->sqes[(entries)])
+
+#ifndef BUILD_KERNEL
+/*
+ * Gibt ein freies SQE zurück oder NULL, wenn die Submission-Queue voll ist. Der Auftrag wird erst mit
+ * ioring_submit sichtbar.
+ */
+static inline ioring_sqe_t *ioring_getSQE(ioring_t *ring, uint32_t *pending)
+{
+	uint32_t tail = ring->sq_tail + *pending;
+	if(tail - ring->sq_head >= ring->entries)
+		return 0;
+	(*pending)++;
+	return &ring->sqes[tail & (ring->entries - 1)];
+}
+
+//Macht pending Aufträge für den Kernel sichtbar
+static inline void ioring_submit(ioring_t *ring, uint32_t *pending)
+{
+	asm volatile("" : : : "memory");
+	ring->sq_tail += *pending;
+	*pending = 0;
+}
+
+//Gibt das nächste Ergebnis zurück oder NULL, wenn keines vorhanden ist
+static inline ioring_cqe_t *ioring_peekCQE(ioring_t *ring)
+{
+	if(ring->cq_head == ring->cq_tail)
+		return 0;
+	asm volatile("" : : : "memory");
+	return &IORING_CQES(ring)[ring->cq_head & (ring->entries - 1)];
+}
+
+//Gibt das zuletzt mit ioring_peekCQE gelesene Ergebnis frei
+static inline void ioring_seenCQE(ioring_t *ring)
+{
+	asm volatile("" : : : "memory");
+	ring->cq_head++;
+}
+#endif
+
+#endif /* IORING_H_ */
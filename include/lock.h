@@ -16,6 +16,40 @@
 
 typedef uint64_t lock_t;
 
+/*
+ * Ticket-Lock: Die unteren 32 Bit enthalten die Nummer des Tickets, welches gerade bedient wird,
+ * die oberen 32 Bit die Nummer des nächsten freien Tickets. Die Threads erhalten den Lock in der
+ * Reihenfolge, in der sie ihn angefordert haben.
+ * Ein wartender Thread, der unterbrochen wird, hält alle späteren Tickets auf. Deshalb darf ein
+ * Ticket-Lock nur mit ausgeschalteten Interrupts verwendet werden (spin_lock_irqsave), für alles
+ * andere gibt es lock_t.
+ */
+#define SPINLOCK_UNLOCKED	0
+
+typedef uint64_t spinlock_t;
+
+/*
+ * Reader-Writer-Lock: Die unteren Bits zählen die Leser, Bit 63 ist gesetzt, wenn ein Schreiber
+ * den Lock hält, und Bit 62, wenn ein Schreiber wartet. Solange ein Schreiber wartet, erhalten
+ * keine neuen Leser den Lock.
+ */
+#define RWLOCK_WRITER		(1ul << 63)
+#define RWLOCK_PENDING		(1ul << 62)
+
+#define RWLOCK_UNLOCKED		0
+#define RWLOCK_WRITE_LOCKED	RWLOCK_WRITER
+
+typedef uint64_t rwlock_t;
+
+/*
+ * Sequenz-Lock für oft gelesene und selten geschriebene Daten. Der Schreiber erhöht den Zähler
+ * vor und nach dem Schreiben, ein Leser wiederholt das Lesen, wenn der Zähler ungerade war oder
+ * sich verändert hat. Es darf immer nur ein Schreiber gleichzeitig schreiben.
+ */
+#define SEQLOCK_INIT		0
+
+typedef uint64_t seqlock_t;
+
 //Führt eine Funktion gelockt aus und gibt deren Resultat zurück
 #define LOCKED_RESULT(lck, task)\
 	({\
@@ -33,12 +67,70 @@ typedef uint64_t lock_t;
 		unlock(&lck);\
 	}
 
+//Führt eine Funktion mit Lesezugriff gelockt aus und gibt deren Resultat zurück
+#define RLOCKED_RESULT(lck, task)\
+	({\
+		read_lock(&lck);\
+		typeof(task) ___result = task;\
+		read_unlock(&lck);\
+		___result;\
+	})
+
+//Führt eine Funktion mit Lesezugriff gelockt aus
+#define RLOCKED_TASK(lck, task)\
+	{\
+		read_lock(&lck);\
+		task;\
+		read_unlock(&lck);\
+	}
+
+//Führt eine Funktion mit Schreibzugriff gelockt aus und gibt deren Resultat zurück
+#define WLOCKED_RESULT(lck, task)\
+	({\
+		write_lock(&lck);\
+		typeof(task) ___result = task;\
+		write_unlock(&lck);\
+		___result;\
+	})
+
+//Führt eine Funktion mit Schreibzugriff gelockt aus
+#define WLOCKED_TASK(lck, task)\
+	{\
+		write_lock(&lck);\
+		task;\
+		write_unlock(&lck);\
+	}
+
 bool try_lock(lock_t *l);
 void lock(lock_t *l);
 void unlock(lock_t *l);
 bool locked(lock_t *l);
 void lock_wait(volatile lock_t *l);
 
+bool spin_trylock(spinlock_t *l);
+void spin_lock(spinlock_t *l);
+void spin_unlock(spinlock_t *l);
+bool spin_locked(spinlock_t *l);
+
+#ifdef BUILD_KERNEL
+//Schaltet die Interrupts aus und holt den Lock. Gibt die alten RFLAGS zurück.
+uint64_t spin_lock_irqsave(spinlock_t *l);
+//Gibt den Lock frei und schaltet die Interrupts wieder ein, wenn sie vorher eingeschaltet waren
+void spin_unlock_irqrestore(spinlock_t *l, uint64_t flags);
+#endif
+
+bool try_read_lock(rwlock_t *l);
+void read_lock(rwlock_t *l);
+void read_unlock(rwlock_t *l);
+bool try_write_lock(rwlock_t *l);
+void write_lock(rwlock_t *l);
+void write_unlock(rwlock_t *l);
+
+void seq_write_begin(seqlock_t *s);
+void seq_write_end(seqlock_t *s);
+uint64_t seq_read_begin(const seqlock_t *s);
+bool seq_read_retry(const seqlock_t *s, uint64_t start);
+
 //Eine Variable atomar inkrementieren
 void locked_inc(volatile uint64_t *var);
 //Eine Variable atomar inkrementieren
@@ -0,0 +1,32 @@
+/*
+ * pmc.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifndef PMC_H_
+#define PMC_H_
+
+#include "stdint.h"
+
+/*
+ * Leistungszähler (Performance Monitoring Counter) eines Threads. Die Zähler laufen nur, während
+ * der Thread ausgeführt wird, und zählen im Userspace und im Kernel.
+ */
+
+typedef enum{
+	PMC_CYCLES,				//Prozessortakte
+	PMC_INSTRUCTIONS,		//Ausgeführte Instruktionen
+	PMC_CACHE_MISSES,		//Cache-Misses im Last-Level-Cache
+	PMC_BRANCH_MISSES,		//Falsch vorhergesagte Sprünge
+	PMC_MAX
+}pmc_event_t;
+
+typedef struct{
+	uint64_t value[PMC_MAX];
+	uint32_t valid;			//Bit n ist gesetzt, wenn value[n] von der CPU gezählt wird
+	uint32_t version;		//Version der Architectural Performance Monitoring (CPUID 0xA), 0 wenn nicht vorhanden
+}pmc_values_t;
+
+#endif /* PMC_H_ */
@@ -38,4 +38,6 @@ typedef uint64_t		uintptr_t;
 #define UINT32_MAX	UINT_MAX
 #define UINT64_MAX	ULONG_MAX
 
+#define SIZE_MAX	UINT64_MAX
+
 #endif /* STDINT_H_ */
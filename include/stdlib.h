@@ -38,6 +38,7 @@ extern long int strtol(const char *str, char **endptr, int base);
 extern void *calloc(size_t nitems, size_t size);
 extern void free(void *ptr);
 extern void *malloc(size_t size);
+extern void *aligned_alloc(size_t alignment, size_t size);
 extern void *realloc(void *ptr, size_t size);
 
 extern void abort(void) __attribute__((noreturn));
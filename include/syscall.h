@@ -13,11 +13,23 @@
 #include "stddef.h"
 #include "stdint.h"
 #include "stdbool.h"
+#include "ioring.h"
+#include "pmc.h"
 
 typedef struct{
 	bool read, write, append, empty, create, directory;
 }vfs_mode_t;
 
+//Flags für syscall_mmap
+#define VFS_MMAP_SHARED		0x0		//Abbildung ist nur lesbar und sieht Änderungen an der Datei
+#define VFS_MMAP_PRIVATE	0x1		//Schreibzugriffe gehen auf eine private Kopie
+
+//Puffersegment für syscall_freadv/syscall_fwritev
+typedef struct{
+	void *base;
+	size_t length;
+}vfs_iovec_t;
+
 typedef enum{
 	VFS_INFO_FILESIZE, VFS_INFO_BLOCKSIZE, VFS_INFO_USEDBLOCKS, VFS_INFO_CREATETIME, VFS_INFO_ACCESSTIME, VFS_INFO_CHANGETIME
 }vfs_fileinfo_t;
@@ -38,17 +50,27 @@ typedef uint64_t tid_t;
 inline void *AllocPage(size_t Pages);
 inline void FreePage(void *Address, size_t Pages);
 inline void syscall_unusePage(void *Address, size_t Pages);
+inline void *syscall_mmap(void *stream, uint64_t offset, size_t length, uint64_t flags);
+inline int syscall_munmap(void *address);
 
 inline pid_t syscall_createProcess(const char *path, const char *cmd, const char *stdin, const char *stdout, const char *stderr);
 inline void syscall_exit(int status);
 inline tid_t syscall_createThread(void *entry);
 inline void syscall_exitThread(int status);
+inline int syscall_futexWait(uint32_t *address, uint32_t value);
+inline uint64_t syscall_futexWake(uint32_t *address, uint64_t count);
+inline int syscall_pmcRead(pmc_values_t *values);
 
 inline void *syscall_fopen(char *path, vfs_mode_t mode);
 inline void syscall_fclose(void *stream);
 inline size_t syscall_fread(void *stream, uint64_t start, size_t length, const void *buffer);
 inline size_t syscall_fwrite(void *stream, uint64_t start, size_t length, const void *buffer);
 inline uint64_t syscall_StreamInfo(void *stream, vfs_fileinfo_t info);
+inline size_t syscall_freadv(void *stream, uint64_t start, const vfs_iovec_t *iov, size_t count);
+inline size_t syscall_fwritev(void *stream, uint64_t start, const vfs_iovec_t *iov, size_t count);
+inline size_t syscall_fsplice(void *dst, uint64_t dst_start, void *src, uint64_t src_start, size_t length);
+inline int syscall_ioringSetup(ioring_t *ring, uint32_t entries);
+inline int64_t syscall_ioringEnter(uint32_t min_complete);
 
 inline void syscall_sleep(uint64_t msec);
 
@@ -0,0 +1,50 @@
+/*
+ * threads.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifndef BUILD_KERNEL
+
+#ifndef THREADS_H_
+#define THREADS_H_
+
+#include "stdint.h"
+
+enum{
+	thrd_success, thrd_busy, thrd_error, thrd_nomem, thrd_timedout
+};
+
+enum{
+	mtx_plain = 1, mtx_recursive = 2, mtx_timed = 4
+};
+
+/*
+ * Mutex: 0 = frei, 1 = gesperrt, 2 = gesperrt und es warten Threads.
+ * Solange niemand warten muss, wird kein Syscall ausgeführt.
+ */
+typedef struct{
+	volatile uint32_t state;
+}mtx_t;
+
+//Bedingungsvariable: Zähler, der bei jedem Signal erhöht wird
+typedef struct{
+	volatile uint32_t seq;
+}cnd_t;
+
+int mtx_init(mtx_t *mtx, int type);
+int mtx_lock(mtx_t *mtx);
+int mtx_trylock(mtx_t *mtx);
+int mtx_unlock(mtx_t *mtx);
+void mtx_destroy(mtx_t *mtx);
+
+int cnd_init(cnd_t *cond);
+int cnd_signal(cnd_t *cond);
+int cnd_broadcast(cnd_t *cond);
+int cnd_wait(cnd_t *cond, mtx_t *mtx);
+void cnd_destroy(cnd_t *cond);
+
+#endif /* THREADS_H_ */
+
+#endif
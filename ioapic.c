@@ -0,0 +1,271 @@
+/*
+ * ioapic.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "ioapic.h"
+#include "acpi.h"
+#include "apic.h"
+#include "pic.h"
+#include "isr.h"
+#include "lock.h"
+#include "memory.h"
+#include "vmm.h"
+#include "stdlib.h"
+#include "display.h"
+#include "stdio.h"
+
+#define IOAPIC_MAX			8
+
+//Register
+#define IOAPIC_REGSEL		0x00
+#define IOAPIC_WIN			(0x10 / sizeof(uint32_t))
+#define IOAPIC_REG_VERSION	0x01
+#define IOAPIC_REG_REDTBL	0x10	//Zwei Register pro Eintrag
+
+//Bits in der unteren Hälfte eines Redirection-Eintrags
+#define REDIR_ACTIVE_LOW	(1 << 13)
+#define REDIR_LEVEL			(1 << 15)
+#define REDIR_MASKED		(1 << 16)
+
+//Einträge der MADT
+#define MADT_IOAPIC			1
+#define MADT_OVERRIDE		2
+
+//Flags eines Interrupt Source Overrides
+#define INTI_POLARITY_MASK	0x3
+#define INTI_POLARITY_HIGH	0x1
+#define INTI_POLARITY_LOW	0x3
+#define INTI_TRIGGER_MASK	(0x3 << 2)
+#define INTI_TRIGGER_EDGE	(0x1 << 2)
+#define INTI_TRIGGER_LEVEL	(0x3 << 2)
+
+//Diese IRQs sind fest mit ISA-Geräten verbunden (Timer, Tastatur, Kaskade, RTC, FPU) und können nicht von PCI verwendet werden
+#define ISA_FIXED_IRQS		((1 << 0) | (1 << 1) | (1 << 2) | (1 << 8) | (1 << 13))
+
+typedef struct{
+		acpi_header_t Header;
+		uint32_t LocalApicAddress;
+		uint32_t Flags;
+}__attribute__((packed)) madt_t;
+
+typedef struct{
+		uint8_t Type;
+		uint8_t Length;
+		uint8_t ID;
+		uint8_t reserved;
+		uint32_t Address;
+		uint32_t GSIBase;
+}__attribute__((packed)) madt_ioapic_t;
+
+typedef struct{
+		uint8_t Type;
+		uint8_t Length;
+		uint8_t Bus;
+		uint8_t Source;
+		uint32_t GSI;
+		uint16_t Flags;
+}__attribute__((packed)) madt_override_t;
+
+typedef struct{
+		volatile uint32_t *regs;
+		uint32_t gsiBase;
+		uint8_t pins;
+}ioapic_t;
+
+static ioapic_t ioapics[IOAPIC_MAX];
+static size_t numIOAPICs = 0;
+static bool active = false;
+static spinlock_t ioapic_lock = SPINLOCK_UNLOCKED;
+
+//Global System Interrupt und Flags der ISA-IRQs
+static struct{
+		uint32_t gsi;
+		uint16_t flags;
+}irqRoute[NUM_IRQ];
+
+static uint32_t readReg(ioapic_t *ioapic, uint8_t reg)
+{
+	ioapic->regs[IOAPIC_REGSEL] = reg;
+	return ioapic->regs[IOAPIC_WIN];
+}
+
+static void writeReg(ioapic_t *ioapic, uint8_t reg, uint32_t value)
+{
+	ioapic->regs[IOAPIC_REGSEL] = reg;
+	ioapic->regs[IOAPIC_WIN] = value;
+}
+
+static void addIOAPIC(madt_ioapic_t *entry)
+{
+	ioapic_t *ioapic;
+
+	if(numIOAPICs >= IOAPIC_MAX)
+		return;
+	ioapic = &ioapics[numIOAPICs];
+
+	ioapic->regs = getFreePages((void*)KERNELSPACE_START, (void*)KERNELSPACE_END, 1);
+	if(ioapic->regs == NULL)
+		return;
+	vmm_Map((void*)ioapic->regs, entry->Address, VMM_FLAGS_GLOBAL | VMM_FLAGS_NX | VMM_FLAGS_WRITE | VMM_FLAGS_NO_CACHE, 0);
+	ioapic->gsiBase = entry->GSIBase;
+	ioapic->pins = ((readReg(ioapic, IOAPIC_REG_VERSION) >> 16) & 0xFF) + 1;
+	numIOAPICs++;
+}
+
+/*
+ * Sucht den I/O APIC, an dem ein Global System Interrupt hängt
+ */
+static ioapic_t *findIOAPIC(uint32_t gsi, uint8_t *pin)
+{
+	size_t i;
+	for(i = 0; i < numIOAPICs; i++)
+	{
+		if(gsi >= ioapics[i].gsiBase && gsi < ioapics[i].gsiBase + ioapics[i].pins)
+		{
+			*pin = gsi - ioapics[i].gsiBase;
+			return &ioapics[i];
+		}
+	}
+	return NULL;
+}
+
+static void setRedirection(ioapic_t *ioapic, uint8_t pin, uint32_t low, uint8_t apic)
+{
+	//Zuerst maskieren, damit kein halb geschriebener Eintrag benutzt wird
+	writeReg(ioapic, IOAPIC_REG_REDTBL + pin * 2, REDIR_MASKED);
+	writeReg(ioapic, IOAPIC_REG_REDTBL + pin * 2 + 1, (uint32_t)apic << 24);
+	writeReg(ioapic, IOAPIC_REG_REDTBL + pin * 2, low);
+}
+
+bool ioapic_Init(void)
+{
+	madt_t *madt;
+	uint8_t *entry, *end;
+	size_t i;
+	uint8_t pin, apic;
+
+	if(!apic_available() || (madt = (madt_t*)acpi_findTable("APIC")) == NULL)
+		return false;
+
+	//ISA-IRQs sind ohne Override flankengesteuert, active high und 1:1 verbunden
+	for(i = 0; i < NUM_IRQ; i++)
+	{
+		irqRoute[i].gsi = i;
+		irqRoute[i].flags = 0;
+	}
+
+	end = (uint8_t*)madt + madt->Header.Length;
+	for(entry = (uint8_t*)(madt + 1); entry + 2 <= end && entry[1] >= 2 && entry + entry[1] <= end; entry += entry[1])
+	{
+		switch(entry[0])
+		{
+			case MADT_IOAPIC:
+				addIOAPIC((madt_ioapic_t*)entry);
+			break;
+			case MADT_OVERRIDE:
+			{
+				madt_override_t *override = (madt_override_t*)entry;
+				if(override->Bus == 0 && override->Source < NUM_IRQ)
+				{
+					irqRoute[override->Source].gsi = override->GSI;
+					irqRoute[override->Source].flags = override->Flags;
+				}
+			}
+			break;
+		}
+	}
+	free(madt);
+
+	if(numIOAPICs == 0)
+	{
+		SysLogError("IOAPIC", "Kein I/O APIC gefunden");
+		return false;
+	}
+
+	//Alle Eingänge maskieren, nur die ISA-IRQs werden benutzt
+	for(i = 0; i < numIOAPICs; i++)
+		for(pin = 0; pin < ioapics[i].pins; pin++)
+			writeReg(&ioapics[i], IOAPIC_REG_REDTBL + pin * 2, REDIR_MASKED);
+
+	apic = apic_getID();
+	for(i = 0; i < NUM_IRQ; i++)
+	{
+		ioapic_t *ioapic;
+		uint32_t low = 32 + i;
+
+		//IRQ 2 ist die Kaskade des PICs, GSI 2 ist normalerweise der Timer
+		if(i == 2 || (ioapic = findIOAPIC(irqRoute[i].gsi, &pin)) == NULL)
+			continue;
+
+		if((irqRoute[i].flags & INTI_POLARITY_LOW) == INTI_POLARITY_LOW)
+			low |= REDIR_ACTIVE_LOW;
+		if((irqRoute[i].flags & INTI_TRIGGER_LEVEL) == INTI_TRIGGER_LEVEL)
+			low |= REDIR_LEVEL;
+		setRedirection(ioapic, pin, low, apic);
+	}
+
+	//Ab jetzt kommen die IRQs nur noch über den I/O APIC
+	pic_MaskIRQ(0xFFFF);
+	active = true;
+
+	SysLog("IOAPIC", "Initialisierung abgeschlossen");
+	return true;
+}
+
+bool ioapic_setPCIIRQ(uint8_t irq)
+{
+	ioapic_t *ioapic;
+	uint8_t pin;
+	uint64_t flags;
+	uint32_t low;
+
+	if(!active)
+		return true;
+
+	if(irq >= NUM_IRQ || (ISA_FIXED_IRQS & (1 << irq)) || (ioapic = findIOAPIC(irqRoute[irq].gsi, &pin)) == NULL)
+	{
+		char msg[64];
+		sprintf(msg, "IRQ %u eines PCI-Geraets kann nicht verwendet werden", irq);
+		SysLogError("IOAPIC", msg);
+		return false;
+	}
+
+	//PCI-Interrupts sind pegelgesteuert und active low, wenn kein Override etwas anderes angibt
+	low = 32 + irq;
+	if((irqRoute[irq].flags & INTI_POLARITY_MASK) != INTI_POLARITY_HIGH)
+		low |= REDIR_ACTIVE_LOW;
+	if((irqRoute[irq].flags & INTI_TRIGGER_MASK) != INTI_TRIGGER_EDGE)
+		low |= REDIR_LEVEL;
+
+	flags = spin_lock_irqsave(&ioapic_lock);
+	setRedirection(ioapic, pin, low, readReg(ioapic, IOAPIC_REG_REDTBL + pin * 2 + 1) >> 24);
+	spin_unlock_irqrestore(&ioapic_lock, flags);
+
+	return true;
+}
+
+bool ioapic_available(void)
+{
+	return active;
+}
+
+void ioapic_setDestination(uint8_t irq, uint8_t apic)
+{
+	ioapic_t *ioapic;
+	uint8_t pin;
+	uint64_t flags;
+
+	if(!active || irq >= NUM_IRQ || (ioapic = findIOAPIC(irqRoute[irq].gsi, &pin)) == NULL)
+		return;
+
+	flags = spin_lock_irqsave(&ioapic_lock);
+	writeReg(ioapic, IOAPIC_REG_REDTBL + pin * 2 + 1, (uint32_t)apic << 24);
+	spin_unlock_irqrestore(&ioapic_lock, flags);
+}
+
+#endif
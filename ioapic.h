@@ -0,0 +1,44 @@
+/*
+ * ioapic.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef IOAPIC_H_
+#define IOAPIC_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+
+/*
+ * Sucht die I/O APICs in der MADT und leitet die ISA-IRQs darüber an den Local APIC weiter.
+ * Der PIC wird danach maskiert.
+ * Rückgabe:	true, wenn die IRQs jetzt über den I/O APIC laufen
+ */
+bool ioapic_Init(void);
+
+/*
+ * Stellt einen IRQ, den ein PCI-Gerät benutzt, auf pegelgesteuert und active low um (ausser
+ * ein Interrupt Source Override legt etwas anderes fest)
+ * Parameter:	irq = IRQ aus dem Interrupt-Line-Register
+ * Rückgabe:	false, wenn der IRQ nicht für PCI benutzt werden kann. Das Gerät bekommt dann keine
+ * 				Interrupts über diesen IRQ.
+ */
+bool ioapic_setPCIIRQ(uint8_t irq);
+
+//true, wenn die IRQs über den I/O APIC laufen und der EOI an den Local APIC gehen muss
+bool ioapic_available(void);
+
+/*
+ * Legt fest, an welche CPU ein IRQ geschickt wird
+ * Parameter:	irq = ISA-IRQ
+ * 				apic = ID des Local APICs der Ziel-CPU
+ */
+void ioapic_setDestination(uint8_t irq, uint8_t apic);
+
+#endif /* IOAPIC_H_ */
+
+#endif
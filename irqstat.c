@@ -0,0 +1,136 @@
+/*
+ * irqstat.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "irqstat.h"
+#include "isr.h"
+#include "cpu.h"
+#include "lock.h"
+#include "vfs.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define IRQSTAT_BUCKETS		40		//Histogramm von 2^0 bis 2^39 TSC-Ticks, der letzte Eintrag zählt alles darüber
+
+typedef struct{
+	uint64_t count;
+	uint64_t spurious;
+	uint64_t timed;					//Anzahl Interrupts, deren Laufzeit gemessen wurde
+	uint64_t cycles;				//Gesamte Laufzeit in TSC-Ticks
+	uint64_t max;
+	uint64_t histogram[IRQSTAT_BUCKETS];
+}irqstat_t;
+
+static irqstat_t irqstat_table[NUM_INTERRUPTS];
+static spinlock_t irqstat_lock = SPINLOCK_UNLOCKED;
+
+uint64_t irqstat_enter(void)
+{
+	return cpu_rdtsc();
+}
+
+void irqstat_leave(uint8_t vector, uint64_t start)
+{
+	irqstat_t *entry = &irqstat_table[vector];
+	uint64_t cycles = start ? cpu_rdtsc() - start : 0;
+	uint64_t flags = spin_lock_irqsave(&irqstat_lock);
+
+	entry->count++;
+	if(start)
+	{
+		size_t bucket = cycles ? 63 - __builtin_clzl(cycles) : 0;
+		if(bucket >= IRQSTAT_BUCKETS)
+			bucket = IRQSTAT_BUCKETS - 1;
+		entry->histogram[bucket]++;
+		entry->timed++;
+		entry->cycles += cycles;
+		if(cycles > entry->max)
+			entry->max = cycles;
+	}
+
+	spin_unlock_irqrestore(&irqstat_lock, flags);
+}
+
+void irqstat_spurious(uint8_t vector)
+{
+	uint64_t flags = spin_lock_irqsave(&irqstat_lock);
+	irqstat_table[vector].spurious++;
+	spin_unlock_irqrestore(&irqstat_lock, flags);
+}
+
+/*
+ * Gibt für jeden benutzten Vektor eine Zeile mit den Zählern und eine mit dem Histogramm aus
+ */
+static size_t irqstat_read(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	irqstat_t entry;
+	size_t active = 0, size, i, j;
+	uint64_t flags;
+	char *text;
+
+	for(i = 0; i < NUM_INTERRUPTS; i++)
+	{
+		if(irqstat_table[i].count || irqstat_table[i].spurious)
+			active++;
+	}
+
+	//Eine Zeile mit den Zählern ist höchstens 100 Zeichen lang, jeder Eintrag im Histogramm höchstens 28
+	text = malloc(100 + active * (100 + IRQSTAT_BUCKETS * 28));
+	if(text == NULL)
+		return 0;
+
+	size = sprintf(text, "%-6s %-5s %20s %20s %20s %20s\n", "vector", "irq", "count", "spurious", "avg (tsc)", "max (tsc)");
+	for(i = 0; i < NUM_INTERRUPTS && active > 0; i++)
+	{
+		flags = spin_lock_irqsave(&irqstat_lock);
+		entry = irqstat_table[i];
+		spin_unlock_irqrestore(&irqstat_lock, flags);
+
+		if(entry.count == 0 && entry.spurious == 0)
+			continue;
+		active--;
+
+		size += sprintf(text + size, "%-6lu ", i);
+		if(i >= 32 && i < 32 + NUM_IRQ)
+			size += sprintf(text + size, "%-5lu ", i - 32);
+		else if(i >= MSI_VECTOR_BASE && i < MSI_VECTOR_BASE + NUM_MSI)
+			size += sprintf(text + size, "%-5lu ", NUM_IRQ + i - MSI_VECTOR_BASE);
+		else
+			size += sprintf(text + size, "%-5s ", "-");
+		size += sprintf(text + size, "%20lu %20lu %20lu %20lu\n", entry.count, entry.spurious,
+				entry.timed ? entry.cycles / entry.timed : 0, entry.max);
+
+		if(entry.timed)
+		{
+			size += sprintf(text + size, "       ");
+			for(j = 0; j < IRQSTAT_BUCKETS; j++)
+			{
+				if(entry.histogram[j])
+					size += sprintf(text + size, " 2^%lu: %lu", j, entry.histogram[j]);
+			}
+			size += sprintf(text + size, "\n");
+		}
+	}
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	free(text);
+	return read;
+}
+
+void irqstat_Init(void)
+{
+	vfs_RegisterInfoFile("interrupts", irqstat_read, NULL);
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * irqstat.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef IRQSTAT_H_
+#define IRQSTAT_H_
+
+#include "stdint.h"
+
+/*
+ * Statistik über die Interrupts: Anzahl, falsche (spurious) Interrupts und Laufzeit der Handler
+ * in TSC-Ticks mit einem Histogramm (Zweierpotenzen) pro Interruptvektor.
+ * Die Statistik ist unter /sysinf/interrupts abrufbar.
+ */
+
+void irqstat_Init(void);
+
+//Gibt den Zeitstempel für den Anfang eines Handlers zurück
+uint64_t irqstat_enter(void);
+
+/*
+ * Zählt einen behandelten Interrupt
+ * Parameter:	vector = Interruptvektor
+ * 				start = Rückgabewert von irqstat_enter oder 0, wenn die Laufzeit nicht gezählt werden soll
+ */
+void irqstat_leave(uint8_t vector, uint64_t start);
+
+//Zählt einen falschen Interrupt, für den es keinen Auslöser gibt
+void irqstat_spurious(uint8_t vector);
+
+#endif /* IRQSTAT_H_ */
+
+#endif
@@ -12,8 +12,15 @@
 #include "display.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "stdbool.h"
 #include "util.h"
 #include "pic.h"
+#include "apic.h"
+#include "ioapic.h"
+#include "irqstat.h"
+#include "softirq.h"
+#include "trace.h"
+#include "profile.h"
 #include "debug.h"
 #include "pit.h"
 #include "vmm.h"
@@ -21,6 +28,8 @@
 #include "thread.h"
 #include "cpu.h"
 #include "console.h"
+#include "vfs.h"
+#include "memory.h"
 
 typedef struct{
 		void (*Handler)(ihs_t *ihs);
@@ -39,6 +48,7 @@ extern void cdi_irq_handler(uint8_t irq);
 extern void pit_Handler(void);
 
 static ihs_t *irq_handler(ihs_t *ihs);
+static ihs_t *msi_handler(ihs_t *ihs);
 static ihs_t *exception_DivideByZero(ihs_t *ihs);
 static ihs_t *exception_Debug(ihs_t *ihs);
 static ihs_t *exception_NonMaskableInterrupt(ihs_t *ihs);
@@ -86,6 +96,7 @@ static interrupt_handler interrupt_handlers[NUM_INTERRUPTS] = {
 /*18*/			exception_MachineCheck,
 /*19*/			exception_XF,
 [32 ... 47]		irq_handler,
+[MSI_VECTOR_BASE ... MSI_VECTOR_BASE + NUM_MSI - 1]	msi_handler,
 [48]			syscall_Handler,
 [255]			pm_Schedule
 };
@@ -129,25 +140,44 @@ interrupt_handler isr_setHandler(uint8_t num, interrupt_handler handler)
 
 ihs_t *isr_Handler(ihs_t *ihs)
 {
+	uint8_t vector = ihs->interrupt;
+	//Syscalls und Taskwechsel können warten, deshalb wird deren Laufzeit nicht gemessen
+	uint64_t start = (vector == 48 || vector == 255) ? 0 : irqstat_enter();
+	ihs_t *new_ihs;
+
 	Counter++;
-	return interrupt_handlers[ihs->interrupt](ihs);
+	new_ihs = interrupt_handlers[vector](ihs);
+	irqstat_leave(vector, start);
+	return new_ihs;
 }
 
 static ihs_t *irq_handler(ihs_t *ihs)
 {
 	ihs_t *new_ihs = ihs;
+	bool schedule = false;
 
 	uint8_t irq = ihs->interrupt - 32;
+
+	//Der PIC löst bei Störungen IRQ 7 bzw. 15 aus, ohne dass ein Gerät einen IRQ angefordert hat
+	if(!ioapic_available() && pic_isSpurious(irq))
+	{
+		irqstat_spurious(ihs->interrupt);
+		return ihs;
+	}
+
+	softirq_irqEnter();
 	switch(ihs->interrupt)
 	{
 		case 32:
 		{
 			static uint64_t nextSchedule = 50;
 			pit_Handler();
-			if(Uptime == nextSchedule)
+			profile_tick(ihs);
+			//Während Softirqs laufen, wird der Taskwechsel auf den nächsten Tick verschoben
+			if(Uptime >= nextSchedule && !softirq_active())
 			{
-				new_ihs = pm_Schedule(ihs);
-				nextSchedule += 50;				//Alle 50ms wird der Task gewechselt
+				schedule = true;
+				nextSchedule = Uptime + 50;		//Alle 50ms wird der Task gewechselt
 			}
 		}
 		break;
@@ -157,11 +187,30 @@ static ihs_t *irq_handler(ihs_t *ihs)
 	}
 
 	cdi_irq_handler(irq);
-	pic_SendEOI(irq);		//PIC sagen, dass IRQ behandelt wurde
+	//PIC bzw. APIC sagen, dass IRQ behandelt wurde
+	if(ioapic_available())
+		apic_EOI();
+	else
+		pic_SendEOI(irq);
+
+	softirq_irqExit(ihs);
+	if(schedule)
+		new_ihs = pm_Schedule(ihs);
 
 	return new_ihs;
 }
 
+//MSIs werden direkt an den Local APIC geschickt, deshalb geht der EOI auch an diesen
+static ihs_t *msi_handler(ihs_t *ihs)
+{
+	softirq_irqEnter();
+	cdi_irq_handler(NUM_IRQ + ihs->interrupt - MSI_VECTOR_BASE);
+	apic_EOI();
+	softirq_irqExit(ihs);
+
+	return ihs;
+}
+
 //Divide by Zero
 static ihs_t *exception_DivideByZero(ihs_t *ihs)
 {
@@ -214,7 +263,6 @@ static ihs_t *exception_InvalidOpcode(ihs_t *ihs)
 //Device not available
 static ihs_t *exception_DeviceNotAvailable(ihs_t *ihs)
 {
-	//XXX: Because malloc does not align to 16-byte boundary we have to do it manually
 	//Reset TS-Flag
 	asm volatile("clts");
 
@@ -222,20 +270,12 @@ static ihs_t *exception_DeviceNotAvailable(ihs_t *ihs)
 	{
 		//Speichere aktuellen FPU Status, wenn ein Prozess gelaufen ist
 		if(fpuThread != NULL)
-			asm volatile("fxsave (%0)": :"r"((((uintptr_t)fpuThread->fpuState) + 15) & ~0xF));
+			asm volatile("fxsave (%0)": :"r"(fpuThread->fpuState));
 
 		fpuThread = currentThread;
 
-		//FPU Status laden
-		if(fpuThread->fpuState == NULL)
-		{
-			//Speicher reservieren, um Status speichern zu können
-			fpuThread->fpuState = malloc(512 + 16);
-		}
-		else
-		{
-			asm volatile("fxrstor (%0)": :"r"((((uintptr_t)fpuThread->fpuState) + 15) & ~0xF));
-		}
+		//FPU Status laden. Der Speicher dafür wird in thread_create reserviert.
+		asm volatile("fxrstor (%0)": :"r"(fpuThread->fpuState));
 	}
 	return ihs;
 }
@@ -306,6 +346,7 @@ static ihs_t *exception_PageFault(ihs_t *ihs)
 
 	uint64_t CR2;
 	asm volatile("mov %%cr2,%0" : "=r"(CR2));
+	TRACE(TRACE_PAGEFAULT, CR2, ihs->error);
 
 	//Einträge in die Page Tabellen
 	uint16_t PML4i = (CR2 & PG_PML4_INDEX) >> 39;
@@ -317,6 +358,18 @@ static ihs_t *exception_PageFault(ihs_t *ihs)
 	PD = (void*)PD + ((PML4i << 21) | (PDPi << 12));
 	PT = (void*)PT + (((uint64_t)PML4i << 30) | (PDPi << 21) | (PDi << 12));
 
+	//Pages von gemappten Dateien werden aus dem Page-Cache eingeblendet. Ausführen ist dort nicht erlaubt.
+	//Das Laden der Page kann blockieren, deshalb nur, wenn der unterbrochene Code blockieren durfte.
+	if(CR2 >= USERSPACE_START && CR2 <= USERSPACE_END && currentProcess != NULL && !(ihs->error & 0x10)
+			&& ((ihs->cs & 3) == 3 || (ihs->rflags & 0x200)))
+	{
+		asm volatile("sti");
+		bool handled = vfs_HandlePageFault((void*)CR2, ihs->error & 0x2);
+		asm volatile("cli");
+		if(handled)
+			return ihs;
+	}
+
 	//Wenn diese Page eine unused page ist, dann wird diese aktiviert
 	if(!vmm_getPageStatus((void*)CR2) && (PG_AVL(PT->PTE[PTi]) & VMM_UNUSED_PAGE))
 	{
@@ -382,6 +435,8 @@ static ihs_t *exception_XF(ihs_t *ihs)
 //Nop handler
 static ihs_t *nop(ihs_t *ihs)
 {
+	//Für diesen Vektor gibt es keinen Handler
+	irqstat_spurious(ihs->interrupt);
 	asm volatile("nop");
 	return ihs;
 }
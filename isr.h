@@ -13,6 +13,8 @@
 #include "stdint.h"
 
 #define NUM_IRQ	16
+#define NUM_MSI	16			//IRQs NUM_IRQ bis NUM_IRQ + NUM_MSI - 1 werden per MSI ausgelöst
+#define MSI_VECTOR_BASE	64	//Interrupt des ersten MSI-IRQs
 #define NUM_INTERRUPTS 256
 
 typedef struct{
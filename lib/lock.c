@@ -6,31 +6,185 @@
  */
 
 #include "lock.h"
+#ifdef BUILD_KERNEL
+#include "config.h"
+#endif
+
+#if defined(BUILD_KERNEL) && defined(LOCK_PROFILING)
+#include "lockstat.h"
+#define LOCKSTAT_ACQUIRED(l, contended, spins)	lockstat_acquired(l, contended, spins)
+#define LOCKSTAT_RELEASED(l)					lockstat_released(l)
+#else
+#define LOCKSTAT_ACQUIRED(l, contended, spins)	((void)(contended), (void)(spins))
+#define LOCKSTAT_RELEASED(l)
+#endif
+
+#define TICKET_MASK		0xFFFFFFFFul
+#define TICKET_NEXT		(1ul << 32)
 
 bool try_lock(lock_t *l)
 {
-	return __sync_bool_compare_and_swap(l, 0, 1);
+	if(!__sync_bool_compare_and_swap(l, 0, 1))
+		return false;
+	LOCKSTAT_ACQUIRED(l, false, 0);
+	return true;
 }
 
 void lock(lock_t *l)
 {
-	while(!try_lock(l))
-		asm volatile("pause");
+	uint64_t spins = 0;
+	bool contended = false;
+	while(!__sync_bool_compare_and_swap(l, 0, 1))
+	{
+		contended = true;
+		//Nur lesend warten, bis der Lock frei ist, damit die Cacheline nicht ständig hin und her wandert
+		while(*(volatile lock_t*)l)
+		{
+			asm volatile("pause");
+			spins++;
+		}
+	}
+	LOCKSTAT_ACQUIRED(l, contended, spins);
 }
 
 void unlock(lock_t *l)
 {
-	*l = 0;
+	LOCKSTAT_RELEASED(l);
+	asm volatile("" : : : "memory");
+	*(volatile lock_t*)l = 0;
 }
 
 bool locked(lock_t *l)
 {
-	return *l;
+	return *(volatile lock_t*)l;
 }
 
 void lock_wait(volatile lock_t *l)
 {
-	while(*l);
+	while(*l)
+		asm volatile("pause");
+}
+
+bool spin_trylock(spinlock_t *l)
+{
+	spinlock_t old = *(volatile spinlock_t*)l;
+	//Nur wenn niemand den Lock hält oder darauf wartet ein Ticket ziehen
+	if((old & TICKET_MASK) != (old >> 32))
+		return false;
+	return __sync_bool_compare_and_swap(l, old, old + TICKET_NEXT);
+}
+
+void spin_lock(spinlock_t *l)
+{
+	//Ticket ziehen und warten bis es an der Reihe ist
+	uint32_t ticket = __sync_fetch_and_add(l, TICKET_NEXT) >> 32;
+	while((uint32_t)*(volatile spinlock_t*)l != ticket)
+		asm volatile("pause");
+}
+
+void spin_unlock(spinlock_t *l)
+{
+	//Nur der Besitzer verändert das aktuelle Ticket, deshalb reicht ein einfaches Schreiben
+	volatile uint32_t *owner = (volatile uint32_t*)l;
+	asm volatile("" : : : "memory");
+	*owner = *owner + 1;
+}
+
+bool spin_locked(spinlock_t *l)
+{
+	spinlock_t val = *(volatile spinlock_t*)l;
+	return (val & TICKET_MASK) != (val >> 32);
+}
+
+#ifdef BUILD_KERNEL
+uint64_t spin_lock_irqsave(spinlock_t *l)
+{
+	uint64_t flags;
+	asm volatile("pushfq; popq %0; cli" : "=r"(flags) : : "memory");
+	spin_lock(l);
+	return flags;
+}
+
+void spin_unlock_irqrestore(spinlock_t *l, uint64_t flags)
+{
+	spin_unlock(l);
+	//IF = Bit 9
+	if(flags & 0x200)
+		asm volatile("sti" : : : "memory");
+}
+#endif
+
+bool try_read_lock(rwlock_t *l)
+{
+	rwlock_t old = *(volatile rwlock_t*)l;
+	if(old & (RWLOCK_WRITER | RWLOCK_PENDING))
+		return false;
+	return __sync_bool_compare_and_swap(l, old, old + 1);
+}
+
+void read_lock(rwlock_t *l)
+{
+	while(!try_read_lock(l))
+		asm volatile("pause");
+}
+
+void read_unlock(rwlock_t *l)
+{
+	__sync_fetch_and_sub(l, 1);
+}
+
+bool try_write_lock(rwlock_t *l)
+{
+	rwlock_t old = *(volatile rwlock_t*)l;
+	if(old & ~RWLOCK_PENDING)
+		return false;
+	return __sync_bool_compare_and_swap(l, old, RWLOCK_WRITER);
+}
+
+void write_lock(rwlock_t *l)
+{
+	while(!try_write_lock(l))
+	{
+		//Neue Leser fernhalten, damit der Schreiber nicht verhungert
+		rwlock_t old = *(volatile rwlock_t*)l;
+		if(!(old & RWLOCK_PENDING))
+			__sync_bool_compare_and_swap(l, old, old | RWLOCK_PENDING);
+		asm volatile("pause");
+	}
+}
+
+void write_unlock(rwlock_t *l)
+{
+	//Das Pending-Bit bleibt erhalten, falls inzwischen ein anderer Schreiber wartet
+	__sync_fetch_and_and(l, ~RWLOCK_WRITER);
+}
+
+void seq_write_begin(seqlock_t *s)
+{
+	*(volatile seqlock_t*)s = *s + 1;
+	asm volatile("" : : : "memory");
+}
+
+void seq_write_end(seqlock_t *s)
+{
+	asm volatile("" : : : "memory");
+	*(volatile seqlock_t*)s = *s + 1;
+}
+
+uint64_t seq_read_begin(const seqlock_t *s)
+{
+	uint64_t seq;
+	//Warten, solange gerade geschrieben wird
+	while((seq = *(const volatile seqlock_t*)s) & 1)
+		asm volatile("pause");
+	asm volatile("" : : : "memory");
+	return seq;
+}
+
+bool seq_read_retry(const seqlock_t *s, uint64_t start)
+{
+	asm volatile("" : : : "memory");
+	return *(const volatile seqlock_t*)s != start;
 }
 
 //Eine Variable atomar inkrementieren
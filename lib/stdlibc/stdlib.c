@@ -11,44 +11,70 @@
 #include "string.h"
 #include "ctype.h"
 #include "math.h"
+#include "lock.h"
 #ifdef BUILD_KERNEL
 #include "mm.h"
 #include "cpu.h"
 #include "vmm.h"
+#include "lockstat.h"
 #else
 #include "syscall.h"
 #endif
 
 #define HEAP_RESERVED	0x01
+#define HEAP_LARGE		0x100		//Block hat einen eigenen Pagebereich
+#define HEAP_ALIGNED	0x200		//Header verweist auf den Anfang des eigentlichen Blocks
 #define HEAP_FLAGS		0xAA
 
-#define MAX(a, b) ((a > b) ? a : b)
+#define HEAP_ALIGN			16
+#define HEAP_PAGE_SIZE		4096
+#define HEAP_NUM_CLASSES	24
+#define HEAP_MAX_SMALL		2048
+#define HEAP_SLAB_BLOCKS	32		//Mindestanzahl Blöcke pro Slab
+#define HEAP_ARENA_PAGES	256		//Anzahl Pages, um die der Heap auf einmal wächst
+
+#ifndef BUILD_KERNEL
+#define HEAP_CACHE_SLOTS	64
+#define HEAP_CACHE_BATCH	16		//Anzahl Blöcke, die auf einmal zwischen Cache und Arena verschoben werden
+#define HEAP_CACHE_MAX		64		//Maximale Anzahl Blöcke pro Klasse in einem Cache
+#define HEAP_STACK_TOP		0xFFFFFF8000000000	//Oberes Ende des Stacks des ersten Threads
+#define HEAP_STACK_STRIDE	8192	//Abstand der Threadstacks (Stack und Guardpage)
+#endif
 
 typedef struct{
-		void *Prev;
-		void *Next;
-		size_t Length;
-		uint8_t Flags;		//Bit 0: Reserviert (1) oder Frei (0)
-							//(Flags): Alle ungeraden Bits 1 und alle geraden 0
-		int8_t balance;		//Höhe rechts - Höhe links
-		bool is_list_mbr;		//Gibt an, dass der Knoten eindeutig ist
+		size_t Length;		//Nutzbare Länge des Blocks
+		uint32_t Flags;		//Bit 0: Reserviert (1) oder Frei (0)
+							//(Flags & 0xFF): Alle ungeraden Bits 1 und alle geraden 0
+		uint32_t Offset;	//Bei HEAP_ALIGNED: Abstand zum eigentlichen Block
 }heap_t;
 
+typedef struct heap_free{
+	struct heap_free *next;
+}heap_free_t;
+
 typedef struct{
-	heap_t heap_base;
-	union{
-		struct{
-			void *parent;
-			void *smaller;
-			void *bigger;
-			void *list;
-		};
-		struct{
-			void *prev;
-			void *next;
-		};
-	};
-}heap_empty_t;
+	heap_free_t *free;				//Freiliste
+	uintptr_t slab, slab_end;		//Noch nicht verteilter Bereich des aktuellen Slabs
+}heap_class_t;
+
+//Freier Pagebereich. Nur die erste Page (mit diesem Header) ist benutzt, der Rest ist dem Kernel zurückgegeben
+typedef struct heap_run{
+	size_t pages;
+	struct heap_run *next;
+}heap_run_t;
+
+#ifndef BUILD_KERNEL
+typedef struct{
+	heap_free_t *free;
+	size_t count;
+}heap_cache_class_t;
+
+//Blockcache eines Threads
+typedef struct{
+	lock_t lock;
+	heap_cache_class_t classes[HEAP_NUM_CLASSES];
+}heap_cache_t;
+#endif
 
 typedef struct{
 	void (*func)(void);
@@ -57,12 +83,18 @@ typedef struct{
 
 atexit_list_t *Atexit_List_Base = NULL;
 
-static heap_t *lastHeap = NULL;
-static heap_empty_t *base_emptyHeap = NULL;
+static heap_class_t heap_classes[HEAP_NUM_CLASSES];
+static uintptr_t heap_arena, heap_arena_end;		//Noch nicht verteilter Bereich der Arena
+static heap_run_t *heap_runs = NULL;				//Freie Pagebereiche, nach Adresse sortiert
+static lock_t heap_lock = LOCK_UNLOCKED;
+#ifndef BUILD_KERNEL
+static heap_cache_t heap_caches[HEAP_CACHE_SLOTS];
+#endif
 
 inline void *AllocPage(size_t Pages);
 inline void FreePage(void *Address, size_t Pages);
-void setupNewHeapEntry(heap_t *old, heap_t *new);
+static void UnusePages(void *Address, size_t Pages);
+static void heap_freePages(void *Address, size_t pages);
 
 void __attribute__((noexit)) abort()
 {
@@ -320,422 +352,277 @@ long int strtol(const char *str, char **endptr, int base)
 }
 
 //Speicherverwaltung-------------------------
+/*
+ * Kleine Anforderungen (bis HEAP_MAX_SMALL Bytes) werden auf eine Grössenklasse aufgerundet.
+ * Jede Klasse hat eine eigene Freiliste und schneidet neue Blöcke linear aus einem Slab
+ * von mehreren Pages heraus. Grosse Anforderungen bekommen einen eigenen Pagebereich.
+ * Jeder Block beginnt mit einem 16 Byte grossen Header, damit alle Adressen auf 16 Bytes
+ * ausgerichtet sind.
+ */
+static const size_t heap_class_size[HEAP_NUM_CLASSES] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512,
+	640, 768, 896, 1024,
+	1280, 1536, 1792, 2048
+};
+
 //Hilfsfunktionen
-static void rotate_left(heap_empty_t *node)
+/*
+ * Gibt den Index der kleinsten Grössenklasse zurück, in die size passt.
+ * Bis 128 Bytes sind die Klassen 16 Bytes auseinander, danach wird die Schrittweite
+ * pro Zweierpotenz verdoppelt (4 Klassen pro Zweierpotenz).
+ */
+static size_t heap_getClass(size_t size)
 {
-	heap_empty_t *tmp = node->bigger;
-	heap_empty_t *parent = node->parent;
+	if(size <= 128)
+		return (size + HEAP_ALIGN - 1) / HEAP_ALIGN - 1;
 
-	if(parent != NULL)
-	{
-		if(parent->smaller == node)
-			parent->smaller = tmp;
-		else
-			parent->bigger = tmp;
-	}
-	tmp->parent = parent;
-	node->parent = tmp;
-
-	if(node == base_emptyHeap)
-		base_emptyHeap = tmp;
-	if(tmp->smaller != NULL)
-		((heap_empty_t*)tmp->smaller)->parent = node;
-	node->bigger = tmp->smaller;
-	tmp->smaller = node;
+	size_t shift = 63 - __builtin_clzl(size - 1);
+	return 8 + (shift - 7) * 4 + ((size - 1 - (1ul << shift)) >> (shift - 2));
 }
 
-static void rotate_right(heap_empty_t *node)
+static size_t heap_slabPages(size_t class)
 {
-	heap_empty_t *tmp = node->smaller;
-	heap_empty_t *parent = node->parent;
-
-	if(parent != NULL)
-	{
-		if(parent->smaller == node)
-			parent->smaller = tmp;
-		else
-			parent->bigger = tmp;
-	}
-	tmp->parent = parent;
-	node->parent = tmp;
-
-	if(node == base_emptyHeap)
-		base_emptyHeap = tmp;
-	if(tmp->bigger != NULL)
-		((heap_empty_t*)tmp->bigger)->parent = node;
-	node->smaller = tmp->bigger;
-	tmp->bigger = node;
+	size_t block = heap_class_size[class] + sizeof(heap_t);
+	return (block * HEAP_SLAB_BLOCKS + HEAP_PAGE_SIZE - 1) / HEAP_PAGE_SIZE;
 }
 
-static void upin(heap_empty_t *node)
+/*
+ * Reserviert Pages aus einem freien Pagebereich oder aus der Arena. heap_lock muss gehalten werden.
+ */
+static void *heap_allocPages(size_t pages)
 {
-	if(node->parent != NULL)
+	heap_run_t **prev, *run;
+	void *Address;
+
+	//Erst in den freien Pagebereichen suchen (first fit)
+	for(prev = &heap_runs; (run = *prev) != NULL; prev = &run->next)
 	{
-		heap_empty_t *parent = node->parent;
-		if(node == parent->smaller)	//Node ist linker Sohn des Vaters
+		if(run->pages == pages)
 		{
-			if(parent->heap_base.balance == 1)
-				parent->heap_base.balance = 0;
-			else if(parent->heap_base.balance == 0)
-			{
-				parent->heap_base.balance = -1;
-				upin(parent);
-			}
-			else
-			{
-				if(node->heap_base.balance == -1)
-				{
-					parent->heap_base.balance = 0;
-					node->heap_base.balance = 0;
-					rotate_right(parent);
-				}
-				else	//Doppelrotation nach rechts
-				{
-					node->heap_base.balance = (((heap_empty_t*)node->bigger)->heap_base.balance == 1) ? -1 : 0;
-					parent->heap_base.balance = (((heap_empty_t*)node->bigger)->heap_base.balance == -1) ? 1 : 0;
-					((heap_empty_t*)node->bigger)->heap_base.balance = 0;
-					rotate_left(node);
-					rotate_right(parent);
-				}
-			}
+			*prev = run->next;
+			return run;
 		}
-		else		//Node ist rechter Sohn des Vaters
+		else if(run->pages > pages)
 		{
-			if(parent->heap_base.balance == -1)
-				parent->heap_base.balance = 0;
-			else if(parent->heap_base.balance == 0)
-			{
-				parent->heap_base.balance = 1;
-				upin(parent);
-			}
-			else
-			{
-				if(node->heap_base.balance == 1)
-				{
-					parent->heap_base.balance = 0;
-					node->heap_base.balance = 0;
-					rotate_left(parent);
-				}
-				else	//Doppelrotation nach links
-				{
-					node->heap_base.balance = (((heap_empty_t*)node->smaller)->heap_base.balance == -1) ? 1 : 0;
-					parent->heap_base.balance = (((heap_empty_t*)node->smaller)->heap_base.balance == 1) ? -1 : 0;
-					((heap_empty_t*)node->smaller)->heap_base.balance = 0;
-					rotate_right(node);
-					rotate_left(parent);
-				}
-			}
+			//Vom Ende her nehmen, damit der Header bleiben kann
+			run->pages -= pages;
+			return (void*)run + run->pages * HEAP_PAGE_SIZE;
 		}
 	}
+
+	//Dann aus der Arena nehmen und diese wenn nötig gleich um mehrere Pages vergrössern
+	if(heap_arena_end - heap_arena < pages * HEAP_PAGE_SIZE)
+	{
+		if(pages >= HEAP_ARENA_PAGES)
+			return AllocPage(pages);
+
+		Address = AllocPage(HEAP_ARENA_PAGES);
+		if(Address == NULL)
+			return NULL;
+		//Den Rest der alten Arena nicht verlieren
+		if(heap_arena_end != heap_arena)
+			heap_freePages((void*)heap_arena, (heap_arena_end - heap_arena) / HEAP_PAGE_SIZE);
+		heap_arena = (uintptr_t)Address;
+		heap_arena_end = heap_arena + HEAP_ARENA_PAGES * HEAP_PAGE_SIZE;
+	}
+	Address = (void*)heap_arena;
+	heap_arena += pages * HEAP_PAGE_SIZE;
+	return Address;
 }
 
-static void upout(heap_empty_t *node)
+/*
+ * Trägt einen Pagebereich in die Liste der freien Bereiche ein und verschmilzt ihn mit
+ * angrenzenden Bereichen. Bis auf die Header-Page wird der Speicher dem Kernel zurückgegeben,
+ * der virtuelle Bereich bleibt aber für spätere Anforderungen reserviert.
+ * heap_lock muss gehalten werden.
+ */
+static void heap_freePages(void *Address, size_t pages)
 {
-	heap_empty_t *parent = node->parent;
-	if(parent != NULL)
+	heap_run_t **prev = &heap_runs, *before = NULL, *run;
+
+	while(*prev != NULL && (void*)*prev < Address)
 	{
-		if(parent->smaller == node)	//Node ist linker Sohn
-		{
-			if(parent->heap_base.balance == -1)
-			{
-				parent->heap_base.balance = 0;
-				upout(parent);
-			}
-			else if(parent->heap_base.balance == 0)
-			{
-				parent->heap_base.balance = 1;
-			}
-			else
-			{
-				heap_empty_t *q = parent->bigger;
-				if(q->heap_base.balance == 0)
-				{
-					q->heap_base.balance = -1;
-					rotate_left(parent);
-				}
-				else if(q->heap_base.balance == 1)
-				{
-					parent->heap_base.balance = 0;
-					q->heap_base.balance = 0;
-					rotate_left(parent);
-					upout(q);
-				}
-				else
-				{
-					//Doppelrotation links
-					heap_empty_t *r = q->smaller;
-					q->heap_base.balance = (r->heap_base.balance == -1) ? 1 : 0;
-					parent->heap_base.balance = (r->heap_base.balance == 1) ? -1 : 0;
-					r->heap_base.balance = 0;
-					rotate_right(q);
-					rotate_left(parent);
-					upout(r);
-				}
-			}
-		}
-		else	//Node ist rechter Sohn
-		{
-			if(parent->heap_base.balance == 1)
-			{
-				parent->heap_base.balance = 0;
-				upout(parent);
-			}
-			else if(parent->heap_base.balance == 0)
-			{
-				parent->heap_base.balance = -1;
-			}
-			else
-			{
-				heap_empty_t *q = parent->smaller;
-				if(q->heap_base.balance == 0)
-				{
-					q->heap_base.balance = 1;
-					rotate_right(parent);
-				}
-				else if(q->heap_base.balance == -1)
-				{
-					parent->heap_base.balance = 0;
-					q->heap_base.balance = 0;
-					rotate_right(parent);
-					upout(q);
-				}
-				else
-				{
-					//Doppelrotation rechts
-					heap_empty_t *r = q->bigger;
-					q->heap_base.balance = (r->heap_base.balance == 1) ? -1 : 0;
-					parent->heap_base.balance = (r->heap_base.balance == -1) ? 1 : 0;
-					r->heap_base.balance = 0;
-					rotate_left(q);
-					rotate_right(parent);
-					upout(r);
-				}
-			}
-		}
+		before = *prev;
+		prev = &before->next;
+	}
+	heap_run_t *next = *prev;
+
+	if(before != NULL && (void*)before + before->pages * HEAP_PAGE_SIZE == Address)
+	{
+		run = before;
+		run->pages += pages;
+		UnusePages(Address, pages);
+	}
+	else
+	{
+		run = Address;
+		run->pages = pages;
+		run->next = next;
+		*prev = run;
+		if(pages > 1)
+			UnusePages(Address + HEAP_PAGE_SIZE, pages - 1);
+	}
+
+	if(next != NULL && (void*)run + run->pages * HEAP_PAGE_SIZE == (void*)next)
+	{
+		run->pages += next->pages;
+		run->next = next->next;
+		UnusePages(next, 1);
 	}
 }
 
-static void add_empty_heap(heap_empty_t *node)
+/*
+ * Reserviert einen Block der angegebenen Klasse. heap_lock muss gehalten werden.
+ */
+static heap_t *heap_allocSmall(size_t class)
 {
-	if(node == NULL)
-		return;
-	node->heap_base.balance = 0;
-	node->heap_base.is_list_mbr = false;
-	node->smaller = NULL;
-	node->bigger = NULL;
-	node->list = NULL;
-	if(base_emptyHeap == NULL)
+	heap_class_t *c = &heap_classes[class];
+	heap_t *heap;
+
+	if(c->free != NULL)
 	{
-		base_emptyHeap = node;
-		node->parent = NULL;
+		heap_free_t *block = c->free;
+		c->free = block->next;
+		heap = (heap_t*)block - 1;
 	}
 	else
 	{
-		heap_empty_t *root = base_emptyHeap;
-		while(true)
+		size_t block = heap_class_size[class] + sizeof(heap_t);
+		//Neuen Slab holen, wenn der aktuelle aufgebraucht ist
+		if(c->slab_end - c->slab < block)
 		{
-			if(node->heap_base.Length < root->heap_base.Length && root->smaller != NULL)
-				root = root->smaller;
-			else if(node->heap_base.Length > root->heap_base.Length && root->bigger != NULL)
-				root = root->bigger;
-			else
-				break;
+			size_t pages = heap_slabPages(class);
+			void *slab = heap_allocPages(pages);
+			if(slab == NULL)
+				return NULL;
+			c->slab = (uintptr_t)slab;
+			c->slab_end = c->slab + pages * HEAP_PAGE_SIZE;
 		}
+		heap = (heap_t*)c->slab;
+		c->slab += block;
+		heap->Length = heap_class_size[class];
+	}
+	heap->Flags = HEAP_FLAGS | HEAP_RESERVED;
+	heap->Offset = 0;
 
-		if(node->heap_base.Length == root->heap_base.Length)
-		{
-			//Knoten in die Liste einfügen
-			node->heap_base.is_list_mbr = true;
-			node->next = root->list;
-			node->prev = root;
-			root->list = node;
-			if(node->next != NULL)
-				((heap_empty_t*)node->next)->prev = node;
-		}
-		else
-		{
-			if(node->heap_base.Length < root->heap_base.Length)
-			{
-				root->smaller = node;
-				root->heap_base.balance--;
-			}
-			else
-			{
-				root->bigger = node;
-				root->heap_base.balance++;
-			}
-			node->parent = root;
+	return heap;
+}
 
-			if(root->heap_base.balance != 0)
-				upin(root);
-		}
-	}
+/*
+ * Reserviert einen eigenen Pagebereich für grosse Anforderungen.
+ */
+static heap_t *heap_allocLarge(size_t size)
+{
+	size_t pages = (size + sizeof(heap_t) + HEAP_PAGE_SIZE - 1) / HEAP_PAGE_SIZE;
+	lock(&heap_lock);
+	heap_t *heap = heap_allocPages(pages);
+	unlock(&heap_lock);
+	if(heap == NULL)
+		return NULL;
+	heap->Length = pages * HEAP_PAGE_SIZE - sizeof(heap_t);
+	heap->Flags = HEAP_FLAGS | HEAP_RESERVED | HEAP_LARGE;
+	heap->Offset = 0;
+	return heap;
 }
 
-static heap_empty_t *search_empty_heap(size_t size)
+#ifndef BUILD_KERNEL
+/*
+ * Gibt den Cache des aktuellen Threads zurück. Threads haben (noch) keinen eigenen
+ * Thread-Local-Storage, aber jeder Thread hat seinen eigenen Stack, die im festen Abstand
+ * HEAP_STACK_STRIDE voneinander liegen. Teilen sich zwei Threads einen Cache, schützt
+ * dessen Lock.
+ */
+static heap_cache_t *heap_getCache(void)
 {
-	heap_empty_t *node = base_emptyHeap;
-	while(node != NULL)
+	uintptr_t sp = (uintptr_t)__builtin_frame_address(0);
+	return &heap_caches[((HEAP_STACK_TOP - sp) / HEAP_STACK_STRIDE) % HEAP_CACHE_SLOTS];
+}
+
+/*
+ * Holt einen Block aus dem Cache und füllt diesen wenn nötig aus der Arena auf.
+ * Der Lock des Caches muss gehalten werden.
+ */
+static heap_t *heap_cacheAlloc(heap_cache_t *cache, size_t class)
+{
+	heap_cache_class_t *c = &cache->classes[class];
+
+	if(c->free == NULL)
 	{
-		if(size < node->heap_base.Length)
+		size_t i;
+		lock(&heap_lock);
+		for(i = 0; i < HEAP_CACHE_BATCH; i++)
 		{
-			if(node->smaller != NULL)
-				node = node->smaller;
-			else
-				return node->list ? : node;
+			heap_t *heap = heap_allocSmall(class);
+			if(heap == NULL)
+				break;
+			heap->Flags = HEAP_FLAGS;
+			heap_free_t *block = (heap_free_t*)(heap + 1);
+			block->next = c->free;
+			c->free = block;
+			c->count++;
 		}
-		else if(size > node->heap_base.Length)
-			node = node->bigger;
-		else
-			return node->list ? : node;
+		unlock(&heap_lock);
+		if(c->free == NULL)
+			return NULL;
 	}
-	return NULL;
+
+	heap_free_t *block = c->free;
+	c->free = block->next;
+	c->count--;
+
+	heap_t *heap = (heap_t*)block - 1;
+	heap->Flags = HEAP_FLAGS | HEAP_RESERVED;
+	heap->Offset = 0;
+	return heap;
 }
 
-static void remove_empty_heap(heap_empty_t *node, bool with_list)
+/*
+ * Legt einen Block in den Cache. Ist dieser voll, wird ein Teil an die Arena zurückgegeben.
+ * Der Lock des Caches muss gehalten werden.
+ */
+static void heap_cacheFree(heap_cache_t *cache, size_t class, heap_free_t *block)
 {
-	if(node == NULL)
-		return;
-	if(node->heap_base.is_list_mbr)
+	heap_cache_class_t *c = &cache->classes[class];
+
+	block->next = c->free;
+	c->free = block;
+	if(++c->count > HEAP_CACHE_MAX)
 	{
-		if(node->next != NULL)
-			((heap_empty_t*)node->next)->prev = node->prev;
-		if(node->prev != NULL)
+		size_t i;
+		lock(&heap_lock);
+		for(i = 0; i < HEAP_CACHE_MAX / 2; i++)
 		{
-			if(((heap_empty_t*)node->prev)->heap_base.is_list_mbr)
-				((heap_empty_t*)node->prev)->next = node->next;
-			else
-				((heap_empty_t*)node->prev)->list = node->next;
+			block = c->free;
+			c->free = block->next;
+			block->next = heap_classes[class].free;
+			heap_classes[class].free = block;
 		}
+		unlock(&heap_lock);
+		c->count -= HEAP_CACHE_MAX / 2;
 	}
-	else
-	{
-		heap_empty_t *parent = node->parent;
-		if(node->list != NULL && !with_list)
-		{
-			//Ersetze den Knoten durch den nächsten Knoten in der Liste
-			heap_empty_t *new_node = node->list;
-			heap_empty_t *tmp_next = new_node->next;
-
-			new_node->heap_base.balance = node->heap_base.balance;
-			new_node->heap_base.is_list_mbr = false;
-			new_node->parent = parent;
-			new_node->smaller = node->smaller;
-			new_node->bigger = node->bigger;
-			new_node->list = tmp_next;
-
-			if(parent != NULL)
-			{
-				if(parent->smaller == node)
-					parent->smaller = new_node;
-				else
-					parent->bigger = new_node;
-			}
-			else
-				base_emptyHeap = new_node;
+}
+#endif
 
-			if(new_node->smaller != NULL)
-				((heap_empty_t*)new_node->smaller)->parent = new_node;
-			if(new_node->bigger != NULL)
-				((heap_empty_t*)new_node->bigger)->parent = new_node;
-		}
-		else
-		{
-			if(node->smaller == NULL && node->bigger == NULL)	//Knoten hat keine Kinder
-			{
-				if(parent == NULL)
-				{
-					base_emptyHeap = NULL;
-				}
-				else
-				{
-					if(parent->smaller == node)	//Knoten ist linkes Kind
-					{
-						if(parent->heap_base.balance == 1)
-						{
-							upout(node);
-							((heap_empty_t*)node->parent)->smaller = NULL;
-						}
-						else
-						{
-							parent->smaller = NULL;
-							parent->heap_base.balance++;
-							if(parent->heap_base.balance == 0)
-								upout(parent);
-						}
-					}
-					else	//Knoten ist rechtes Kind
-					{
-						if(parent->heap_base.balance == -1)
-						{
-							upout(node);
-							((heap_empty_t*)node->parent)->bigger = NULL;
-						}
-						else
-						{
-							parent->bigger = NULL;
-							parent->heap_base.balance--;
-							if(parent->heap_base.balance == 0)
-								upout(parent);
-						}
-					}
-				}
-			}
-			else if(!node->smaller != !node->bigger)	//Knoten hat nur ein Kind
-			{
-				heap_empty_t *child;
-				if(node->smaller != NULL)
-					child = node->smaller;
-				else
-					child = node->bigger;
-				child->parent = node->parent;
-				if(parent != NULL)
-				{
-					if(parent->smaller == node)
-						parent->smaller = child;
-					else
-						parent->bigger = child;
-					upout(child);
-				}
-				else
-					base_emptyHeap = child;
-			}
-			else	//Knoten hat zwei Kinder
-			{
-				//Suche symmetrischer Vorgänger
-				heap_empty_t *tmp = node->smaller;
-				while(tmp->bigger != NULL)
-					tmp = tmp->bigger;
-
-				remove_empty_heap(tmp, true);
-
-				parent = node->parent;
-
-				//Ersetzen des aktuellen Knotens mit dem symmetrischen Vorgänger
-				tmp->bigger = node->bigger;
-				if(tmp->bigger != NULL)
-					((heap_empty_t*)tmp->bigger)->parent = tmp;
-				tmp->smaller = node->smaller;
-				if(tmp->smaller != NULL)
-					((heap_empty_t*)tmp->smaller)->parent = tmp;
-				tmp->parent = node->parent;
-				tmp->heap_base.balance = node->heap_base.balance;
-				if(parent != NULL)
-				{
-					if(parent->smaller == node)
-						parent->smaller = tmp;
-					else
-						parent->bigger = tmp;
-				}
-				else
-					base_emptyHeap = tmp;
-			}
-		}
-	}
+/*
+ * Gibt den Header des Blocks zurück, zu dem ptr gehört, oder NULL, wenn ptr ungültig ist.
+ * Bei ausgerichteten Blöcken (aligned_alloc) wird der Header des eigentlichen Blocks zurückgegeben.
+ */
+static heap_t *heap_getHeader(void *ptr)
+{
+	heap_t *heap = (heap_t*)ptr - 1;
+	if(heap->Flags == (HEAP_FLAGS | HEAP_ALIGNED))
+		heap = (heap_t*)(ptr - heap->Offset) - 1;
+	if((heap->Flags & ~HEAP_LARGE) != (HEAP_FLAGS | HEAP_RESERVED))
+		return NULL;
+	return heap;
 }
 
 void *calloc(size_t nitems, size_t size)
 {
+	if(size != 0 && nitems > SIZE_MAX / size)
+		return NULL;
 	void *Address = malloc(nitems * size);
 	if(Address == NULL) return NULL;
 	memset(Address, 0, nitems * size);
@@ -744,145 +631,104 @@ void *calloc(size_t nitems, size_t size)
 
 void free(void *ptr)
 {
-	heap_t *heap, *tmpheap;
 	if(ptr == NULL) return;
-	heap = ptr - sizeof(heap_t);
+	heap_t *heap = heap_getHeader(ptr);
 	//Ist dies eine gültige Addresse
-	if(heap->Flags == (HEAP_FLAGS | HEAP_RESERVED))
-	{
-		//Wenn möglich Speicherbereiche zusammenführen
-		if(heap->Prev != NULL)
-		{
-			tmpheap = heap->Prev;
-			if(((uintptr_t)tmpheap + tmpheap->Length + sizeof(heap_t)) == (uintptr_t)heap
-					&& !(tmpheap->Flags & HEAP_RESERVED))	//Wenn der Speicherbereich vornedran frei ist, dann mit diesem fusionieren
-			{
-				//Aus AVL-Baum entfernen
-				remove_empty_heap((heap_empty_t*)tmpheap, false);
-				tmpheap->Next = heap->Next;
-				tmpheap->Length += heap->Length + sizeof(heap_t);
-				heap = tmpheap;
-
-				//Prev-Eintrag des nächsten Eintrages korrigieren
-				if(heap->Next != NULL)
-				{
-					tmpheap = heap->Next;
-					tmpheap->Prev = heap;
-				}
-			}
-		}
-		if(heap->Next != NULL)
-		{
-			tmpheap = heap->Next;
-			if(((uintptr_t)heap + heap->Length + sizeof(heap_t)) == (uintptr_t)tmpheap
-					&& !(tmpheap->Flags & HEAP_RESERVED))	//Wenn der Speicherbereich hintendran frei ist, dann mit diesem fusionieren
-			{
-				//Aus AVL-Baum entfernen
-				remove_empty_heap((heap_empty_t*)tmpheap, false);
-				heap->Next = tmpheap->Next;
-				heap->Length += tmpheap->Length + sizeof(heap_t);
+	if(heap == NULL)
+		return;
 
-				//Prev-Eintrag des nächsten Eintrages korrigieren
-				if(heap->Next != NULL)
-				{
-					tmpheap = heap->Next;
-					tmpheap->Prev = heap;
-				}
-				else if(tmpheap == lastHeap)
-				{
-					lastHeap = heap;
-				}
-			}
-		}
+	if(heap->Flags & HEAP_LARGE)
+	{
+		heap->Flags = 0;
+		lock(&heap_lock);
+		heap_freePages(heap, (heap->Length + sizeof(heap_t)) / HEAP_PAGE_SIZE);
+		unlock(&heap_lock);
+	}
+	else
+	{
+		size_t class = heap_getClass(heap->Length);
+		heap_free_t *block = (heap_free_t*)(heap + 1);
 		heap->Flags = HEAP_FLAGS;
 
-		//Wenn möglich überflüssige Pages als unbenutzt markieren. 1 Page bleibt mindestens benutzt
-		if(heap->Length > 4096)
+#ifndef BUILD_KERNEL
+		heap_cache_t *cache = heap_getCache();
+		if(try_lock(&cache->lock))
 		{
-			//Aufrunden auf nächste Pagegrenze
-			uintptr_t bottom = ((uintptr_t)heap + 0xFFF) & ~0xFFF;
-			//Die Page des nächsten Heaps dürfen wir nicht freigeben
-			uintptr_t top = ((uintptr_t)heap + heap->Length + sizeof(heap_t)) & ~0xFFF;
-
-			if(top > bottom)
-			{
-				if((uintptr_t)heap >= bottom) bottom += 4096;
-
-				uint64_t Pages = (top - bottom) / 4096;
-
-				if(Pages > 0)
-				{
-#ifdef BUILD_KERNEL
-					vmm_unusePages((void*)bottom, Pages);
-#else
-					syscall_unusePage((void*)bottom, Pages);
-#endif
-				}
-			}
+			heap_cacheFree(cache, class, block);
+			unlock(&cache->lock);
+			return;
 		}
-
-		//Speicherbereich in AVL-Baum eintragen
-		add_empty_heap((heap_empty_t*)heap);
+#endif
+		lock(&heap_lock);
+		block->next = heap_classes[class].free;
+		heap_classes[class].free = block;
+		unlock(&heap_lock);
 	}
 }
 
 void *malloc(size_t size)
 {
-	heap_t *heap, *tmp_heap;
-	void *Address;
+	heap_t *heap;
 	if(size == 0)
 		return NULL;
 
-	//Size sollte ein Vielfaches von 8 sein und mindestens gross genug für die Erweiterung des Baumes
-	size = MAX(sizeof(heap_empty_t) - sizeof(heap_t), ((size + 7) & ~7));
-
-	//Nach passendem Eintrag suchen
-	heap_empty_t *node = search_empty_heap(size);
-
-	if(node == NULL)
+	if(size <= HEAP_MAX_SMALL)
 	{
-		size_t pages = (size + sizeof(heap_t)) / 4096 + 1;
-		node = AllocPage(pages);
-		if(node == NULL) return NULL;
-		node->heap_base.Next = NULL;
-		if(lastHeap == NULL)
-			node->heap_base.Prev = NULL;
-		else
+		size_t class = heap_getClass(size);
+#ifndef BUILD_KERNEL
+		heap_cache_t *cache = heap_getCache();
+		if(try_lock(&cache->lock))
 		{
-			node->heap_base.Prev = lastHeap;
-			lastHeap->Next = node;
+			heap = heap_cacheAlloc(cache, class);
+			unlock(&cache->lock);
+			return (heap != NULL) ? heap + 1 : NULL;
 		}
-		lastHeap = (heap_t*)node;
-		node->heap_base.Length = pages * 4096 - sizeof(heap_t);
-		node->heap_base.Flags = HEAP_FLAGS;
+#endif
+		lock(&heap_lock);
+		heap = heap_allocSmall(class);
+		unlock(&heap_lock);
 	}
 	else
-		remove_empty_heap((heap_empty_t*)node, false);
-
-	//Eintrag anpassen
-	heap = (heap_t*)node;
-	Address = (void*)((uintptr_t)heap + sizeof(heap_t));
-	if(node->heap_base.Length >= size + sizeof(heap_empty_t))
 	{
-		tmp_heap = Address + size;
-		setupNewHeapEntry(heap, tmp_heap);
-		tmp_heap->Length = heap->Length - size - sizeof(heap_t);
-		heap->Length = size;				//Länge anpassen
-
-		//Eintragen in AVL-Baum
-		add_empty_heap((heap_empty_t*)tmp_heap);
-		if(tmp_heap->Next == NULL)
-			lastHeap = tmp_heap;
+		if(size > SIZE_MAX - sizeof(heap_t) - HEAP_PAGE_SIZE)
+			return NULL;
+		heap = heap_allocLarge(size);
 	}
-	heap->Flags |= HEAP_RESERVED;		//Als reserviert markieren
 
-	return Address;
+	return (heap != NULL) ? heap + 1 : NULL;
 }
 
-void *realloc(void *ptr, size_t size)
+/*
+ * Reserviert size Bytes an einer Adresse, die ein Vielfaches von alignment ist.
+ * alignment muss eine Zweierpotenz sein.
+ */
+void *aligned_alloc(size_t alignment, size_t size)
 {
-	if(ptr == NULL && size == 0)
+	if(alignment == 0 || (alignment & (alignment - 1)))
+		return NULL;
+	if(alignment <= HEAP_ALIGN)
+		return malloc(size);
+	if(size == 0 || size > SIZE_MAX - alignment)
 		return NULL;
+
+	void *ptr = malloc(size + alignment);
+	if(ptr == NULL)
+		return NULL;
+
+	uintptr_t aligned = ((uintptr_t)ptr + alignment - 1) & ~(alignment - 1);
+	if(aligned != (uintptr_t)ptr)
+	{
+		//Zwischen ptr und aligned sind mindestens HEAP_ALIGN Bytes Platz für einen Verweis-Header
+		heap_t *heap = (heap_t*)aligned - 1;
+		heap->Flags = HEAP_FLAGS | HEAP_ALIGNED;
+		heap->Offset = aligned - (uintptr_t)ptr;
+		heap->Length = 0;
+	}
+	return (void*)aligned;
+}
+
+void *realloc(void *ptr, size_t size)
+{
 	if(ptr == NULL)
 		return malloc(size);
 	if(size == 0)
@@ -890,86 +736,21 @@ void *realloc(void *ptr, size_t size)
 		free(ptr);
 		return NULL;
 	}
-	heap_t *Heap, *tmpHeap;
-	void *Address = NULL;
-	Heap = ptr - sizeof(heap_t);
-
-	//Size sollte ein Vielfaches von 8 sein und mindestens gross genug für die Erweiterung des Baumes
-	size = MAX(sizeof(heap_empty_t) - sizeof(heap_t), ((size + 7) & ~7));
+	heap_t *heap = heap_getHeader(ptr);
 	//Ist dieser Heap gültig?
-	if(Heap->Flags == (HEAP_FLAGS | HEAP_RESERVED))
+	if(heap == NULL)
+		return NULL;
+
+	//Wenn der Platz noch da ist müssen wir nichts unternehmen
+	size_t length = heap->Length - (ptr - (void*)(heap + 1));
+	if(length >= size)
+		return ptr;
+
+	void *Address = malloc(size);
+	if(Address)
 	{
-		Address = ptr;
-		//TODO: Vielleicht könnte man hier auch Speicherplatz freigeben?
-		//Wenn der PLatz noch da ist müssen wir nichts untenehmen
-		if(Heap->Length < size)
-		{
-			//Ist hinten noch freier Platz?
-			if(Heap->Next != NULL)
-			{
-				tmpHeap = Heap->Next;
-				//Wenn hintendran noch freier Platz ist können wir unseren einfach vergrössern
-				if(!(tmpHeap->Flags & HEAP_RESERVED) && Heap->Length + tmpHeap->Length + sizeof(heap_t) >= size)
-				{
-					//Aus AVL-Baum entfernen
-					remove_empty_heap((heap_empty_t*)tmpHeap, false);
-					//Müssen wir den Header auch noch nehmen?
-					if(tmpHeap->Length < (size - Heap->Length) || tmpHeap->Length <= sizeof(heap_empty_t) - sizeof(heap_t))
-					{
-						Heap->Next = tmpHeap->Next;
-						if(tmpHeap->Next != NULL)
-						{
-							((heap_t*)tmpHeap->Next)->Prev = Heap;
-						}
-						Heap->Length += tmpHeap->Length + sizeof(heap_t);
-						if(lastHeap == tmpHeap)
-							lastHeap = Heap;
-					}
-					//Ansonsten verschieben wir den Header des nächsten Eintrags einfach
-					else
-					{
-						heap_t *oldHeap = tmpHeap;
-						tmpHeap = memmove((void*)Heap + sizeof(heap_t) + size, tmpHeap, sizeof(heap_t));
-						Heap->Next = tmpHeap;
-						tmpHeap->Length -= size - Heap->Length;
-						//Eintrag des übernächsten Eintrags aktualisieren
-						if(tmpHeap->Next != NULL)
-						{
-							((heap_t*)tmpHeap->Next)->Prev = tmpHeap;
-						}
-						Heap->Length = size;
-						if(lastHeap == oldHeap)
-							lastHeap = tmpHeap;
-						//Wieder in den AVL-Baum eintragen
-						add_empty_heap((heap_empty_t*)tmpHeap);
-					}
-				}
-				else
-				{
-					Address = malloc(size);
-					if(Address)
-					{
-						if(size > Heap->Length)
-							memcpy(Address, ptr, Heap->Length);
-						else
-							memcpy(Address, ptr, size);
-						free(ptr);
-					}
-				}
-			}
-			else
-			{
-				Address = malloc(size);
-				if(Address)
-				{
-					if(size > Heap->Length)
-						memcpy(Address, ptr, Heap->Length);
-					else
-						memcpy(Address, ptr, size);
-					free(ptr);
-				}
-			}
-		}
+		memcpy(Address, ptr, length);
+		free(ptr);
 	}
 
 	return Address;
@@ -1024,23 +805,28 @@ int64_t lrand()
 #ifdef BUILD_KERNEL
 inline void *AllocPage(size_t Pages)
 {
-	return mm_SysAlloc(Pages);
+	return (void*)mm_SysAlloc(Pages);
 }
 
 inline void FreePage(void *Address, size_t Pages)
 {
-	mm_SysFree(Address, Pages);
+	mm_SysFree((uintptr_t)Address, Pages);
+}
+
+//Meldet den Heap-Lock für die Lockstatistik an
+void heap_registerLock(void)
+{
+	lockstat_register(&heap_lock, "heap");
 }
 #endif
 
-void setupNewHeapEntry(heap_t *old, heap_t *new)
+static void UnusePages(void *Address, size_t Pages)
 {
-	new->Prev = old;
-	new->Next = old->Next;
-	if(new->Next != NULL)
-		((heap_t*)new->Next)->Prev = new;
-	old->Next = new;
-	new->Flags = HEAP_FLAGS;
+#ifdef BUILD_KERNEL
+	vmm_unusePages(Address, Pages);
+#else
+	syscall_unusePage(Address, Pages);
+#endif
 }
 
 static int cmph(const void* a, const void* b, int (*cmp)(const void*, const void*)) {
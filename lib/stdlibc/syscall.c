@@ -26,6 +26,16 @@ void syscall_unusePage(void *Address, size_t Pages)
 	_syscall(2, Address, Pages);
 }
 
+void *syscall_mmap(void *stream, uint64_t offset, size_t length, uint64_t flags)
+{
+	return (void*)_syscall(3, stream, offset, length, flags);
+}
+
+int syscall_munmap(void *address)
+{
+	return _syscall(4, address);
+}
+
 pid_t syscall_createProcess(const char *path, const char *cmd, const char *stdin, const char *stdout, const char *stderr)
 {
 	return (pid_t)_syscall(10, path, cmd, stdin, stdout, stderr);
@@ -48,6 +58,21 @@ void __attribute__((noreturn)) syscall_exitThread(int status)
 	asm volatile("int $0x30" : : "D"(13), "S"(status));
 }
 
+int syscall_futexWait(uint32_t *address, uint32_t value)
+{
+	return _syscall(14, address, value);
+}
+
+uint64_t syscall_futexWake(uint32_t *address, uint64_t count)
+{
+	return _syscall(15, address, count);
+}
+
+int syscall_pmcRead(pmc_values_t *values)
+{
+	return _syscall(16, values);
+}
+
 void *syscall_fopen(char *path, vfs_mode_t mode)
 {
 	return (void*)_syscall(40, path, mode);
@@ -73,6 +98,31 @@ uint64_t syscall_StreamInfo(void *stream, vfs_fileinfo_t info)
 	return _syscall(44, stream, info);
 }
 
+size_t syscall_freadv(void *stream, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	return _syscall(47, stream, start, iov, count);
+}
+
+size_t syscall_fwritev(void *stream, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	return _syscall(48, stream, start, iov, count);
+}
+
+size_t syscall_fsplice(void *dst, uint64_t dst_start, void *src, uint64_t src_start, size_t length)
+{
+	return _syscall(49, dst, dst_start, src, src_start, length);
+}
+
+int syscall_ioringSetup(ioring_t *ring, uint32_t entries)
+{
+	return _syscall(45, ring, entries);
+}
+
+int64_t syscall_ioringEnter(uint32_t min_complete)
+{
+	return _syscall(46, min_complete);
+}
+
 void syscall_sleep(uint64_t msec)
 {
 	_syscall(52, msec);
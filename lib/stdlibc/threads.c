@@ -0,0 +1,107 @@
+/*
+ * threads.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifndef BUILD_KERNEL
+
+#include "threads.h"
+#include "syscall.h"
+#include "stddef.h"
+
+#define MTX_UNLOCKED	0
+#define MTX_LOCKED		1
+#define MTX_CONTENDED	2		//Gesperrt, mindestens ein Thread wartet (oder hat gewartet)
+
+int mtx_init(mtx_t *mtx, int type)
+{
+	if(mtx == NULL || type != mtx_plain)
+		return thrd_error;
+
+	mtx->state = MTX_UNLOCKED;
+	return thrd_success;
+}
+
+int mtx_lock(mtx_t *mtx)
+{
+	uint32_t state = __sync_val_compare_and_swap(&mtx->state, MTX_UNLOCKED, MTX_LOCKED);
+	if(state == MTX_UNLOCKED)
+		return thrd_success;
+
+	//Ab jetzt als umkämpft markieren, damit der Besitzer beim Freigeben einen Thread aufweckt
+	if(state != MTX_CONTENDED)
+		state = __atomic_exchange_n(&mtx->state, MTX_CONTENDED, __ATOMIC_ACQUIRE);
+	while(state != MTX_UNLOCKED)
+	{
+		syscall_futexWait((uint32_t*)&mtx->state, MTX_CONTENDED);
+		state = __atomic_exchange_n(&mtx->state, MTX_CONTENDED, __ATOMIC_ACQUIRE);
+	}
+	return thrd_success;
+}
+
+int mtx_trylock(mtx_t *mtx)
+{
+	if(__sync_bool_compare_and_swap(&mtx->state, MTX_UNLOCKED, MTX_LOCKED))
+		return thrd_success;
+	return thrd_busy;
+}
+
+int mtx_unlock(mtx_t *mtx)
+{
+	if(__sync_fetch_and_sub(&mtx->state, 1) != MTX_LOCKED)
+	{
+		mtx->state = MTX_UNLOCKED;
+		syscall_futexWake((uint32_t*)&mtx->state, 1);
+	}
+	return thrd_success;
+}
+
+void mtx_destroy(mtx_t *mtx)
+{
+}
+
+int cnd_init(cnd_t *cond)
+{
+	if(cond == NULL)
+		return thrd_error;
+
+	cond->seq = 0;
+	return thrd_success;
+}
+
+int cnd_signal(cnd_t *cond)
+{
+	__sync_fetch_and_add(&cond->seq, 1);
+	syscall_futexWake((uint32_t*)&cond->seq, 1);
+	return thrd_success;
+}
+
+int cnd_broadcast(cnd_t *cond)
+{
+	__sync_fetch_and_add(&cond->seq, 1);
+	syscall_futexWake((uint32_t*)&cond->seq, UINT64_MAX);
+	return thrd_success;
+}
+
+int cnd_wait(cnd_t *cond, mtx_t *mtx)
+{
+	uint32_t seq = cond->seq;
+
+	mtx_unlock(mtx);
+	//Wenn inzwischen ein Signal kam, hat sich seq verändert und der Syscall kehrt sofort zurück
+	syscall_futexWait((uint32_t*)&cond->seq, seq);
+
+	//Der Mutex wird als umkämpft gesperrt, da noch andere Threads auf der Bedingung warten könnten
+	while(__atomic_exchange_n(&mtx->state, MTX_CONTENDED, __ATOMIC_ACQUIRE) != MTX_UNLOCKED)
+		syscall_futexWait((uint32_t*)&mtx->state, MTX_CONTENDED);
+
+	return thrd_success;
+}
+
+void cnd_destroy(cnd_t *cond)
+{
+}
+
+#endif
@@ -33,12 +33,19 @@
 #include "stdlib.h"
 #include "scheduler.h"
 #include "apic.h"
+#include "acpi.h"
+#include "ioapic.h"
 #include "tss.h"
 #include "pci.h"
 #include "devicemng.h"
 #include "console.h"
 #include "syscalls.h"
 #include "string.h"
+#include "lockstat.h"
+#include "irqstat.h"
+#include "trace.h"
+#include "profile.h"
+#include "pmu.h"
 
 static multiboot_structure static_MBS;
 
@@ -91,7 +98,14 @@ void Init()
 	//isr_Init();
 	keyboard_Init();	//Tastatur(treiber) initialisieren
 	apic_Init();
+	acpi_Init();		//ACPI-Tabellen suchen
+	ioapic_Init();		//IRQs über den I/O APIC leiten
 	vfs_Init();			//VFS initialisieren
+	lockstat_Init();	//Lockstatistik initialisieren
+	irqstat_Init();		//Interruptstatistik initialisieren
+	trace_Init();		//Tracepoints initialisieren
+	profile_Init();		//Profiler initialisieren
+	pmu_Init();			//Leistungszähler initialisieren
 	pci_Init();			//PCI-Treiber initialisieren
 	dmng_Init();
 	pm_Init();			//Tasks initialisieren
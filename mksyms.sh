@@ -0,0 +1,54 @@
+#!/bin/sh
+#
+# mksyms.sh
+#
+#  Created on: 19.10.2026
+#      Author: pascal
+#
+# Erzeugt die Symboltabelle des Kernels (siehe util/ksym.h) als C-Quelldatei.
+# Aufruf:	mksyms.sh <Kernel-ELF> > ksyms.c
+#
+# Ablauf beim Bauen:
+#	1. Kernel ohne ksyms.o linken
+#	2. mksyms.sh kernel > ksyms.c und ksyms.c mit -DBUILD_KERNEL übersetzen
+#	3. Kernel mit ksyms.o erneut linken
+# Die Tabelle liegt nur in .rodata und .data hinter .text, die Codeadressen aus Schritt 1 bleiben
+# deshalb gültig.
+
+if [ $# -ne 1 ]; then
+	echo "Aufruf: $0 <Kernel-ELF>" >&2
+	exit 1
+fi
+
+NM=${NM:-nm}
+
+$NM -n "$1" | awk '
+BEGIN {
+	print "/* Automatisch erzeugt von mksyms.sh, nicht bearbeiten */"
+	print ""
+	print "#ifdef BUILD_KERNEL"
+	print ""
+	print "#include \"ksym.h\""
+	print ""
+	print "const ksym_t kernel_symbols[] = {"
+	count = 0
+	last = ""
+}
+# Nur Codesymbole, bei mehreren Symbolen an derselben Adresse das erste
+($2 == "t" || $2 == "T") && $1 != last {
+	name = $3
+	gsub(/\\/, "\\\\", name)
+	gsub(/"/, "\\\"", name)
+	printf("\t{0x%s, \"%s\"},\n", $1, name)
+	last = $1
+	count++
+}
+END {
+	if(count == 0)
+		print "\t{0, \"\"}"
+	print "};"
+	print ""
+	printf("const size_t kernel_symbols_count = %d;\n", count)
+	print ""
+	print "#endif"
+}'
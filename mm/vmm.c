@@ -16,6 +16,7 @@
 #include "stdlib.h"
 #include "string.h"
 #include "lock.h"
+#include "lockstat.h"
 
 #define NULL (void*)0
 
@@ -54,7 +55,6 @@ context_t kernel_context;
 
 //Funktionen, die nur in dieser Datei aufgerufen werden sollen
 uint8_t vmm_UnMap(void *vAddress);
-uint8_t vmm_ChangeMap(void *vAddress, paddr_t pAddress, uint8_t flags, uint16_t avl);
 
 void *getFreePages(void *start, void *end, size_t pages);
 //Ende der Funktionendeklaration
@@ -123,6 +123,7 @@ bool vmm_Init()
 	}
 
 	//Lock der Speicherverwaltung freigeben
+	lockstat_register(&vmm_lock, "vmm");
 	unlock(&vmm_lock);
 
 	SysLog("VMM", "Initialisierung abgeschlossen");
@@ -130,6 +131,26 @@ bool vmm_Init()
 }
 
 //Userspace Funktionen
+/*
+ * Prüft, ob an der Adresse eine geteilte Page (VMM_SHARED_PAGE) gemappt ist
+ */
+static bool isSharedPage(void *vAddress)
+{
+	PT_t *PT = (PT_t*)VMM_PT_ADDRESS;
+
+	if(vmm_getPageStatus(vAddress))
+		return false;
+
+	uint16_t PML4i = ((uintptr_t)vAddress & PG_PML4_INDEX) >> 39;
+	uint16_t PDPi = ((uintptr_t)vAddress & PG_PDP_INDEX) >> 30;
+	uint16_t PDi = ((uintptr_t)vAddress & PG_PD_INDEX) >> 21;
+	uint16_t PTi = ((uintptr_t)vAddress & PG_PT_INDEX) >> 12;
+
+	PT = (void*)PT + (((uint64_t)PML4i << 30) | ((uint64_t)PDPi << 21) | (PDi << 12));
+
+	return (PT->PTE[PTi] & PG_P) && (PG_AVL(PT->PTE[PTi]) & VMM_SHARED_PAGE);
+}
+
 /*
  * Reserviert ein Speicherblock mit der Blockgrösse Length (in Pages)
  * Parameter:		Length = Die Anzahl Pages, die reserviert werden sollen
@@ -177,10 +198,12 @@ void vmm_Free(void *vAddress, size_t Pages)
 	void *i;
 	for(i = vAddress; i < vAddress + Pages * MM_BLOCK_SIZE; i += VMM_SIZE_PER_PAGE)
 	{
-		paddr_t pAddress = vmm_getPhysAddress(vAddress);
+		paddr_t pAddress = vmm_getPhysAddress(i);
+		bool shared = isSharedPage(i);
 		uint8_t Fehler = vmm_UnMap(i);
 		if(Fehler == 2) Panic("VMM", "Zu wenig physikalischer Speicher vorhanden");
-		if(Fehler != 1)
+		//Geteilte Pages gehören nicht dem Prozess
+		if(Fehler != 1 && !shared)
 			pmm_Free(pAddress);
 	}
 }
@@ -242,7 +265,7 @@ void vmm_SysFree(void *vAddress, size_t Length)
 	lock(&vmm_lock);
 	for(i = vAddress; i < vAddress + Length * MM_BLOCK_SIZE; i += VMM_SIZE_PER_PAGE)
 	{
-		paddr_t pAddress = vmm_getPhysAddress(vAddress);
+		paddr_t pAddress = vmm_getPhysAddress(i);
 		uint8_t Fehler = vmm_UnMap(i);
 		if(Fehler == 2) Panic("VMM", "Zu wenig physikalischer Speicher vorhanden");
 		if(Fehler != 1)
@@ -251,6 +274,22 @@ void vmm_SysFree(void *vAddress, size_t Length)
 	unlock(&vmm_lock);
 }
 
+/*
+ * Entfernt das Mapping von Kernelspeicher, ohne den physischen Speicher freizugeben.
+ * Damit kann im Kernel vorbereiteter Speicher einem Prozess übergeben werden.
+ * Params:
+ * vAddress = Virtuelle Addresse des Speicherplatzes
+ * Length = Anzahl Pages
+ */
+void vmm_SysUnMap(void *vAddress, size_t Length)
+{
+	void *i;
+	lock(&vmm_lock);
+	for(i = vAddress; i < vAddress + Length * MM_BLOCK_SIZE; i += VMM_SIZE_PER_PAGE)
+		vmm_UnMap(i);
+	unlock(&vmm_lock);
+}
+
 /*
  * Mappt ein Modul an eine bestimmte Stelle
  * Params:	mod = Mod-Struktur
@@ -727,7 +766,11 @@ uint8_t vmm_UnMap(void *vAddress)
 		return 0;
 	}
 	else
+	{
+		//Eine nie benutzte Page ist nicht vorhanden, belegt aber trotzdem die virtuelle Adresse
+		PT->PTE[PTi] &= ~((uint64_t)VMM_UNUSED_PAGE << 9);
 		return 1;
+	}
 }
 
 /*
@@ -1370,7 +1413,7 @@ void vmm_unusePages(void *virt, size_t pages)
 
 		PT = (void*)PT + (((uint64_t)PML4i << 30) | ((uint64_t)PDPi << 21) | (PDi << 12));
 
-		if(!vmm_getPageStatus(address) && (PG_AVL(PT->PTE[PTi]) & VMM_UNUSED_PAGE) == 0)
+		if(!vmm_getPageStatus(address) && (PG_AVL(PT->PTE[PTi]) & (VMM_UNUSED_PAGE | VMM_SHARED_PAGE)) == 0)
 		{
 			paddr_t entry = PT->PTE[PTi];
 			pmm_Free(entry & PG_ADDRESS);
@@ -1483,8 +1526,8 @@ void deleteContext(context_t *context)
 							vmm_Map(PT, PD->PDE[PDi], VMM_FLAGS_NX, VMM_KERNELSPACE);
 							for(PTi = 0; PTi < PAGE_ENTRIES; PTi++)
 							{
-								//Ist die Page alloziiert
-								if(PT->PTE[PTi] & PG_P)
+								//Ist die Page alloziiert und gehört sie dem Prozess
+								if((PT->PTE[PTi] & PG_P) && !(PG_AVL(PT->PTE[PTi]) & VMM_SHARED_PAGE))
 									pmm_Free(PT->PTE[PTi] & PG_ADDRESS);
 							}
 							//PT löschen
@@ -24,6 +24,7 @@
 #define VMM_FLAGS_NO_CACHE	(1 << 5)	//Bestimmt, ob die Page nicht gecacht werden soll
 
 #define VMM_UNUSED_PAGE		0x4		//Marks page as unused by process
+#define VMM_SHARED_PAGE		0x20	//Phys. Speicher gehört nicht dem Prozess (z.B. Page-Cache) und wird nicht freigegeben
 
 typedef struct{
 	paddr_t physAddress;
@@ -36,6 +37,7 @@ void vmm_Free(void *Address, size_t Size);		//Gibt eine Speicherstelle frei
 
 void *vmm_SysAlloc(size_t Length);
 void vmm_SysFree(void *vAddress, size_t Length);
+void vmm_SysUnMap(void *vAddress, size_t Length);
 
 void *vmm_AllocDMA(paddr_t maxAddress, size_t Size, paddr_t *Phys);
 list_t vmm_getTables(context_t *context);
@@ -44,6 +46,7 @@ void vmm_MapModule(mods *mod);
 void vmm_UnMapModule(mods *mod);
 
 uint8_t vmm_Map(void *vAddress, paddr_t pAddress, uint8_t flags, uint16_t avl);
+uint8_t vmm_ChangeMap(void *vAddress, paddr_t pAddress, uint8_t flags, uint16_t avl);
 
 void *getFreePages(void *start, void *end, size_t pages);
 
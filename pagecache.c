@@ -0,0 +1,285 @@
+/*
+ * pagecache.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "pagecache.h"
+#include "hashmap.h"
+#include "lock.h"
+#include "lockstat.h"
+#include "vmm.h"
+#include "memory.h"
+#include "pmm.h"
+#include "vfs.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdio.h"
+
+#define PAGECACHE_MIN				64	//So viele Pages dürfen immer gecacht werden
+#define PAGECACHE_PART				8	//Höchstens 1/8 des physischen Speichers wird für den Cache verwendet
+#define PAGECACHE_LOW_MEMORY		16	//Wenn weniger als 1/16 des Speichers frei ist, wird nur das Minimum gecacht
+
+static hashmap_t *pagecache = NULL;
+static ilist_t pagecache_lru = ILIST_INIT(pagecache_lru);	//Unbenutzte Pages, am längsten nicht verwendete zuerst
+static lock_t pagecache_lock = LOCK_UNLOCKED;
+
+static struct{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+}pagecache_stats;
+
+static uint64_t page_hash(const void *key, __attribute__((unused)) void *context)
+{
+	const pagecache_page_t *page = key;
+	uint64_t hash = ((uintptr_t)page->owner >> 3) ^ (page->index * 0x9E3779B97F4A7C15ul);
+	return hash ^ (hash >> 29);
+}
+
+static bool page_equal(const void *a, const void *b, __attribute__((unused)) void *context)
+{
+	const pagecache_page_t *x = a, *y = b;
+	return x->owner == y->owner && x->index == y->index;
+}
+
+static void freePage(pagecache_page_t *page)
+{
+	vmm_SysFree(page->data, 1);
+	free(page);
+}
+
+/*
+ * Maximale Anzahl Pages im Cache. Richtet sich nach der Grösse des physischen Speichers,
+ * wenn der Speicher knapp wird, werden nur noch wenige Pages gecacht.
+ */
+static size_t pagecacheLimit(void)
+{
+	uint64_t total = pmm_getTotalPages();
+	size_t limit = total / PAGECACHE_PART;
+
+	if(limit < PAGECACHE_MIN || pmm_getFreePages() < total / PAGECACHE_LOW_MEMORY)
+		limit = PAGECACHE_MIN;
+	return limit;
+}
+
+/*
+ * Verdrängt unbenutzte Pages, bis höchstens limit Pages im Cache sind.
+ * pagecache_lock muss gehalten werden. Die Pages werden in evicted gesammelt und müssen
+ * nach dem Freigeben des Locks mit freePage freigegeben werden.
+ */
+static void shrinkCache(size_t limit, ilist_t *evicted)
+{
+	while(hashmap_count(pagecache) > limit && !ilist_empty(&pagecache_lru))
+	{
+		pagecache_page_t *page = ILIST_ENTRY(ilist_pop_front(&pagecache_lru), pagecache_page_t, lru);
+		hashmap_delete(pagecache, page);
+		ilist_push_back(evicted, &page->lru);
+		pagecache_stats.evictions++;
+	}
+}
+
+static void freeEvicted(ilist_t *evicted)
+{
+	ilist_node_t *node;
+	while((node = ilist_pop_front(evicted)) != NULL)
+		freePage(ILIST_ENTRY(node, pagecache_page_t, lru));
+}
+
+pagecache_page_t *pagecache_get(const void *owner, uint64_t index, pagecache_fill_t *fill, void *opaque)
+{
+	const pagecache_page_t key = {.owner = owner, .index = index};
+	pagecache_page_t *page, *cached;
+	ilist_t evicted = ILIST_INIT(evicted);
+
+	if(pagecache == NULL)
+		return NULL;
+
+	lock(&pagecache_lock);
+	if(hashmap_search(pagecache, &key, (void**)&page) == HASH_MAP_SUCCESS_FOUND)
+	{
+		if(page->refcount++ == 0)
+			ilist_remove(&pagecache_lru, &page->lru);
+		pagecache_stats.hits++;
+		unlock(&pagecache_lock);
+		return page;
+	}
+	pagecache_stats.misses++;
+	unlock(&pagecache_lock);
+
+	//Page ausserhalb des Locks laden, da der Treiber auf das Gerät warten muss
+	page = malloc(sizeof(pagecache_page_t));
+	if(page == NULL)
+		return NULL;
+	page->data = vmm_SysAlloc(1);
+	if(page->data == NULL)
+	{
+		free(page);
+		return NULL;
+	}
+	memset(page->data, 0, MM_BLOCK_SIZE);
+	page->phys = vmm_getPhysAddress(page->data);
+	page->owner = owner;
+	page->index = index;
+	page->refcount = 1;
+	page->valid = fill(opaque, index, page->data);
+	if(page->valid == 0)
+	{
+		freePage(page);
+		return NULL;
+	}
+
+	lock(&pagecache_lock);
+	//Ein anderer Thread könnte die Page inzwischen geladen haben
+	if(hashmap_search(pagecache, &key, (void**)&cached) == HASH_MAP_SUCCESS_FOUND)
+	{
+		if(cached->refcount++ == 0)
+			ilist_remove(&pagecache_lru, &cached->lru);
+		unlock(&pagecache_lock);
+		freePage(page);
+		return cached;
+	}
+	shrinkCache(pagecacheLimit() - 1, &evicted);
+	if(hashmap_set(pagecache, page, page) != HASH_MAP_SUCCESS)
+	{
+		//Nicht gecacht, wird beim Freigeben gelöscht
+		page->owner = NULL;
+	}
+	unlock(&pagecache_lock);
+
+	freeEvicted(&evicted);
+	return page;
+}
+
+void pagecache_put(pagecache_page_t *page)
+{
+	ilist_t evicted = ILIST_INIT(evicted);
+
+	lock(&pagecache_lock);
+	if(--page->refcount == 0)
+	{
+		if(page->owner == NULL)
+			ilist_push_back(&evicted, &page->lru);
+		else
+		{
+			ilist_push_back(&pagecache_lru, &page->lru);
+			shrinkCache(pagecacheLimit(), &evicted);
+		}
+	}
+	unlock(&pagecache_lock);
+
+	freeEvicted(&evicted);
+}
+
+void pagecache_update(const void *owner, uint64_t start, size_t length, const void *buffer)
+{
+	pagecache_page_t key = {.owner = owner};
+	pagecache_page_t *page;
+	size_t done = 0;
+
+	if(pagecache == NULL)
+		return;
+
+	while(done < length)
+	{
+		size_t offset = (start + done) % MM_BLOCK_SIZE;
+		size_t size = MM_BLOCK_SIZE - offset;
+		if(size > length - done)
+			size = length - done;
+		key.index = (start + done) / MM_BLOCK_SIZE;
+
+		lock(&pagecache_lock);
+		if(hashmap_search(pagecache, &key, (void**)&page) == HASH_MAP_SUCCESS_FOUND)
+		{
+			if(page->refcount++ == 0)
+				ilist_remove(&pagecache_lru, &page->lru);
+			unlock(&pagecache_lock);
+
+			//Der Puffer kann im Userspace liegen, deshalb ohne Lock kopieren
+			memcpy(page->data + offset, buffer + done, size);
+
+			lock(&pagecache_lock);
+			if(page->valid < offset + size)
+				page->valid = offset + size;
+			unlock(&pagecache_lock);
+			pagecache_put(page);
+		}
+		else
+			unlock(&pagecache_lock);
+
+		done += size;
+	}
+}
+
+void pagecache_purge(const void *owner)
+{
+	ilist_node_t *node;
+	ilist_t matched = ILIST_INIT(matched);
+	ilist_t evicted = ILIST_INIT(evicted);
+	hashmap_iterator_t it;
+	pagecache_page_t *page;
+
+	if(pagecache == NULL)
+		return;
+
+	lock(&pagecache_lock);
+	//Zuerst sammeln, da die Hashmap während dem Iterieren nicht verändert werden darf
+	hashmap_iterator_init(pagecache, &it);
+	while(hashmap_iterator_next(&it, NULL, (void**)&page))
+	{
+		if(page->owner == owner)
+		{
+			if(page->refcount == 0)
+				ilist_remove(&pagecache_lru, &page->lru);
+			ilist_push_back(&matched, &page->lru);
+		}
+	}
+
+	while((node = ilist_pop_front(&matched)) != NULL)
+	{
+		page = ILIST_ENTRY(node, pagecache_page_t, lru);
+		hashmap_delete(pagecache, page);
+		//Verwendete Pages werden von pagecache_put freigegeben, sobald sie nicht mehr verwendet werden
+		if(page->refcount == 0)
+			ilist_push_back(&evicted, &page->lru);
+		else
+			page->owner = NULL;
+	}
+	unlock(&pagecache_lock);
+
+	freeEvicted(&evicted);
+}
+
+static size_t pagecache_read(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	char text[256];
+
+	lock(&pagecache_lock);
+	uint64_t lookups = pagecache_stats.hits + pagecache_stats.misses;
+	uint64_t rate = lookups ? pagecache_stats.hits * 1000 / lookups : 0;
+	size_t pages = hashmap_count(pagecache);
+	size_t size = sprintf(text, "pages: %lu\nin use: %lu\nlimit: %lu\nhits: %lu\nmisses: %lu\nevictions: %lu\nhit rate: %lu.%lu%%\n",
+			pages, pages - ilist_size(&pagecache_lru), pagecacheLimit(), pagecache_stats.hits, pagecache_stats.misses,
+			pagecache_stats.evictions, rate / 10, rate % 10);
+	unlock(&pagecache_lock);
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	return read;
+}
+
+void pagecache_Init(void)
+{
+	lockstat_register(&pagecache_lock, "pagecache");
+	pagecache = hashmap_create(page_hash, page_equal, NULL, NULL, NULL, PAGECACHE_MIN);
+	vfs_RegisterInfoFile("pagecache", pagecache_read, NULL);
+}
+
+#endif
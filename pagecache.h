@@ -0,0 +1,74 @@
+/*
+ * pagecache.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef PAGECACHE_H_
+#define PAGECACHE_H_
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+#include "ilist.h"
+#include "pmm.h"
+
+/*
+ * Cache für Dateiinhalte. Eine Page wird durch (Besitzer, Index) identifiziert, für das VFS ist
+ * der Besitzer die Ressource und der Index die Nummer der Page in der Datei. Pages, die gerade
+ * verwendet oder in einen Prozess gemappt sind, werden nicht verdrängt.
+ * Die Statistik ist unter /sysinf/pagecache abrufbar.
+ */
+
+typedef struct{
+	const void *owner;
+	uint64_t index;
+	void *data;			//Kernelmapping der Page
+	paddr_t phys;		//Physische Adresse, um die Page in einen Prozess zu mappen
+	size_t valid;		//Anzahl gültiger Bytes, der Rest der Page ist 0
+	uint64_t refcount;	//Anzahl Verwender. Unbenutzte Pages sind in der LRU-Liste.
+	ilist_node_t lru;
+}pagecache_page_t;
+
+/*
+ * Füllt eine neue Page
+ * Parameter:	opaque = Parameter von pagecache_get
+ * 				index = Index der Page
+ * 				data = Page, in die gelesen wird
+ * Rückgabe:	Anzahl gelesener Bytes. Bei 0 wird die Page nicht in den Cache aufgenommen.
+ */
+typedef size_t (pagecache_fill_t)(void *opaque, uint64_t index, void *data);
+
+void pagecache_Init(void);
+
+/*
+ * Sucht eine Page und lädt sie wenn nötig. Die Page muss mit pagecache_put wieder freigegeben werden.
+ * Parameter:	owner = Besitzer
+ * 				index = Index der Page
+ * 				fill = Funktion zum Laden der Page
+ * 				opaque = Parameter für fill
+ * Rückgabe:	Reservierte Page oder NULL bei Fehler oder wenn die Page leer wäre
+ */
+pagecache_page_t *pagecache_get(const void *owner, uint64_t index, pagecache_fill_t *fill, void *opaque);
+
+//Gibt eine mit pagecache_get reservierte Page frei
+void pagecache_put(pagecache_page_t *page);
+
+/*
+ * Überträgt geschriebene Daten in die Pages, die im Cache sind
+ * Parameter:	owner = Besitzer
+ * 				start = Anfangsbyte
+ * 				length = Anzahl Bytes
+ * 				buffer = geschriebene Daten
+ */
+void pagecache_update(const void *owner, uint64_t start, size_t length, const void *buffer);
+
+//Entfernt alle Pages von owner aus dem Cache. Verwendete Pages werden erst beim letzten pagecache_put freigegeben.
+void pagecache_purge(const void *owner);
+
+#endif /* PAGECACHE_H_ */
+
+#endif
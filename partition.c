@@ -31,12 +31,76 @@ static size_t partition_Read(partition_t *part, uint64_t start, size_t size, voi
 	return dmng_Read(part->dev, part->lbaStart + corrected_start, MIN(part->size - corrected_start, size), buffer);
 }
 
+/*
+ * Liest zusammenhängende Daten von einer Partition in mehrere Puffer
+ */
+static size_t partition_ReadVector(partition_t *part, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	size_t size = 0, i;
+
+	if(start >= part->size)
+		return 0;
+
+	for(i = 0; i < count; i++)
+		size += iov[i].length;
+	if(size <= part->size - start)
+		return dmng_ReadVector(part->dev, part->lbaStart + start, iov, count);
+
+	//Es wird nicht über das Ende der Partition hinaus gelesen
+	vfs_iovec_t *trimmed = malloc(count * sizeof(vfs_iovec_t));
+	if(trimmed == NULL)
+		return 0;
+	size_t remaining = part->size - start;
+	for(i = 0; i < count && remaining > 0; i++)
+	{
+		trimmed[i].base = iov[i].base;
+		trimmed[i].length = MIN(iov[i].length, remaining);
+		remaining -= trimmed[i].length;
+	}
+	size = dmng_ReadVector(part->dev, part->lbaStart + start, trimmed, i);
+	free(trimmed);
+	return size;
+}
+
 /*
  * Schreibt Daten auf eine Partition
  */
 static size_t partition_Write(partition_t *part, uint64_t start, size_t size, const void *buffer)
 {
-	return 0;
+	if(start >= part->size)
+		return 0;
+	return dmng_Write(part->dev, part->lbaStart + start, MIN(part->size - start, size), buffer);
+}
+
+/*
+ * Schreibt Daten aus mehreren Puffern zusammenhängend auf eine Partition
+ */
+static size_t partition_WriteVector(partition_t *part, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	size_t size = 0, i;
+
+	if(start >= part->size)
+		return 0;
+
+	for(i = 0; i < count; i++)
+		size += iov[i].length;
+	if(size <= part->size - start)
+		return dmng_WriteVector(part->dev, part->lbaStart + start, iov, count);
+
+	//Es wird nicht über das Ende der Partition hinaus geschrieben
+	vfs_iovec_t *trimmed = malloc(count * sizeof(vfs_iovec_t));
+	if(trimmed == NULL)
+		return 0;
+	size_t remaining = part->size - start;
+	for(i = 0; i < count && remaining > 0; i++)
+	{
+		trimmed[i].base = iov[i].base;
+		trimmed[i].length = MIN(iov[i].length, remaining);
+		remaining -= trimmed[i].length;
+	}
+	size = dmng_WriteVector(part->dev, part->lbaStart + start, trimmed, i);
+	free(trimmed);
+	return size;
 }
 
 /*
@@ -96,6 +160,8 @@ int partition_getPartitions(device_t *dev)
 			vfs_device_t* vfs_dev = malloc(sizeof(vfs_device_t));
 			vfs_dev->read = (vfs_device_read_handler_t*)partition_Read;
 			vfs_dev->write = (vfs_device_write_handler_t*)partition_Write;
+			vfs_dev->readv = (vfs_device_readv_handler_t*)partition_ReadVector;
+			vfs_dev->writev = (vfs_device_writev_handler_t*)partition_WriteVector;
 			vfs_dev->getValue = (vfs_device_getValue_handler_t*)partition_getValue;
 			vfs_dev->opaque = part;
 			vfs_RegisterDevice(vfs_dev);
@@ -162,13 +228,13 @@ struct cdi_fs_driver *getFSDriver(const char *name)
 {
 	struct cdi_driver *driver;
 
-	size_t i = 0;
+	cdi_list_iterator_t it;
 	extern cdi_list_t drivers;
-	while((driver = cdi_list_get(drivers, i)))
+	cdi_list_iterator_init(drivers, &it);
+	while((driver = cdi_list_iterator_next(&it)))
 	{
 		if(driver->type == CDI_FILESYSTEM && strcmp(name, driver->name) == 0)
 			return (struct cdi_fs_driver*)driver;
-		i++;
 	}
 
 	return NULL;
@@ -14,6 +14,12 @@
 #include "display.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "isr.h"
+#include "apic.h"
+#include "ioapic.h"
+#include "lock.h"
+#include "memory.h"
+#include "vmm.h"
 
 #define CONFIG_ADDRESS	0xCF8
 #define CONFIG_DATA		0xCFC
@@ -35,6 +41,29 @@
 #define PCI_BAR5        0x24
 #define PCI_CAPLIST     0x34
 #define PCI_IRQLINE     0x3C
+#define PCI_IRQPIN      0x3D
+
+#define PCI_COMMAND_INTX_DISABLE	(1 << 10)
+#define PCI_STATUS_CAPLIST			(1 << 4)
+
+//MSI Capability
+#define MSI_CONTROL			0x02
+#define MSI_ADDRESS			0x04
+#define MSI_ADDRESS_HIGH	0x08
+#define MSI_DATA_32			0x08
+#define MSI_DATA_64			0x0C
+#define MSI_CONTROL_ENABLE	(1 << 0)
+#define MSI_CONTROL_64BIT	(1 << 7)
+
+//MSI-X Capability
+#define MSIX_CONTROL		0x02
+#define MSIX_TABLE			0x04
+#define MSIX_CONTROL_MASK	(1 << 14)
+#define MSIX_CONTROL_ENABLE	(1 << 15)
+#define MSIX_ENTRY_SIZE		16
+
+//Adresse der MSI-Nachrichten, die Bits 12-19 enthalten die ID des Ziel-APICs
+#define MSI_ADDRESS_BASE	0xFEE00000
 
 #define PCIBUSES      256
 #define PCISLOTS    32
@@ -63,6 +92,9 @@
 
 list_t pciDevices;
 
+static bool msiUsed[NUM_MSI];
+static lock_t msiLock = LOCK_UNLOCKED;
+
 static bool checkDevice(uint8_t bus, uint8_t slot, uint8_t func)
 {
 	//Wenn VendorID != 0xFFFF, dann ist ein Gerät vorhanden
@@ -95,6 +127,11 @@ static pciDevice_t *initDevice(uint8_t bus, uint8_t slot, uint8_t func)
 	pciDevice->RevisionID = pci_readConfig(bus, slot, func, PCI_REVISION, 1);
 	pciDevice->HeaderType = pci_readConfig(bus, slot, func, PCI_HEADERTYPE, 1);
 	pciDevice->irq = pci_readConfig(bus, slot, func, PCI_IRQLINE, 1);
+	//IDE-Controller im Kompatibilitätsmodus benutzen die ISA-IRQs 14 und 15
+	bool ideCompat = pciDevice->ClassCode == 0x01 && pciDevice->Subclass == 0x01 && (pciDevice->ProgIF & 0x05) != 0x05;
+	if(pci_readConfig(bus, slot, func, PCI_IRQPIN, 1) != 0 && pciDevice->irq != 0xFF && !ideCompat)
+		ioapic_setPCIIRQ(pciDevice->irq);
+	pciDevice->msiIrq = pciDevice->msiCount = 0;
 
 	if((pciDevice->HeaderType & ~0x80) == 0x00 || (pciDevice->HeaderType & ~0x80) == 0x01)
 	{
@@ -243,6 +280,225 @@ void pci_Init()
 	printf("%u Geraete gefunden\n", list_size(pciDevices));
 }
 
+/*
+ * Sucht die Struktur zu einem PCI-Gerät
+ * Parameter:	bus, slot, func = Adresse des Geräts
+ * Rückgabe:	Gerät oder NULL, wenn es nicht existiert
+ */
+pciDevice_t *pci_getDevice(uint8_t bus, uint8_t slot, uint8_t func)
+{
+	pciDevice_t *pciDevice;
+	list_iterator_t it;
+	list_foreach(pciDevices, it, pciDevice)
+	{
+		if(pciDevice->Bus == bus && pciDevice->Slot == slot && pciDevice->Function == func)
+			return pciDevice;
+	}
+	return NULL;
+}
+
+/*
+ * Sucht eine Capability in der Capability-Liste eines Geräts
+ * Parameter:	device = Gerät
+ * 				id = ID der Capability (PCI_CAP_*)
+ * Rückgabe:	Offset der Capability im Konfigurationsraum, 0 wenn sie nicht vorhanden ist
+ */
+uint8_t pci_findCapability(pciDevice_t *device, uint8_t id)
+{
+	uint8_t offset;
+	uint8_t i;
+
+	if((device->HeaderType & ~0x80) > 0x01
+			|| !(pci_readConfig(device->Bus, device->Slot, device->Function, PCI_STATUS, 2) & PCI_STATUS_CAPLIST))
+		return 0;
+
+	offset = pci_readConfig(device->Bus, device->Slot, device->Function, PCI_CAPLIST, 1) & 0xFC;
+	//Es passen höchstens 48 Capabilities in den Konfigurationsraum, so endet auch eine kaputte Liste
+	for(i = 0; i < 48 && offset != 0; i++)
+	{
+		if(pci_readConfig(device->Bus, device->Slot, device->Function, offset, 1) == id)
+			return offset;
+		offset = pci_readConfig(device->Bus, device->Slot, device->Function, offset + 1, 1) & 0xFC;
+	}
+	return 0;
+}
+
+/*
+ * Reserviert zusammenhängende MSI-IRQs
+ * Parameter:	count = Anzahl IRQs
+ * 				align = Ausrichtung des ersten IRQs
+ * Rückgabe:	Index des ersten IRQs oder -1, wenn keine IRQs mehr frei sind
+ */
+static int allocMSI(uint8_t count, uint8_t align)
+{
+	int i, j;
+
+	lock(&msiLock);
+	for(i = 0; i + count <= NUM_MSI; i += align)
+	{
+		for(j = 0; j < count && !msiUsed[i + j]; j++);
+		if(j == count)
+		{
+			for(j = 0; j < count; j++)
+				msiUsed[i + j] = true;
+			unlock(&msiLock);
+			return i;
+		}
+	}
+	unlock(&msiLock);
+	return -1;
+}
+
+/*
+ * Gibt mit allocMSI reservierte IRQs wieder frei
+ * Parameter:	first = Index des ersten IRQs
+ * 				count = Anzahl IRQs
+ */
+static void freeMSI(int first, uint8_t count)
+{
+	int i;
+
+	lock(&msiLock);
+	for(i = 0; i < count; i++)
+		msiUsed[first + i] = false;
+	unlock(&msiLock);
+}
+
+//Die Nachrichten gehen vorerst alle an den APIC der aktuellen CPU
+static uint32_t msiAddress(void)
+{
+	return MSI_ADDRESS_BASE | ((uint32_t)apic_getID() << 12);
+}
+
+static int enableMSI(pciDevice_t *device, uint8_t cap, uint8_t count)
+{
+	uint16_t control = pci_readConfig(device->Bus, device->Slot, device->Function, cap + MSI_CONTROL, 2);
+	uint8_t log2 = 0;
+	int first;
+
+	//Das Gerät unterstützt bis zu 2^MMC Nachrichten, es können nur Zweierpotenzen zugewiesen werden
+	if(count > 1 << ((control >> 1) & 0x7))
+		count = 1 << ((control >> 1) & 0x7);
+	while((2 << log2) <= count)
+		log2++;
+	count = 1 << log2;
+
+	//Das Gerät setzt die unteren Bits der Daten auf die Nummer der Nachricht, deshalb muss der erste Vektor ausgerichtet sein
+	first = allocMSI(count, count);
+	if(first < 0)
+		return -1;
+
+	pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSI_ADDRESS, 4, msiAddress());
+	if(control & MSI_CONTROL_64BIT)
+	{
+		pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSI_ADDRESS_HIGH, 4, 0);
+		pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSI_DATA_64, 2, MSI_VECTOR_BASE + first);
+	}
+	else
+		pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSI_DATA_32, 2, MSI_VECTOR_BASE + first);
+
+	control = (control & ~(0x7 << 4)) | (log2 << 4) | MSI_CONTROL_ENABLE;
+	pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSI_CONTROL, 2, control);
+
+	device->msiCount = count;
+	return first;
+}
+
+static int enableMSIX(pciDevice_t *device, uint8_t cap, uint8_t count)
+{
+	uint16_t control = pci_readConfig(device->Bus, device->Slot, device->Function, cap + MSIX_CONTROL, 2);
+	uint32_t table = pci_readConfig(device->Bus, device->Slot, device->Function, cap + MSIX_TABLE, 4);
+	uint8_t bar = table & 0x7;
+	paddr_t phys;
+	size_t offset, pages, i;
+	void *virt;
+	volatile uint32_t *entry;
+	int first;
+
+	if(count > (control & 0x7FF) + 1)
+		count = (control & 0x7FF) + 1;
+
+	//Die Tabelle liegt in einer Speicher-BAR
+	if(bar < 6 && device->BAR[bar].Type == BAR_32)
+		phys = device->BAR[bar].Address;
+	else if(bar < 5 && device->BAR[bar].Type == BAR_64LO)
+		phys = device->BAR[bar].Address | ((paddr_t)device->BAR[bar + 1].Address << 32);
+	else
+		return -1;
+	phys += table & ~0x7;
+
+	first = allocMSI(count, 1);
+	if(first < 0)
+		return -1;
+
+	offset = phys % MM_BLOCK_SIZE;
+	pages = (offset + count * MSIX_ENTRY_SIZE + MM_BLOCK_SIZE - 1) / MM_BLOCK_SIZE;
+	virt = getFreePages((void*)KERNELSPACE_START, (void*)KERNELSPACE_END, pages);
+	if(virt == NULL)
+	{
+		freeMSI(first, count);
+		return -1;
+	}
+	for(i = 0; i < pages; i++)
+		vmm_Map(virt + i * MM_BLOCK_SIZE, phys - offset + i * MM_BLOCK_SIZE,
+				VMM_FLAGS_GLOBAL | VMM_FLAGS_NX | VMM_FLAGS_WRITE | VMM_FLAGS_NO_CACHE, 0);
+
+	//Alle Vektoren maskieren, solange die Tabelle beschrieben wird
+	pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSIX_CONTROL, 2,
+			control | MSIX_CONTROL_ENABLE | MSIX_CONTROL_MASK);
+	entry = virt + offset;
+	for(i = 0; i < count; i++, entry += MSIX_ENTRY_SIZE / sizeof(uint32_t))
+	{
+		entry[0] = msiAddress();
+		entry[1] = 0;
+		entry[2] = MSI_VECTOR_BASE + first + i;
+		entry[3] = 0;		//Vektor nicht mehr maskieren
+	}
+	pci_writeConfig(device->Bus, device->Slot, device->Function, cap + MSIX_CONTROL, 2,
+			(control | MSIX_CONTROL_ENABLE) & ~MSIX_CONTROL_MASK);
+	vmm_SysUnMap(virt, pages);
+
+	device->msiCount = count;
+	return first;
+}
+
+/*
+ * Schaltet ein Gerät auf MSI-X bzw. MSI um. Jeder Vektor bekommt einen eigenen IRQ, so dass z.B.
+ * jede Queue eines Geräts einen eigenen Interrupt auslösen kann. Der Legacy-IRQ wird abgeschaltet.
+ * Parameter:	device = Gerät
+ * 				count = Gewünschte Anzahl Vektoren
+ * Rückgabe:	Erster IRQ (die weiteren folgen direkt darauf) oder -1, wenn das Gerät den Legacy-IRQ
+ * 				benutzen muss. Die Anzahl zugewiesener IRQs steht danach in device->msiCount.
+ */
+int pci_enableMSI(pciDevice_t *device, uint8_t count)
+{
+	uint8_t cap;
+	int first;
+
+	//MSIs werden vom Local APIC empfangen
+	if(count == 0 || !apic_available())
+		return -1;
+	if(device->msiCount > 0)
+		return NUM_IRQ + device->msiIrq;
+	if(count > NUM_MSI)
+		count = NUM_MSI;
+
+	//Wenn MSI-X nicht eingerichtet werden kann, wird MSI und danach der Legacy-IRQ versucht
+	first = -1;
+	if((cap = pci_findCapability(device, PCI_CAP_MSIX)) != 0)
+		first = enableMSIX(device, cap, count);
+	if(first < 0 && (cap = pci_findCapability(device, PCI_CAP_MSI)) != 0)
+		first = enableMSI(device, cap, count);
+	if(first < 0)
+		return -1;
+	device->msiIrq = first;
+
+	pci_writeConfig(device->Bus, device->Slot, device->Function, PCI_COMMAND, 2,
+			pci_readConfig(device->Bus, device->Slot, device->Function, PCI_COMMAND, 2) | PCI_COMMAND_INTX_DISABLE);
+
+	return NUM_IRQ + first;
+}
+
 uint32_t pci_readConfig(uint8_t bus, uint8_t slot, uint8_t func, uint8_t reg, uint8_t length)
 {
 	uint32_t Data = 0;
@@ -14,6 +14,10 @@
 #include "stddef.h"
 #include "list.h"
 
+//IDs der Capabilities
+#define PCI_CAP_MSI		0x05
+#define PCI_CAP_MSIX	0x11
+
 typedef enum{
 	BAR_UNDEFINED, BAR_INVALID, BAR_UNUSED, BAR_32, BAR_64LO, BAR_64HI, BAR_IO
 }TYPE_t;
@@ -29,6 +33,7 @@ typedef struct{
 		uint16_t DeviceID, VendorID;
 		uint8_t ClassCode, Subclass, RevisionID, ProgIF, HeaderType;
 		uint8_t irq;
+		uint8_t msiIrq, msiCount;	//Erster MSI-IRQ und Anzahl der MSI-IRQs (0 wenn der Legacy-IRQ benutzt wird)
 		pciBar_t BAR[6];
 }pciDevice_t;
 
@@ -37,6 +42,9 @@ extern list_t pciDevices;
 void pci_Init();
 uint32_t pci_readConfig(uint8_t bus, uint8_t slot, uint8_t func, uint8_t reg, uint8_t length);
 void pci_writeConfig(uint8_t bus, uint8_t slot, uint8_t func, uint8_t reg, uint8_t length, uint32_t Data);
+pciDevice_t *pci_getDevice(uint8_t bus, uint8_t slot, uint8_t func);
+uint8_t pci_findCapability(pciDevice_t *device, uint8_t id);
+int pci_enableMSI(pciDevice_t *device, uint8_t count);
 
 #endif /* PCI_H_ */
 
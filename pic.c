@@ -24,6 +24,9 @@
 //EOI
 #define EOI					0x20
 
+//OCW3: In Service Register lesen
+#define READ_ISR			0x0B
+
 /*
  * Intitialisiert den PIC
  */
@@ -65,7 +68,7 @@ void pic_Remap(uint8_t Interrupt)
 void pic_MaskIRQ(uint16_t Mask)
 {
 	outb(PIC_MASTER_IMR, (uint8_t)Mask);
-	outb(PIC_SLAVE_IMR, (uint8_t)Mask >> 8);
+	outb(PIC_SLAVE_IMR, (uint8_t)(Mask >> 8));
 }
 
 /*
@@ -79,4 +82,31 @@ void pic_SendEOI(uint8_t irq)
 		outb(PIC_SLAVE_COMMAND, EOI);
 }
 
+/*
+ * Prüft, ob ein IRQ 7 bzw. 15 nur durch eine Störung ausgelöst wurde. Dann ist das entsprechende
+ * Bit im In Service Register nicht gesetzt und es darf kein EOI an den PIC gesendet werden, der
+ * den IRQ ausgelöst hat. Der Master hat aber bei einem falschen IRQ 15 den Slave bedient und
+ * braucht trotzdem einen EOI.
+ * Parameter:	irq = IRQ-Nummer
+ * Rückgabe:	true, wenn der IRQ falsch war
+ */
+bool pic_isSpurious(uint8_t irq)
+{
+	if(irq == 7)
+	{
+		outb(PIC_MASTER_COMMAND, READ_ISR);
+		return !(inb(PIC_MASTER_COMMAND) & 0x80);
+	}
+	if(irq == 15)
+	{
+		outb(PIC_SLAVE_COMMAND, READ_ISR);
+		if(!(inb(PIC_SLAVE_COMMAND) & 0x80))
+		{
+			outb(PIC_MASTER_COMMAND, EOI);
+			return true;
+		}
+	}
+	return false;
+}
+
 #endif
@@ -11,11 +11,13 @@
 #define PIC_H_
 
 #include "stdint.h"
+#include "stdbool.h"
 
 void pic_Init(void);
 void pic_Remap(uint8_t Interrupt);
 void pic_MaskIRQ(uint16_t Mask);
 void pic_SendEOI(uint8_t irq);
+bool pic_isSpurious(uint8_t irq);
 
 #endif /* PIC_H_ */
 
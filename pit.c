@@ -9,7 +9,7 @@
 
 #include "pit.h"
 #include "util.h"
-#include "list.h"
+#include "ilist.h"
 #include "stdlib.h"
 #include "scheduler.h"
 #include "lock.h"
@@ -22,19 +22,14 @@
 
 #define FRQB	1193182
 
-typedef struct{
-	thread_t *thread;
-	uint64_t timeout;
-}timer_t;
-
-static list_t Timerlist;
-static lock_t Timerlist_lock = LOCK_UNLOCKED;
+static ilist_t Timerlist = ILIST_INIT(Timerlist);
+static spinlock_t Timerlist_lock = SPINLOCK_UNLOCKED;
+static seqlock_t Uptime_seq = SEQLOCK_INIT;
 
 void pit_Init(uint32_t freq)
 {
 	pit_InitChannel(0, 2, (uint64_t)(FRQB / freq));
 
-	Timerlist = NULL;
 	Uptime = 0;
 }
 
@@ -46,36 +41,43 @@ void pit_InitChannel(uint8_t channel, uint8_t mode, uint16_t data)
 	outb(CH_BASE + channel, data >> 8);
 }
 
-//Registriert einen Timer
-void pit_RegisterTimer(thread_t *thread, uint64_t msec)
+//Fügt einen Timer in die Timerliste ein. Timerlist_lock muss gehalten werden.
+static void insertTimer(pit_timer_t *Timer, uint64_t msec)
 {
-	if(msec != 0)
-	{
-		timer_t *Timer;
-		size_t i;
-		uint64_t t;
+	ilist_node_t *node;
+	uint64_t t;
 
-		Timer = malloc(sizeof(timer_t));
+	Timer->timeout = ((t = pit_getUptime() + msec) < msec) ? -1ul : t;
+	Timer->pending = true;
 
-		Timer->thread = thread;
-		Timer->timeout = ((t = Uptime + msec) < Uptime) ? -1ul : t;
+	//Timerliste sortiere, sodass das Element vorne immer das Element ist, welches
+	//zuerst abläuft
+	ilist_foreach(node, &Timerlist)
+	{
+		if(ILIST_ENTRY(node, pit_timer_t, node)->timeout > Timer->timeout)
+			break;
+	}
 
-		lock(&Timerlist_lock);
-		if(Timerlist == NULL)
-			Timerlist = list_create();
+	ilist_insert_before(&Timerlist, node, &Timer->node);
+}
 
-		//Timerliste sortiere, sodass das Element vorne immer das Element ist, welches
-		//zuerst abläuft
-		timer_t *item;
-		for(i = 0; (item = list_get(Timerlist, i)); i++)
-		{
-			if(item->timeout > Timer->timeout)
-				break;
-		}
+//Registriert einen Timer
+void pit_RegisterTimer(thread_t *thread, uint64_t msec)
+{
+	if(msec != 0)
+	{
+		pit_timer_t *Timer;
+		uint64_t flags;
 
-		list_insert(Timerlist, i, Timer);
+		//Timer ohne callback wecken den Thread in opaque auf
+		Timer = malloc(sizeof(pit_timer_t));
+		Timer->callback = NULL;
+		Timer->opaque = thread;
 
-		unlock(&Timerlist_lock);
+		//Der Timer-IRQ darf nicht dazwischen kommen, während die Liste verändert wird
+		flags = spin_lock_irqsave(&Timerlist_lock);
+		insertTimer(Timer, msec);
+		spin_unlock_irqrestore(&Timerlist_lock, flags);
 
 		//Entsprechenden Thread schlafen legen
 		thread_block(thread);
@@ -85,22 +87,88 @@ void pit_RegisterTimer(thread_t *thread, uint64_t msec)
 	yield();
 }
 
+/*
+ * Startet einen Timer, der nach msec Millisekunden timer->callback aufruft
+ * Parameter:	timer = Timer, callback und opaque müssen gesetzt sein. Er darf nicht bereits laufen.
+ * 				msec = Zeit bis zum Ablauf in Millisekunden
+ */
+void pit_StartTimer(pit_timer_t *timer, uint64_t msec)
+{
+	uint64_t flags = spin_lock_irqsave(&Timerlist_lock);
+	insertTimer(timer, msec);
+	spin_unlock_irqrestore(&Timerlist_lock, flags);
+}
+
+/*
+ * Hält einen mit pit_StartTimer gestarteten Timer an
+ * Parameter:	timer = Timer
+ * Rückgabe:	true, wenn der Timer noch nicht abgelaufen war. Bei false wird callback
+ * 				aufgerufen oder wurde bereits aufgerufen.
+ */
+bool pit_StopTimer(pit_timer_t *timer)
+{
+	bool pending;
+	uint64_t flags = spin_lock_irqsave(&Timerlist_lock);
+	if((pending = timer->pending))
+	{
+		ilist_remove(&Timerlist, &timer->node);
+		timer->pending = false;
+	}
+	spin_unlock_irqrestore(&Timerlist_lock, flags);
+	return pending;
+}
+
 void pit_Handler(void)
 {
-	timer_t *Timer;
-	size_t i = 0;
+	ilist_node_t *node;
+	seq_write_begin(&Uptime_seq);
 	Uptime++;
-	if(Timerlist)
+	seq_write_end(&Uptime_seq);
+
+	//Wenn die Liste gerade (auf einer anderen CPU) bearbeitet wird, werden die Timer beim nächsten Tick geprüft
+	if(!spin_trylock(&Timerlist_lock))
+		return;
+
+	//Abgelaufene Timer liegen immer am Anfang der Liste
+	while((node = ilist_first(&Timerlist)))
 	{
-		while((Timer = list_get(Timerlist, i)))
+		pit_timer_t *Timer = ILIST_ENTRY(node, pit_timer_t, node);
+		if(Timer->timeout > Uptime)
+			break;
+		ilist_remove(&Timerlist, node);
+		Timer->pending = false;
+		if(Timer->callback == NULL)
 		{
-			if(Timer->timeout > Uptime)
-				break;
-			thread_unblock(Timer->thread);
-			free(list_remove(Timerlist, i));
-			i++;
+			thread_unblock(Timer->opaque);
+			free(Timer);
 		}
+		else
+		{
+			//Der Callback darf selbst Timer starten oder anhalten
+			spin_unlock(&Timerlist_lock);
+			Timer->callback(Timer->opaque);
+			if(!spin_trylock(&Timerlist_lock))
+				return;
+		}
+	}
+
+	spin_unlock(&Timerlist_lock);
+}
+
+/*
+ * Gibt die Zeit seit dem Start zurück. Kann von überall aus aufgerufen werden.
+ * Rückgabe:	Zeit in Millisekunden
+ */
+uint64_t pit_getUptime(void)
+{
+	uint64_t seq, uptime;
+	do
+	{
+		seq = seq_read_begin(&Uptime_seq);
+		uptime = Uptime;
 	}
+	while(seq_read_retry(&Uptime_seq, seq));
+	return uptime;
 }
 
 #endif
@@ -11,13 +11,30 @@
 #define PIT_H_
 
 #include "stdint.h"
+#include "stdbool.h"
 #include "thread.h"
+#include "ilist.h"
+
+/*
+ * Timer, der nach Ablauf callback aufruft. Der Speicher gehört dem Aufrufer. callback wird im
+ * Timerinterrupt aufgerufen und darf deshalb nicht warten.
+ */
+typedef struct{
+	void (*callback)(void *opaque);
+	void *opaque;
+	uint64_t timeout;
+	ilist_node_t node;
+	bool pending;
+}pit_timer_t;
 
 volatile uint64_t Uptime;						//Zeit in Milisekunden seit dem Starten des Computers
 
 void pit_Init(uint32_t freq);
 void pit_RegisterTimer(thread_t *thread, uint64_t msec);
+void pit_StartTimer(pit_timer_t *timer, uint64_t msec);
+bool pit_StopTimer(pit_timer_t *timer);
 void pit_InitChannel(uint8_t channel, uint8_t mode, uint16_t data);
+uint64_t pit_getUptime(void);
 
 #endif /* PIT_H_ */
 
@@ -0,0 +1,152 @@
+/*
+ * pmu.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "pmu.h"
+#include "cpu.h"
+#include "lock.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "vfs.h"
+#include "stdio.h"
+#include "string.h"
+
+#define IA32_PMC0				0xC1
+#define IA32_PERFEVTSEL0		0x186
+#define IA32_PERF_GLOBAL_CTRL	0x38F
+
+#define PERFEVTSEL_USR			(1 << 16)	//Im Userspace zählen
+#define PERFEVTSEL_OS			(1 << 17)	//Im Kernel zählen
+#define PERFEVTSEL_EN			(1 << 22)
+
+//Architekturdefinierte Ereignisse. Ereignis n wird auf dem allgemeinen Zähler n gezählt.
+static const struct{
+	const char *name;
+	uint8_t event;
+	uint8_t umask;
+	uint8_t cpuid_bit;		//Bit in CPUID.0AH:EBX, das gesetzt ist, wenn das Ereignis nicht verfügbar ist
+}pmu_events[PMC_MAX] = {
+	[PMC_CYCLES] = {"cycles", 0x3C, 0x00, 0},
+	[PMC_INSTRUCTIONS] = {"instructions", 0xC0, 0x00, 1},
+	[PMC_CACHE_MISSES] = {"cache misses", 0x2E, 0x41, 4},
+	[PMC_BRANCH_MISSES] = {"branch misses", 0xC5, 0x00, 6}
+};
+
+static struct{
+	uint8_t version;
+	uint8_t counters;		//Anzahl allgemeiner Zähler
+	uint8_t width;			//Breite der Zähler in Bits
+	uint32_t valid;			//Bit n ist gesetzt, wenn pmu_events[n] gezählt wird
+	uint64_t mask;
+}pmu;
+
+static spinlock_t pmu_lock = SPINLOCK_UNLOCKED;
+
+static size_t pmu_infoRead(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	char text[256];
+	pmc_event_t event;
+
+	size_t size = sprintf(text, "version: %u\ncounters: %u\nwidth: %u\n", pmu.version, pmu.counters, pmu.width);
+	for(event = 0; event < PMC_MAX; event++)
+		size += sprintf(text + size, "%s: %s\n", pmu_events[event].name, (pmu.valid & (1u << event)) ? "yes" : "no");
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	return read;
+}
+
+void pmu_Init(void)
+{
+	pmc_event_t event;
+
+	vfs_RegisterInfoFile("pmu", pmu_infoRead, NULL);
+
+	//CPUID 0xA gibt es nur bei Intel
+	if(!cpuInfo.cpuidAvailable || !cpuInfo.msrAvailable || cpuInfo.maxstdCPUID < 0xA)
+		return;
+
+	uint32_t eax = cpu_CPUID(0xA, EAX);
+	uint32_t ebx = cpu_CPUID(0xA, EBX);
+	pmu.version = eax & 0xFF;
+	if(pmu.version == 0)
+		return;
+	pmu.counters = (eax >> 8) & 0xFF;
+	pmu.width = (eax >> 16) & 0xFF;
+	uint8_t ebxLength = (eax >> 24) & 0xFF;
+	pmu.mask = (pmu.width >= 64) ? ~0ul : (1ul << pmu.width) - 1;
+
+	for(event = 0; event < PMC_MAX; event++)
+	{
+		if(event >= pmu.counters || pmu_events[event].cpuid_bit >= ebxLength || (ebx & (1u << pmu_events[event].cpuid_bit)))
+			continue;
+		pmu.valid |= 1u << event;
+
+		cpu_MSRwrite(IA32_PERFEVTSEL0 + event, 0);
+		cpu_MSRwrite(IA32_PMC0 + event, 0);
+		cpu_MSRwrite(IA32_PERFEVTSEL0 + event, pmu_events[event].event | (pmu_events[event].umask << 8)
+				| PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_EN);
+	}
+
+	//Ab Version 2 müssen die Zähler zusätzlich global eingeschaltet werden
+	if(pmu.version >= 2)
+		cpu_MSRwrite(IA32_PERF_GLOBAL_CTRL, cpu_MSRread(IA32_PERF_GLOBAL_CTRL) | pmu.valid);
+}
+
+void pmu_switch(thread_t *prev)
+{
+	pmc_event_t event;
+
+	if(pmu.valid == 0)
+		return;
+
+	for(event = 0; event < PMC_MAX; event++)
+	{
+		if(!(pmu.valid & (1u << event)))
+			continue;
+		if(prev != NULL)
+			prev->pmc[event] += cpu_MSRread(IA32_PMC0 + event) & pmu.mask;
+		cpu_MSRwrite(IA32_PMC0 + event, 0);
+	}
+}
+
+void pmu_read(thread_t *thread, pmc_values_t *values)
+{
+	pmc_event_t event;
+
+	//Während dem Lesen darf kein Threadwechsel stattfinden
+	uint64_t flags = spin_lock_irqsave(&pmu_lock);
+	for(event = 0; event < PMC_MAX; event++)
+	{
+		values->value[event] = thread->pmc[event];
+		if(thread == currentThread && (pmu.valid & (1u << event)))
+			values->value[event] += cpu_MSRread(IA32_PMC0 + event) & pmu.mask;
+	}
+	spin_unlock_irqrestore(&pmu_lock, flags);
+
+	values->valid = pmu.valid;
+	values->version = pmu.version;
+}
+
+int64_t pmu_syscall_read(pmc_values_t *values)
+{
+	pmc_values_t tmp;
+
+	if((uintptr_t)values < USERSPACE_START || (uintptr_t)values > USERSPACE_END - sizeof(pmc_values_t))
+		return -1;
+
+	pmu_read(currentThread, &tmp);
+	memcpy(values, &tmp, sizeof(pmc_values_t));
+	return 0;
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * pmu.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef PMU_H_
+#define PMU_H_
+
+#include "stdint.h"
+#include "pmc.h"
+#include "thread.h"
+
+/*
+ * Leistungszähler der CPU (Architectural Performance Monitoring, CPUID 0xA). Die Zähler werden
+ * pro Thread virtualisiert: Beim Threadwechsel werden die Hardwarezähler zum alten Thread addiert
+ * und für den neuen Thread auf 0 gesetzt.
+ * Welche Zähler unterstützt werden, ist unter /sysinf/pmu abrufbar.
+ */
+
+void pmu_Init(void);
+
+//Wird vom Scheduler beim Threadwechsel mit dem bisherigen Thread (kann NULL sein) aufgerufen
+void pmu_switch(thread_t *prev);
+
+/*
+ * Liest die Zähler eines Threads
+ * Parameter:	thread = Thread
+ * 				values = Speicher für die Zählerstände
+ */
+void pmu_read(thread_t *thread, pmc_values_t *values);
+
+/*
+ * Syscall: Liest die Zähler des aktuellen Threads
+ * Parameter:	values = Speicher für die Zählerstände im Userspace
+ * Rückgabe:	0 bei Erfolg, -1 bei ungültiger Adresse
+ */
+int64_t pmu_syscall_read(pmc_values_t *values);
+
+#endif /* PMU_H_ */
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ * profile.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "profile.h"
+#include "ksym.h"
+#include "lock.h"
+#include "lockstat.h"
+#include "vmm.h"
+#include "memory.h"
+#include "vfs.h"
+#include "scheduler.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define PROFILE_SAMPLES		8192	//Maximale Anzahl Samples, danach werden weitere verworfen
+#define PROFILE_DEPTH		8		//Maximale Länge der Aufrufkette
+
+typedef struct{
+	uint64_t rip;
+	uint32_t pid;
+	uint32_t tid;
+	uint8_t user;					//true, wenn der Userspace unterbrochen wurde
+	uint8_t depth;					//Anzahl gültiger Einträge in chain
+	uint64_t chain[PROFILE_DEPTH];	//Rücksprungadressen, innerste zuerst
+}profile_sample_t;
+
+static struct{
+	profile_sample_t *samples;
+	size_t count;
+	uint64_t dropped;
+	uint32_t interval;				//Jeder wievielte Tick aufgezeichnet wird
+	uint32_t ticks;
+	volatile bool running;
+}profile;
+
+static spinlock_t profile_lock = SPINLOCK_UNLOCKED;		//Schützt profile, wird vom Timerinterrupt genommen
+static lock_t profile_ctl_lock = LOCK_UNLOCKED;			//Serialisiert Auswertung und Steuerung
+
+//Ein Frame ist nur gültig, wenn er ganz in einer gemappten Kernelpage liegt
+static bool validFrame(const uint64_t *rbp)
+{
+	uintptr_t address = (uintptr_t)rbp;
+	return address >= KERNELSPACE_START && address + 2 * sizeof(uint64_t) <= KERNELSPACE_END && (address & 0x7) == 0
+			&& (address % MM_BLOCK_SIZE) <= MM_BLOCK_SIZE - 2 * sizeof(uint64_t) && vmm_getPhysAddress((void*)rbp) != 0;
+}
+
+static void takeSample(profile_sample_t *sample, ihs_t *ihs)
+{
+	sample->rip = ihs->rip;
+	sample->pid = (currentProcess != NULL) ? currentProcess->PID : 0;
+	sample->tid = (currentThread != NULL) ? currentThread->tid : 0;
+	sample->user = (ihs->cs & 3) == 3;
+	sample->depth = 0;
+
+	//Die Aufrufkette wird nur im Kernel verfolgt, der Userstack kann ausgelagert sein
+	if(!sample->user)
+	{
+		const uint64_t *rbp = (const uint64_t*)ihs->rbp;
+		while(sample->depth < PROFILE_DEPTH && validFrame(rbp) && rbp[1] != 0)
+		{
+			sample->chain[sample->depth++] = rbp[1];
+			//Der Stack wächst nach unten, ein Frame eines Aufrufers liegt immer höher
+			if(rbp[0] <= (uintptr_t)rbp)
+				break;
+			rbp = (const uint64_t*)rbp[0];
+		}
+	}
+}
+
+void profile_tick(ihs_t *ihs)
+{
+	if(!profile.running)
+		return;
+
+	spin_lock(&profile_lock);
+	if(profile.running && ++profile.ticks >= profile.interval)
+	{
+		profile.ticks = 0;
+		if(profile.count < PROFILE_SAMPLES)
+			takeSample(&profile.samples[profile.count++], ihs);
+		else
+			profile.dropped++;
+	}
+	spin_unlock(&profile_lock);
+}
+
+/*
+ * Ordnet eine Adresse einem Eintrag im Profil zu. Die Einträge 0 bis nsyms - 1 sind die Symbole,
+ * danach folgen unbekannte Kerneladressen und der Userspace.
+ */
+static size_t profileEntry(uint64_t address, bool user, size_t nsyms)
+{
+	if(user)
+		return nsyms + 1;
+	size_t index = ksym_find(address);
+	return (index == KSYM_UNKNOWN) ? nsyms : index;
+}
+
+static const char *entryName(size_t entry, size_t nsyms)
+{
+	if(entry < nsyms)
+		return ksym_get(entry)->name;
+	return (entry == nsyms) ? "[kernel]" : "[user]";
+}
+
+//Nach Samples im Symbol selbst absteigend sortieren, dann nach Samples inklusive Aufgerufenen
+static int compareEntries(const void *a, const void *b, void *context)
+{
+	const uint64_t (*counts)[2] = context;
+	size_t x = *(const size_t*)a, y = *(const size_t*)b;
+	if(counts[x][0] != counts[y][0])
+		return (counts[x][0] < counts[y][0]) ? 1 : -1;
+	if(counts[x][1] != counts[y][1])
+		return (counts[x][1] < counts[y][1]) ? 1 : -1;
+	return 0;
+}
+
+static size_t profile_read(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	size_t nsyms = ksym_count();
+	size_t entries = nsyms + 2;
+	size_t i, j, k;
+
+	uint64_t (*counts)[2] = calloc(entries, sizeof(*counts));	//[0] = im Symbol selbst, [1] = inklusive Aufgerufenen
+	size_t *order = malloc(entries * sizeof(size_t));
+	if(counts == NULL || order == NULL)
+	{
+		free(counts);
+		free(order);
+		return 0;
+	}
+
+	lock(&profile_ctl_lock);
+	uint64_t flags = spin_lock_irqsave(&profile_lock);
+	size_t count = profile.count;
+	uint64_t dropped = profile.dropped;
+	uint32_t interval = profile.interval;
+	bool running = profile.running;
+	spin_unlock_irqrestore(&profile_lock, flags);
+
+	//Samples unterhalb von count werden erst durch "reset" wieder verändert
+	for(i = 0; i < count; i++)
+	{
+		const profile_sample_t *sample = &profile.samples[i];
+		size_t seen[PROFILE_DEPTH + 1];
+		size_t nseen = 0;
+
+		size_t entry = profileEntry(sample->rip, sample->user, nsyms);
+		counts[entry][0]++;
+		counts[entry][1]++;
+		seen[nseen++] = entry;
+
+		//Rekursive Aufrufe werden pro Sample nur einmal gezählt
+		for(j = 0; j < sample->depth; j++)
+		{
+			entry = profileEntry(sample->chain[j] - 1, false, nsyms);
+			for(k = 0; k < nseen && seen[k] != entry; k++);
+			if(k == nseen)
+			{
+				counts[entry][1]++;
+				seen[nseen++] = entry;
+			}
+		}
+	}
+	unlock(&profile_ctl_lock);
+
+	size_t used = 0;
+	size_t textSize = 256;
+	for(i = 0; i < entries; i++)
+	{
+		if(counts[i][1] == 0)
+			continue;
+		order[used++] = i;
+		//Zwei Zahlen mit höchstens 20 und zwei Prozentangaben mit höchstens 7 Zeichen
+		textSize += 64 + strlen(entryName(i, nsyms));
+	}
+	qsort_s(order, used, sizeof(size_t), compareEntries, counts);
+
+	char *text = malloc(textSize);
+	if(text == NULL)
+	{
+		free(counts);
+		free(order);
+		return 0;
+	}
+
+	size_t size = sprintf(text, "samples: %lu\ndropped: %lu\ninterval: %u\nrunning: %s\nsymbols: %lu\n\n%20s %7s %20s %7s  %s\n",
+			count, dropped, interval, running ? "yes" : "no", nsyms, "self", "%", "total", "%", "symbol");
+	for(i = 0; i < used; i++)
+	{
+		size_t entry = order[i];
+		uint64_t self = counts[entry][0] * 1000 / count;
+		uint64_t total = counts[entry][1] * 1000 / count;
+		size += sprintf(text + size, "%20lu %5lu.%lu %20lu %5lu.%lu  %s\n", counts[entry][0], self / 10, self % 10,
+				counts[entry][1], total / 10, total % 10, entryName(entry, nsyms));
+	}
+	free(counts);
+	free(order);
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	free(text);
+	return read;
+}
+
+static size_t profile_write(const char *name, uint64_t start, size_t length, const void *buffer)
+{
+	char cmd[32];
+	size_t len = (length < sizeof(cmd) - 1) ? length : sizeof(cmd) - 1;
+	memcpy(cmd, buffer, len);
+	cmd[len] = '\0';
+
+	lock(&profile_ctl_lock);
+	uint64_t flags = spin_lock_irqsave(&profile_lock);
+	if(strncmp(cmd, "start", 5) == 0)
+	{
+		int interval = atoi(cmd + 5);
+		profile.interval = (interval > 0) ? interval : 1;
+		profile.ticks = 0;
+		profile.running = (profile.samples != NULL);
+	}
+	else if(strncmp(cmd, "stop", 4) == 0)
+		profile.running = false;
+	else if(strncmp(cmd, "reset", 5) == 0)
+	{
+		profile.count = 0;
+		profile.dropped = 0;
+	}
+	else
+		length = 0;
+	spin_unlock_irqrestore(&profile_lock, flags);
+	unlock(&profile_ctl_lock);
+
+	return length;
+}
+
+void profile_Init(void)
+{
+	size_t pages = (PROFILE_SAMPLES * sizeof(profile_sample_t) + MM_BLOCK_SIZE - 1) / MM_BLOCK_SIZE;
+	profile.samples = vmm_SysAlloc(pages);
+	if(profile.samples == NULL)
+		printf("profile: Konnte keinen Speicher für die Samples reservieren\n");
+	profile.interval = 1;
+
+	lockstat_register(&profile_ctl_lock, "profile");
+	vfs_RegisterInfoFile("profile", profile_read, profile_write);
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * profile.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "isr.h"
+
+/*
+ * Profiler, der bei jedem n-ten Timerinterrupt die unterbrochene Adresse, den Prozess, den Thread
+ * und die Aufrufkette (über die Framepointer, nur im Kernel) speichert. Das Ergebnis wird mit
+ * der Symboltabelle (ksym.h) aufgelöst und als flaches Profil unter /sysinf/profile ausgegeben.
+ * Gesteuert wird der Profiler durch Schreiben nach /sysinf/profile:
+ * "start [n]" startet die Aufzeichnung (jeder n-te Tick, Standard 1), "stop" hält sie an und
+ * "reset" löscht die gesammelten Samples.
+ */
+
+void profile_Init(void);
+
+//Wird vom Timerinterrupt mit dem unterbrochenen Zustand aufgerufen
+void profile_tick(ihs_t *ihs);
+
+#endif /* PROFILE_H_ */
+
+#endif
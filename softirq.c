@@ -0,0 +1,72 @@
+/*
+ * softirq.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "softirq.h"
+
+#define SOFTIRQ_RESTARTS	10	//So oft wird nach neu angeforderten Softirqs geschaut, der Rest läuft beim nächsten IRQ
+
+static void (*softirq_handlers[SOFTIRQ_MAX])(void);
+static volatile uint32_t softirq_pending = 0;
+static uint64_t irq_depth = 0;			//Verschachtelungstiefe der IRQ-Handler
+static bool softirq_running = false;
+
+void softirq_register(softirq_t nr, void (*handler)(void))
+{
+	if(nr < SOFTIRQ_MAX)
+		softirq_handlers[nr] = handler;
+}
+
+void softirq_raise(softirq_t nr)
+{
+	if(nr < SOFTIRQ_MAX)
+		__sync_fetch_and_or(&softirq_pending, 1u << nr);
+}
+
+bool softirq_inIRQ(void)
+{
+	return irq_depth > 0;
+}
+
+bool softirq_active(void)
+{
+	return softirq_running;
+}
+
+void softirq_irqEnter(void)
+{
+	irq_depth++;
+}
+
+void softirq_irqExit(ihs_t *ihs)
+{
+	size_t restarts;
+
+	irq_depth--;
+	//Nur im äussersten Handler und nur, wenn der unterbrochene Code Interrupts zugelassen hat
+	if(irq_depth > 0 || softirq_running || softirq_pending == 0 || !(ihs->rflags & 0x200))
+		return;
+
+	softirq_running = true;
+	for(restarts = 0; restarts < SOFTIRQ_RESTARTS && softirq_pending; restarts++)
+	{
+		uint32_t pending = __sync_fetch_and_and(&softirq_pending, 0);
+		size_t i;
+
+		asm volatile("sti");
+		for(i = 0; i < SOFTIRQ_MAX; i++)
+		{
+			if((pending & (1u << i)) && softirq_handlers[i] != NULL)
+				softirq_handlers[i]();
+		}
+		asm volatile("cli");
+	}
+	softirq_running = false;
+}
+
+#endif
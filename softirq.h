@@ -0,0 +1,53 @@
+/*
+ * softirq.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef SOFTIRQ_H_
+#define SOFTIRQ_H_
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+#include "isr.h"
+
+/*
+ * Softirqs sind kurze Handler, die ein Interrupthandler anfordert und die direkt nach dem Interrupt
+ * (nach dem EOI) mit eingeschalteten Interrupts ausgeführt werden. Sie dürfen nicht blockieren und
+ * während sie laufen, wird kein Taskwechsel durchgeführt. Für längere Arbeit gibt es die
+ * Warteschlangen (workqueue.h).
+ */
+
+typedef enum{
+	SOFTIRQ_STORAGE,		//Abgeschlossene Anfragen an Blockgeräte
+	SOFTIRQ_MAX
+}softirq_t;
+
+void softirq_register(softirq_t nr, void (*handler)(void));
+
+//Fordert einen Softirq an. Darf auch ausserhalb von Interrupts aufgerufen werden.
+void softirq_raise(softirq_t nr);
+
+//true, während ein Hardware-Interrupthandler läuft
+bool softirq_inIRQ(void);
+
+//true, während Softirqs ausgeführt werden
+bool softirq_active(void);
+
+//Wird am Anfang eines IRQ-Handlers aufgerufen
+void softirq_irqEnter(void);
+
+/*
+ * Wird am Ende eines IRQ-Handlers nach dem EOI aufgerufen und führt im äussersten Handler die
+ * angeforderten Softirqs aus
+ * Parameter:	ihs = Zustand des unterbrochenen Codes
+ */
+void softirq_irqExit(ihs_t *ihs);
+
+#endif /* SOFTIRQ_H_ */
+
+#endif
@@ -21,6 +21,10 @@
 #include "scheduler.h"
 #include "cleaner.h"
 #include "assert.h"
+#include "futex.h"
+#include "aio.h"
+#include "trace.h"
+#include "pmu.h"
 
 #define STAR	0xC0000081
 #define LSTAR	0xC0000082
@@ -44,8 +48,8 @@ static syscall syscalls[] = {
 		(syscall)&mm_Alloc,				//0
 		(syscall)&mm_Free,				//1
 		(syscall)&vmm_unusePages,		//2
-		(syscall)&nop,
-		(syscall)&nop,
+		(syscall)&vfs_syscall_mmap,		//3
+		(syscall)&vfs_syscall_munmap,	//4
 		(syscall)&nop,
 		(syscall)&nop,
 		(syscall)&nop,
@@ -56,9 +60,9 @@ static syscall syscalls[] = {
 		(syscall)&pm_ExitTask,			//11
 		(syscall)&createThreadHandler,	//12
 		(syscall)&exitThreadHandler,	//13
-		(syscall)&nop,
-		(syscall)&nop,
-		(syscall)&nop,
+		(syscall)&futex_wait,			//14
+		(syscall)&futex_wake,			//15
+		(syscall)&pmu_syscall_read,		//16
 		(syscall)&nop,
 		(syscall)&nop,
 		(syscall)&nop,
@@ -90,11 +94,11 @@ static syscall syscalls[] = {
 		(syscall)&vfs_syscall_read,		//42
 		(syscall)&vfs_syscall_write,	//43
 		(syscall)&vfs_syscall_getFileinfo,		//44
-		(syscall)&nop,
-		(syscall)&nop,
-		(syscall)&nop,
-		(syscall)&nop,
-		(syscall)&nop,
+		(syscall)&aio_setup,			//45
+		(syscall)&aio_enter,			//46
+		(syscall)&vfs_syscall_readv,	//47
+		(syscall)&vfs_syscall_writev,	//48
+		(syscall)&vfs_syscall_splice,	//49
 
 		(syscall)&cmos_GetTime,			//50
 		(syscall)&cmos_GetDate,			//51
@@ -129,7 +133,10 @@ uint64_t syscall_syscallHandler(uint64_t func, uint64_t arg1, uint64_t arg2, uin
 {
 	//FIXME
 	assert(func < sizeof(syscalls) / sizeof(syscall));
-	return syscalls[func](arg1, arg2, arg3, arg4, arg5);
+	TRACE(TRACE_SYSCALL_ENTER, func, arg1);
+	uint64_t ret = syscalls[func](arg1, arg2, arg3, arg4, arg5);
+	TRACE(TRACE_SYSCALL_EXIT, func, ret);
+	return ret;
 }
 
 /*
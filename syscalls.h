@@ -15,10 +15,16 @@
 #define MALLOC	0
 #define FREE	1
 #define UNUSE	2
+#define MMAP	3
+#define MUNMAP	4
 
 //Programmaufruf und Beendung
 #define EXEC	10
 #define EXIT	11
+#define THREAD_CREATE	12
+#define THREAD_EXIT		13
+#define FUTEX_WAIT		14
+#define FUTEX_WAKE		15
 
 //Ein- und Ausgabe
 #define GETCH	20
@@ -33,6 +39,11 @@
 #define FREAD	42
 #define FWRITE	43
 #define FINFO	44
+#define IORING_SETUP	45
+#define IORING_ENTER	46
+#define FREADV	47
+#define FWRITEV	48
+#define FSPLICE	49
 
 //Verschiedene Funktionen
 #define TIME	50
@@ -6,76 +6,53 @@
  */
 
 #include "cleaner.h"
-#include "list.h"
-#include "lock.h"
+#include "workqueue.h"
 #include "stdlib.h"
 #include "scheduler.h"
 
-extern thread_t *cleanerThread;
+typedef struct{
+	work_t work;
+	void *data;
+	clean_type_t type;
+}clean_entry_t;
 
-static list_t cleanList;
-static lock_t cleanLock = LOCK_UNLOCKED;
-
-void __attribute__((noreturn)) cleaner()
+//Wird in der allgemeinen Warteschlange ausgeführt, der Prozess bzw. Thread läuft dann nicht mehr
+static void clean(void *opaque)
 {
-	while(1)
+	clean_entry_t *entry = opaque;
+	switch(entry->type)
 	{
-		lock(&cleanLock);
-		if(list_size(cleanList) > 0)
-		{
-			clean_entry_t *entry;
-			while((entry = list_pop(cleanList)))
-			{
-				switch(entry->type)
-				{
-					case CL_PROCESS:
-						pm_DestroyTask(entry->data);
-					break;
-					case CL_THREAD:
-						thread_destroy(entry->data);
-				}
-				free(entry);
-			}
-		}
-		unlock(&cleanLock);
-		thread_block(cleanerThread);
-		yield();
+		case CL_PROCESS:
+			pm_DestroyTask(entry->data);
+		break;
+		case CL_THREAD:
+			thread_destroy(entry->data);
 	}
+	free(entry);
 }
 
-void cleaner_Init()
+static void cleaner_queue(void *data, clean_type_t type)
 {
-	cleanList = list_create();
+	clean_entry_t *entry = malloc(sizeof(clean_entry_t));
+
+	entry->data = data;
+	entry->type = type;
+	work_init(&entry->work, clean, entry);
+	workqueue_queue(NULL, &entry->work);
 }
 
 void cleaner_cleanProcess(process_t *process)
 {
-	clean_entry_t *entry = malloc(sizeof(clean_entry_t));
-
-	entry->type = CL_PROCESS;
-	entry->data = process;
-
 	//Prozess blockieren
 	pm_BlockTask(process);
 
-	lock(&cleanLock);
-	list_push(cleanList, entry);
-	unlock(&cleanLock);
-	thread_unblock(cleanerThread);
+	cleaner_queue(process, CL_PROCESS);
 }
 
 void cleaner_cleanThread(thread_t *thread)
 {
-	clean_entry_t *entry = malloc(sizeof(clean_entry_t));
-
-	entry->type = CL_THREAD;
-	entry->data = thread;
-
 	//Thread blockieren
 	thread_block(thread);
 
-	lock(&cleanLock);
-	list_push(cleanList, entry);
-	unlock(&cleanLock);
-	thread_unblock(cleanerThread);
+	cleaner_queue(thread, CL_THREAD);
 }
@@ -15,14 +15,7 @@ typedef enum{
 	CL_PROCESS, CL_THREAD
 }clean_type_t;
 
-typedef struct{
-	void *data;
-	clean_type_t type;
-}clean_entry_t;
-
-void cleaner();
-
-void cleaner_Init();
+//Prozesse und Threads werden über die allgemeine Warteschlange (workqueue.h) aufgeräumt
 void cleaner_cleanProcess(process_t *process);
 void cleaner_cleanThread(thread_t *thread);
 
@@ -0,0 +1,137 @@
+/*
+ * futex.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "futex.h"
+#include "scheduler.h"
+#include "memory.h"
+#include "vmm.h"
+#include "vfs.h"
+#include "lock.h"
+#include "ilist.h"
+
+#define FUTEX_BUCKETS	64		//Anzahl Warteschlangen (Zweierpotenz)
+
+/*
+ * Wartende Threads werden nach (Kontext, Adresse) in eine der Warteschlangen eingeteilt.
+ * Die Warteschlangen werden nur mit ausgeschalteten Interrupts verändert, damit ein Thread,
+ * der sich gerade schlafen legt, nicht zwischen dem Eintragen und dem Blockieren unterbrochen
+ * wird.
+ */
+typedef struct{
+	spinlock_t lock;
+	ilist_t waiting;
+}futex_bucket_t;
+
+static futex_bucket_t futex_buckets[FUTEX_BUCKETS];
+
+void futex_Init(void)
+{
+	size_t i;
+	for(i = 0; i < FUTEX_BUCKETS; i++)
+	{
+		futex_buckets[i].lock = SPINLOCK_UNLOCKED;
+		ilist_init(&futex_buckets[i].waiting);
+	}
+}
+
+static futex_bucket_t *futex_getBucket(context_t *context, uintptr_t address)
+{
+	uint64_t key = ((uintptr_t)context >> 4) ^ (address >> 2);
+	key *= 0x9E3779B97F4A7C15ul;
+	return &futex_buckets[key >> 58];
+}
+
+static bool futex_checkAddress(uint32_t *address)
+{
+	return (uintptr_t)address >= USERSPACE_START && (uintptr_t)address <= USERSPACE_END - sizeof(uint32_t)
+			&& ((uintptr_t)address & (sizeof(uint32_t) - 1)) == 0;
+}
+
+int64_t futex_wait(uint32_t *address, uint32_t value)
+{
+	if(!futex_checkAddress(address))
+		return -1;
+
+	//Eine nicht gemappte Page kann noch zu einer gemappten Datei gehören und wird dann jetzt eingelagert,
+	//damit das nicht mit ausgeschalteten Interrupts passiert
+	if(vmm_getPhysAddress(address) == 0 && !vfs_HandlePageFault(address, false))
+		return -1;
+	if(*(volatile uint32_t*)address != value)
+		return 1;
+
+	thread_t *thread = currentThread;
+	futex_bucket_t *bucket = futex_getBucket(currentProcess->Context, (uintptr_t)address);
+
+	uint64_t flags = spin_lock_irqsave(&bucket->lock);
+	//Ein anderer Thread kann die Page inzwischen freigegeben haben
+	if(vmm_getPhysAddress(address) == 0)
+	{
+		spin_unlock_irqrestore(&bucket->lock, flags);
+		return -1;
+	}
+	if(*(volatile uint32_t*)address != value)
+	{
+		spin_unlock_irqrestore(&bucket->lock, flags);
+		return 1;
+	}
+
+	thread->futex.context = currentProcess->Context;
+	thread->futex.address = (uintptr_t)address;
+	ilist_push_back(&bucket->waiting, &thread->futex.node);
+
+	//Blockieren, bevor die Warteschlange freigegeben wird, damit kein Aufwecken verloren geht
+	thread_block(thread);
+	spin_unlock_irqrestore(&bucket->lock, flags);
+
+	yield();
+
+	return 0;
+}
+
+uint64_t futex_wake(uint32_t *address, uint64_t count)
+{
+	if(!futex_checkAddress(address) || count == 0)
+		return 0;
+
+	context_t *context = currentProcess->Context;
+	futex_bucket_t *bucket = futex_getBucket(context, (uintptr_t)address);
+	ilist_node_t *node, *tmp;
+	uint64_t woken = 0;
+
+	uint64_t flags = spin_lock_irqsave(&bucket->lock);
+	ilist_foreach_safe(node, tmp, &bucket->waiting)
+	{
+		thread_t *thread = ILIST_ENTRY(node, thread_t, futex.node);
+		if(thread->futex.context != context || thread->futex.address != (uintptr_t)address)
+			continue;
+
+		ilist_remove(&bucket->waiting, node);
+		thread_unblock(thread);
+		if(++woken >= count)
+			break;
+	}
+	spin_unlock_irqrestore(&bucket->lock, flags);
+
+	return woken;
+}
+
+void futex_removeThread(thread_t *thread)
+{
+	if(thread->futex.node.next == NULL)
+		return;
+
+	futex_bucket_t *bucket = futex_getBucket(thread->futex.context, thread->futex.address);
+	uint64_t flags = spin_lock_irqsave(&bucket->lock);
+	//Der Thread könnte inzwischen aufgeweckt worden sein
+	if(thread->futex.node.next != NULL)
+		ilist_remove(&bucket->waiting, &thread->futex.node);
+	spin_unlock_irqrestore(&bucket->lock, flags);
+}
+
+#endif
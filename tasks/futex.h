@@ -0,0 +1,44 @@
+/*
+ * futex.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef FUTEX_H_
+#define FUTEX_H_
+
+#include "stdint.h"
+#include "thread.h"
+
+void futex_Init(void);
+
+/*
+ * Legt den aktuellen Thread schlafen, solange *address == value ist
+ * Parameter:	address = Adresse des Wortes im Userspace (4 Byte ausgerichtet)
+ * 				value = Erwarteter Wert
+ * Rückgabe:	0 = Thread wurde aufgeweckt
+ * 				1 = *address war nicht value
+ * 				-1 = Ungültige Adresse
+ */
+int64_t futex_wait(uint32_t *address, uint32_t value);
+
+/*
+ * Weckt Threads auf, die auf ein Wort warten
+ * Parameter:	address = Adresse des Wortes im Userspace
+ * 				count = Maximale Anzahl Threads, die aufgeweckt werden sollen
+ * Rückgabe:	Anzahl aufgeweckter Threads
+ */
+uint64_t futex_wake(uint32_t *address, uint64_t count);
+
+/*
+ * Entfernt einen Thread aus der Warteschlange, falls er wartet. Wird beim Zerstören eines Threads
+ * aufgerufen.
+ */
+void futex_removeThread(thread_t *thread);
+
+#endif /* FUTEX_H_ */
+
+#endif
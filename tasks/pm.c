@@ -17,19 +17,21 @@
 #include "thread.h"
 #include "scheduler.h"
 #include "cleaner.h"
+#include "workqueue.h"
 #include "avl.h"
 #include "assert.h"
 #include "vfs.h"
+#include "futex.h"
+#include "aio.h"
 
 static pid_t nextPID = 1;
 static uint64_t numTasks = 0;
 extern process_t kernel_process;				//Handler für idle-Task
 extern thread_t* idleThread;				//Handler für idle-Task
-thread_t* cleanerThread;				//Handler für cleaner-Task
-extern list_t threadList;
+extern ilist_t threadList;
 
 static avl_tree *process_list = NULL;	//Liste aller Prozesse
-static lock_t pm_lock = LOCK_UNLOCKED;
+static rwlock_t pm_lock = RWLOCK_UNLOCKED;
 
 ihs_t *pm_Schedule(ihs_t *cpu);
 
@@ -74,7 +76,7 @@ static void pid_list(const void *a, void *b)
 		process_info[*i] = (process_info_t){
 			.pid = p->PID,
 			.ppid = (p->parent) ? p->parent->PID : 0,
-			.num_threads = list_size(p->threads),
+			.num_threads = ilist_size(&p->threads),
 			.status = p->Status
 		};
 		memcpy(&process_info[*i].cmd, p->cmd, 19 * sizeof(char));
@@ -90,24 +92,18 @@ static void pid_list(const void *a, void *b)
 void pm_Init()
 {
 	thread_Init();
+	futex_Init();
 	scheduler_Init();
-	cleaner_Init();
 
-	kernel_process.threads = list_create();
+	ilist_init(&kernel_process.threads);
+	ilist_init(&kernel_process.mappings);
+	kernel_process.mappings_lock = RWLOCK_UNLOCKED;
 	idleThread = thread_create(&kernel_process, idle, 0, NULL, true);
-	cleanerThread = thread_create(&kernel_process, cleaner, 0, NULL, true);
 
-	size_t i = 0;
-	thread_t *t;
-	while((t = list_get(threadList, i)))
-	{
-		if(t == idleThread)
-		{
-			list_remove(threadList, i);
-			break;
-		}
-		i++;
-	}
+	ilist_remove(&threadList, &idleThread->list_node);
+
+	//Stellt auch den Thread zum Aufräumen von Prozessen und Threads bereit
+	workqueue_Init();
 }
 
 /*
@@ -134,9 +130,12 @@ process_t *pm_InitTask(process_t *parent, void *entry, char* cmd, const char *st
 	newProcess->Context = createContext();
 
 	newProcess->nextThreadStack = (void*)(MM_USER_STACK + 1);
+	newProcess->aio = NULL;
 
 	//Liste der Threads erstellen
-	newProcess->threads = list_create();
+	ilist_init(&newProcess->threads);
+	ilist_init(&newProcess->mappings);
+	newProcess->mappings_lock = RWLOCK_UNLOCKED;
 
 	if(!vfs_initUserspace(parent, newProcess, stdin, stdout, stderr))
 	{
@@ -151,7 +150,7 @@ process_t *pm_InitTask(process_t *parent, void *entry, char* cmd, const char *st
 	thread_create(newProcess, entry, strlen(newProcess->cmd) + 1, newProcess->cmd, false)->Status = READY;
 
 	//Prozess in Liste eintragen
-	bool res = LOCKED_RESULT(pm_lock, avl_add_s(&process_list, newProcess, pid_cmp, NULL));
+	bool res = WLOCKED_RESULT(pm_lock, avl_add_s(&process_list, newProcess, pid_cmp, NULL));
 	assert(res && "Es gibt schon einen Task mit dieser PID!");
 
 	__sync_fetch_and_add(&numTasks, 1);
@@ -166,14 +165,14 @@ process_t *pm_InitTask(process_t *parent, void *entry, char* cmd, const char *st
  */
 void pm_DestroyTask(process_t *process)
 {
-	if(LOCKED_RESULT(pm_lock, avl_remove_s(&process_list, process, pid_cmp, NULL)))
+	if(WLOCKED_RESULT(pm_lock, avl_remove_s(&process_list, process, pid_cmp, NULL)))
 	{
 		//Wenn der richtige Prozess gefunden wurde, alle Datenstrukturen des Prozesses freigeben
 		//und alle Kindprozesse beenden
 		//TODO: Signal senden anstatt einfach zu killen
 		list_t childs = list_create();
 		void *a[2] = {process, childs};
-		LOCKED_TASK(pm_lock, avl_visit_s(process_list, avl_visiting_in_order, pid_visit, a));
+		RLOCKED_TASK(pm_lock, avl_visit_s(process_list, avl_visiting_in_order, pid_visit, a));
 		process_t *child;
 		while((child = list_pop(childs)))
 		{
@@ -182,15 +181,17 @@ void pm_DestroyTask(process_t *process)
 		list_destroy(childs);
 
 		//Alle Threads beenden
-		thread_t *thread;
-		while((thread = list_get(process->threads, 0)))
-			thread_destroy(thread);
+		ilist_node_t *node;
+		while((node = ilist_first(&process->threads)))
+			thread_destroy(ILIST_ENTRY(node, thread_t, process_node));
+		aio_destroy(process);
+		vfs_deinitUserspace(process);
 		deleteContext(process->Context);
 		free(process->cmd);
 		free(process);
 		numTasks--;
 	}
-	assert(!LOCKED_RESULT(pm_lock, avl_search_s(process_list, process, pid_cmp, NULL)));
+	assert(!RLOCKED_RESULT(pm_lock, avl_search_s(process_list, process, pid_cmp, NULL)));
 }
 
 /*
@@ -215,11 +216,10 @@ void pm_BlockTask(process_t *process)
 		process->Status = BLOCKED;
 
 		//Alle Threads deaktivieren
-		thread_t *thread;
-		size_t i = 0;
-		while((thread = list_get(process->threads, i++)))
+		ilist_node_t *node;
+		ilist_foreach(node, &process->threads)
 		{
-			scheduler_remove(thread);
+			scheduler_remove(ILIST_ENTRY(node, thread_t, process_node));
 		}
 	}
 }
@@ -235,10 +235,10 @@ void pm_ActivateTask(process_t *process)
 		process->Status = READY;
 
 		//Alle Threads aktivieren
-		thread_t *thread;
-		size_t i = 0;
-		while((thread = list_get(process->threads, i++)))
+		ilist_node_t *node;
+		ilist_foreach(node, &process->threads)
 		{
+			thread_t *thread = ILIST_ENTRY(node, thread_t, process_node);
 			if(thread->Status != BLOCKED)
 				scheduler_add(thread);
 		}
@@ -256,7 +256,7 @@ process_t *pm_getTask(pid_t PID)
 	process_t dummy = {0};
 	dummy.PID = PID;
 
-	LOCKED_TASK(pm_lock, avl_search_s(process_list, &dummy, pid_cmp, &Process));
+	RLOCKED_TASK(pm_lock, avl_search_s(process_list, &dummy, pid_cmp, &Process));
 	assert(!Process || Process->PID == PID);
 
 	return Process;
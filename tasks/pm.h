@@ -12,6 +12,7 @@
 #include "stdint.h"
 #include "vmm.h"
 #include "list.h"
+#include "ilist.h"
 #include "hashmap.h"
 #include "lock.h"
 
@@ -32,11 +33,15 @@ typedef struct process_t{
 		struct process_t *parent;
 		char *cmd;
 		pm_status_t Status;
-		list_t threads;
-		hashmap_t *streams;
+		ilist_t threads;
+		struct vfs_fd_table *fd_table;		//Geöffnete Streams des Prozesses
+		ilist_t mappings;					//Gemappte Dateien
+		rwlock_t mappings_lock;
 
 		void *nextThreadStack;
 		lock_t lock;
+
+		struct aio_context *aio;			//Angemeldeter I/O-Ring (NULL wenn keiner)
 }process_t;
 
 extern process_t *currentProcess;			//Aktueller Prozess
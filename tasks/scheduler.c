@@ -8,8 +8,11 @@
 #include "scheduler.h"
 #include "ring.h"
 #include "lock.h"
+#include "lockstat.h"
 #include "stdbool.h"
 #include "isr.h"
+#include "trace.h"
+#include "pmu.h"
 
 extern thread_t *fpuThread;
 
@@ -33,6 +36,7 @@ process_t *currentProcess;
 void scheduler_Init()
 {
 	scheduleList = ring_create();
+	lockstat_register(&schedule_lock, "scheduler");
 	//Lock freigeben
 	unlock(&schedule_lock);
 }
@@ -99,6 +103,8 @@ thread_t *scheduler_schedule(ihs_t *state)
 
 		if(newThread != currentThread)
 		{
+			TRACE(TRACE_SCHED_SWITCH, (currentThread != NULL) ? currentThread->tid : 0, newThread->tid);
+			pmu_switch(currentThread);
 			if(currentProcess != newThread->process)
 				activateContext(newThread->process->Context);
 			thread_prepare(newThread);
@@ -6,7 +6,7 @@
  */
 
 #include "thread.h"
-#include "list.h"
+#include "ilist.h"
 #include "lock.h"
 #include "memory.h"
 #include "tss.h"
@@ -16,13 +16,16 @@
 #include "cpu.h"
 #include "scheduler.h"
 #include "pmm.h"
+#include "futex.h"
 
-list_t threadList;
+extern thread_t *fpuThread;
+
+ilist_t threadList;
 tid_t nextTID = 1;
 
 void thread_Init()
 {
-	threadList = list_create();
+	ilist_init(&threadList);
 }
 
 tid_t get_tid()
@@ -40,6 +43,21 @@ thread_t *thread_create(process_t *process, void *entry, size_t data_length, voi
 	if(thread == NULL)
 		return NULL;
 
+	//Der #NM-Handler darf keinen Speicher reservieren, deshalb wird der FPU-Status schon hier angelegt
+	thread->fpuState = NULL;
+	if(cpuInfo.fxsr)
+	{
+		if((thread->fpuState = aligned_alloc(16, 512)) == NULL)
+		{
+			free(thread);
+			return NULL;
+		}
+		//Zustand nach FNINIT (FCW = 0x37F) und Standard-MXCSR (0x1F80)
+		memset(thread->fpuState, 0, 512);
+		*(uint16_t*)thread->fpuState = 0x37F;
+		*(uint32_t*)(thread->fpuState + 24) = 0x1F80;
+	}
+
 	thread->isMainThread = (process != currentProcess);
 
 	thread->tid = get_tid();
@@ -78,7 +96,8 @@ thread_t *thread_create(process_t *process, void *entry, size_t data_length, voi
 		memcpy(thread->State, &new_state, sizeof(ihs_t));
 	}
 
-	thread->fpuState = NULL;
+	memset(thread->pmc, 0, sizeof(thread->pmc));
+	thread->futex.node.prev = thread->futex.node.next = NULL;
 
 	//Stack mappen
 	if(!kernel)
@@ -100,10 +119,10 @@ thread_t *thread_create(process_t *process, void *entry, size_t data_length, voi
 		memcpy(thread->State, &new_state, sizeof(ihs_t));
 	}
 
-	list_push(process->threads, thread);
+	ilist_push_front(&process->threads, &thread->process_node);
 
 	//Thread in Liste eintragen
-	list_push(threadList, thread);
+	ilist_push_front(&threadList, &thread->list_node);
 
 	thread->Status = BLOCKED;
 
@@ -115,33 +134,19 @@ void thread_destroy(thread_t *thread)
 	mm_SysFree((uintptr_t)thread->kernelStackBottom, 1);
 
 	//Thread aus Listen entfernen
-	thread_t *t;
-	size_t i = 0;
-	while((t = list_get(thread->process->threads, i)))
-	{
-		if(t == thread)
-		{
-			list_remove(thread->process->threads, i);
-			break;
-		}
-		i++;
-	}
-
-	i = 0;
-	while((t = list_get(threadList, i)))
-	{
-		if(t == thread)
-		{
-			list_remove(threadList, i);
-			break;
-		}
-		i++;
-	}
+	futex_removeThread(thread);
+	ilist_remove(&thread->process->threads, &thread->process_node);
+	//Der Idle-Thread ist nicht in der Threadliste eingetragen
+	if(thread->list_node.next != NULL)
+		ilist_remove(&threadList, &thread->list_node);
 
 	//Userstack freigeben
 	vmm_ContextUnMap(thread->process->Context, thread->userStackBottom);
 	pmm_Free(thread->userStackPhys);
 
+	//Der FPU-Status darf nach dem Freigeben nicht mehr gesichert werden
+	if(fpuThread == thread)
+		fpuThread = NULL;
 	free(thread->fpuState);
 	free(thread);
 }
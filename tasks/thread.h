@@ -13,6 +13,7 @@
 #include "pm.h"
 #include "stdbool.h"
 #include "pmm.h"
+#include "pmc.h"
 
 typedef uint64_t tid_t;
 
@@ -26,6 +27,17 @@ typedef struct{
 	void *userStackBottom;
 	paddr_t userStackPhys;
 	bool isMainThread;
+	uint64_t pmc[PMC_MAX];		//Leistungszähler ohne den Stand der Hardwarezähler (pmu.h)
+
+	ilist_node_t process_node;	//Knoten in process->threads
+	ilist_node_t list_node;		//Knoten in threadList
+
+	//Gültig, solange der Thread auf ein Futex wartet (futex.node.next != NULL)
+	struct{
+		context_t *context;
+		uintptr_t address;
+		ilist_node_t node;
+	}futex;
 }thread_t;
 
 void thread_Init();
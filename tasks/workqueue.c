@@ -0,0 +1,169 @@
+/*
+ * workqueue.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "workqueue.h"
+#include "scheduler.h"
+#include "stdlib.h"
+
+static workqueue_t *system_queue = NULL;
+
+typedef struct{
+	work_t work;
+	thread_t *thread;
+	bool done;
+}workqueue_barrier_t;
+
+static void __attribute__((noreturn)) workqueue_worker(workqueue_t *queue)
+{
+	while(1)
+	{
+		uint64_t flags = spin_lock_irqsave(&queue->lock);
+		ilist_node_t *node = ilist_pop_front(&queue->works);
+		if(node == NULL)
+		{
+			//Blockieren, bevor der Lock freigegeben wird, damit kein Aufwecken verloren geht
+			queue->idle = true;
+			thread_block(currentThread);
+			spin_unlock_irqrestore(&queue->lock, flags);
+			yield();
+			continue;
+		}
+
+		work_t *work = ILIST_ENTRY(node, work_t, node);
+		//Ab hier darf der Auftrag wieder angehängt werden, auch von sich selbst
+		work->pending = false;
+		spin_unlock_irqrestore(&queue->lock, flags);
+
+		work->func(work->opaque);
+	}
+}
+
+void work_init(work_t *work, void (*func)(void *opaque), void *opaque)
+{
+	work->func = func;
+	work->opaque = opaque;
+	work->queue = NULL;
+	work->pending = false;
+}
+
+workqueue_t *workqueue_create(const char *name)
+{
+	workqueue_t *queue = malloc(sizeof(workqueue_t));
+	if(queue == NULL)
+		return NULL;
+
+	queue->name = name;
+	queue->lock = SPINLOCK_UNLOCKED;
+	ilist_init(&queue->works);
+	queue->idle = false;
+	queue->worker = thread_create(&kernel_process, workqueue_worker, 0, NULL, true);
+	if(queue->worker == NULL)
+	{
+		free(queue);
+		return NULL;
+	}
+	//Kernelthreads bekommen keine Parameter, die Warteschlange wird deshalb direkt in rdi übergeben
+	queue->worker->State->rdi = (uintptr_t)queue;
+	thread_unblock(queue->worker);
+
+	return queue;
+}
+
+bool workqueue_queue(workqueue_t *queue, work_t *work)
+{
+	bool queued = false;
+
+	if(queue == NULL)
+		queue = system_queue;
+	if(queue == NULL)
+		return false;
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	if(!work->pending)
+	{
+		work->pending = true;
+		work->queue = queue;
+		ilist_push_back(&queue->works, &work->node);
+		queued = true;
+
+		if(queue->idle)
+		{
+			queue->idle = false;
+			thread_unblock(queue->worker);
+		}
+	}
+	spin_unlock_irqrestore(&queue->lock, flags);
+
+	return queued;
+}
+
+bool workqueue_cancel(work_t *work)
+{
+	workqueue_t *queue = work->queue;
+	bool cancelled = false;
+
+	if(queue == NULL)
+		return false;
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	if(work->pending && work->queue == queue)
+	{
+		ilist_remove(&queue->works, &work->node);
+		work->pending = false;
+		cancelled = true;
+	}
+	spin_unlock_irqrestore(&queue->lock, flags);
+
+	return cancelled;
+}
+
+static void workqueue_barrier(void *opaque)
+{
+	workqueue_barrier_t *barrier = opaque;
+	workqueue_t *queue = barrier->work.queue;
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	barrier->done = true;
+	thread_unblock(barrier->thread);
+	spin_unlock_irqrestore(&queue->lock, flags);
+}
+
+void workqueue_flush(workqueue_t *queue)
+{
+	workqueue_barrier_t barrier = {
+		.thread = currentThread,
+		.done = false
+	};
+
+	if(queue == NULL)
+		queue = system_queue;
+	if(queue == NULL)
+		return;
+
+	//Die Aufträge werden der Reihe nach ausgeführt, wenn die Sperre dran ist, sind alle vorherigen fertig
+	work_init(&barrier.work, workqueue_barrier, &barrier);
+	workqueue_queue(queue, &barrier.work);
+
+	uint64_t flags = spin_lock_irqsave(&queue->lock);
+	while(!barrier.done)
+	{
+		thread_block(currentThread);
+		spin_unlock_irqrestore(&queue->lock, flags);
+		yield();
+		flags = spin_lock_irqsave(&queue->lock);
+	}
+	spin_unlock_irqrestore(&queue->lock, flags);
+}
+
+void workqueue_Init(void)
+{
+	system_queue = workqueue_create("events");
+}
+
+#endif
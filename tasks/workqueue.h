@@ -0,0 +1,81 @@
+/*
+ * workqueue.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef WORKQUEUE_H_
+#define WORKQUEUE_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "ilist.h"
+#include "lock.h"
+#include "thread.h"
+
+/*
+ * Verzögerte Arbeit: Ein Interrupthandler (oder jeder andere Code) hängt einen Auftrag an eine
+ * Warteschlange, der später im Worker-Thread der Warteschlange ausgeführt wird. Dort darf der
+ * Auftrag blockieren und beliebig lange laufen. Es gibt nur eine CPU, deshalb hat jede Warteschlange
+ * genau einen Worker-Thread. Die Aufträge einer Warteschlange werden in der Reihenfolge ausgeführt,
+ * in der sie angehängt wurden.
+ * Für kurze Arbeit direkt nach einem Interrupt gibt es die Softirqs (softirq.h).
+ */
+
+typedef struct workqueue workqueue_t;
+
+typedef struct{
+	ilist_node_t node;
+	void (*func)(void *opaque);
+	void *opaque;
+	workqueue_t *queue;		//Warteschlange, an der der Auftrag hängt
+	volatile bool pending;	//true, solange der Auftrag auf die Ausführung wartet
+}work_t;
+
+struct workqueue{
+	const char *name;
+	spinlock_t lock;
+	ilist_t works;
+	thread_t *worker;
+	bool idle;				//true, wenn der Worker blockiert ist und geweckt werden muss
+};
+
+void workqueue_Init(void);
+
+//Initialisiert einen Auftrag
+void work_init(work_t *work, void (*func)(void *opaque), void *opaque);
+
+/*
+ * Erstellt eine Warteschlange mit eigenem Worker-Thread
+ * Parameter:	name = Name der Warteschlange (wird nicht kopiert)
+ */
+workqueue_t *workqueue_create(const char *name);
+
+/*
+ * Hängt einen Auftrag an eine Warteschlange. Darf auch im Interruptkontext aufgerufen werden.
+ * Parameter:	queue = Warteschlange oder NULL für die allgemeine Warteschlange
+ * 				work = Auftrag
+ * Rückgabe:	true, wenn der Auftrag angehängt wurde, false, wenn er schon wartete
+ */
+bool workqueue_queue(workqueue_t *queue, work_t *work);
+
+/*
+ * Entfernt einen wartenden Auftrag aus seiner Warteschlange. Ein Auftrag, der gerade läuft, wird
+ * nicht abgebrochen, darauf kann mit workqueue_flush gewartet werden.
+ * Rückgabe:	true, wenn der Auftrag noch nicht ausgeführt worden war
+ */
+bool workqueue_cancel(work_t *work);
+
+/*
+ * Wartet, bis alle Aufträge ausgeführt sind, die bis jetzt an die Warteschlange gehängt wurden.
+ * Darf nicht vom Worker der Warteschlange aufgerufen werden.
+ * Parameter:	queue = Warteschlange oder NULL für die allgemeine Warteschlange
+ */
+void workqueue_flush(workqueue_t *queue);
+
+#endif /* WORKQUEUE_H_ */
+
+#endif
@@ -0,0 +1,248 @@
+/*
+ * trace.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "trace.h"
+#include "cpu.h"
+#include "lock.h"
+#include "lockstat.h"
+#include "vmm.h"
+#include "memory.h"
+#include "vfs.h"
+#include "scheduler.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define TRACE_BUFFER_SIZE	8192	//Anzahl Einträge im Ringpuffer, muss eine Zweierpotenz sein
+
+/*
+ * Ringpuffer. Ein Schreiber reserviert sich mit einem atomaren Inkrement von head eine Position
+ * und markiert den Eintrag in commit als gültig, wenn er fertig geschrieben ist. Der Leser erkennt
+ * so Einträge, die noch geschrieben oder inzwischen überschrieben werden.
+ * Da der Kernel nur einen Prozessor verwendet, gibt es nur einen Puffer.
+ */
+typedef struct{
+	trace_record_t *records;
+	volatile uint64_t *commit;		//Sequenznummer + 1 des gültigen Eintrags, 0 während geschrieben wird
+	volatile uint64_t head;			//Nächste freie Sequenznummer
+	uint64_t tail;					//Nächster ungelesener Eintrag
+	uint64_t lost;					//Überschriebene Einträge, die nie gelesen wurden
+}trace_buffer_t;
+
+static const char *const trace_categories[TRACE_CAT_MAX] = {
+	[TRACE_CAT_SCHED] = "sched",
+	[TRACE_CAT_MM] = "mm",
+	[TRACE_CAT_SYSCALL] = "syscall",
+	[TRACE_CAT_CACHE] = "cache",
+	[TRACE_CAT_STORAGE] = "storage",
+	[TRACE_CAT_VFS] = "vfs"
+};
+
+volatile uint32_t trace_enabled = 0;
+static trace_buffer_t trace_buffer;
+static lock_t trace_read_lock = LOCK_UNLOCKED;	//Serialisiert nur die Leser
+
+void trace_record(trace_event_t event, uint64_t arg0, uint64_t arg1)
+{
+	trace_buffer_t *buffer = &trace_buffer;
+	if(buffer->records == NULL)
+		return;
+
+	uint64_t seq = __sync_fetch_and_add(&buffer->head, 1);
+	size_t i = seq & (TRACE_BUFFER_SIZE - 1);
+	trace_record_t *record = &buffer->records[i];
+
+	buffer->commit[i] = 0;
+	__sync_synchronize();
+	record->tsc = cpu_rdtsc();
+	record->tid = (currentThread != NULL) ? currentThread->tid : 0;
+	record->event = event;
+	record->cpu = 0;
+	record->arg0 = arg0;
+	record->arg1 = arg1;
+	__sync_synchronize();
+	buffer->commit[i] = seq + 1;
+}
+
+/*
+ * Liest die ältesten ungelesenen Einträge aus dem Puffer. Es werden nur ganze Einträge gelesen.
+ * start wird ignoriert, da gelesene Einträge entfernt werden.
+ */
+static size_t trace_readHandler(void *opaque, uint64_t __attribute__((unused)) start, size_t length, void *buffer)
+{
+	trace_buffer_t *trace = opaque;
+	trace_record_t *out = buffer;
+	size_t count = 0;
+
+	if(trace->records == NULL)
+		return 0;
+
+	lock(&trace_read_lock);
+	while(count < length / sizeof(trace_record_t))
+	{
+		uint64_t head = trace->head;
+		if(trace->tail == head)
+			break;
+
+		//Überschriebene Einträge überspringen
+		if(head - trace->tail > TRACE_BUFFER_SIZE)
+		{
+			trace->lost += head - TRACE_BUFFER_SIZE - trace->tail;
+			trace->tail = head - TRACE_BUFFER_SIZE;
+		}
+
+		size_t i = trace->tail & (TRACE_BUFFER_SIZE - 1);
+		uint64_t commit = trace->commit[i];
+		//Eintrag wird noch geschrieben
+		if(commit < trace->tail + 1)
+			break;
+		if(commit == trace->tail + 1)
+		{
+			out[count] = trace->records[i];
+			__sync_synchronize();
+			//Nur übernehmen, wenn er während dem Kopieren nicht überschrieben wurde
+			if(trace->commit[i] == trace->tail + 1)
+				count++;
+			else
+				trace->lost++;
+		}
+		else
+			trace->lost++;
+		trace->tail++;
+	}
+	unlock(&trace_read_lock);
+
+	return count * sizeof(trace_record_t);
+}
+
+/*
+ * Schaltet Kategorien ein oder aus. Mehrere Namen werden durch Leerzeichen, Kommas oder
+ * Zeilenumbrüche getrennt, ein vorangestelltes '-' schaltet die Kategorie aus.
+ */
+static size_t trace_writeHandler(void __attribute__((unused)) *opaque, uint64_t __attribute__((unused)) start, size_t length,
+		const void *buffer)
+{
+	const char *text = buffer;
+	size_t pos = 0;
+
+	while(pos < length)
+	{
+		while(pos < length && (text[pos] == ' ' || text[pos] == ',' || text[pos] == '\n' || text[pos] == '\t'))
+			pos++;
+		if(pos >= length || text[pos] == '\0')
+			break;
+
+		bool disable = (text[pos] == '-');
+		if(disable)
+			pos++;
+		const char *name = &text[pos];
+		size_t len = 0;
+		while(pos < length && text[pos] != '\0' && text[pos] != ' ' && text[pos] != ',' && text[pos] != '\n' && text[pos] != '\t')
+		{
+			pos++;
+			len++;
+		}
+
+		uint32_t mask = 0;
+		if(len == 3 && strncmp(name, "all", 3) == 0)
+			mask = (1u << TRACE_CAT_MAX) - 1;
+		else if(len == 4 && strncmp(name, "none", 4) == 0)
+		{
+			mask = (1u << TRACE_CAT_MAX) - 1;
+			disable = !disable;
+		}
+		else
+		{
+			trace_category_t cat;
+			for(cat = 0; cat < TRACE_CAT_MAX; cat++)
+			{
+				if(strlen(trace_categories[cat]) == len && strncmp(name, trace_categories[cat], len) == 0)
+					mask = 1u << cat;
+			}
+		}
+
+		if(disable)
+			__sync_fetch_and_and(&trace_enabled, ~mask);
+		else
+			__sync_fetch_and_or(&trace_enabled, mask);
+
+		if(pos < length && text[pos] == '\0')
+			break;
+	}
+
+	return length;
+}
+
+static void *trace_getValue(void __attribute__((unused)) *opaque, vfs_device_function_t function)
+{
+	switch(function)
+	{
+		case FUNC_TYPE:
+			return VFS_DEVICE_VIRTUAL;
+		case FUNC_NAME:
+			return "trace";
+		default:
+			return NULL;
+	}
+}
+
+static size_t trace_infoRead(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	char text[512];
+	size_t size = 0;
+	trace_category_t cat;
+
+	size += sprintf(text + size, "categories:");
+	for(cat = 0; cat < TRACE_CAT_MAX; cat++)
+		size += sprintf(text + size, " %s%s", (trace_enabled & (1u << cat)) ? "" : "-", trace_categories[cat]);
+
+	lock(&trace_read_lock);
+	uint64_t head = trace_buffer.head;
+	size += sprintf(text + size, "\nbuffer size: %u\nrecord size: %lu\nrecorded: %lu\nunread: %lu\nlost: %lu\n",
+			TRACE_BUFFER_SIZE, sizeof(trace_record_t), head,
+			(head - trace_buffer.tail < TRACE_BUFFER_SIZE) ? head - trace_buffer.tail : TRACE_BUFFER_SIZE, trace_buffer.lost);
+	unlock(&trace_read_lock);
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	return read;
+}
+
+void trace_Init(void)
+{
+	size_t pages = (TRACE_BUFFER_SIZE * (sizeof(trace_record_t) + sizeof(uint64_t)) + MM_BLOCK_SIZE - 1) / MM_BLOCK_SIZE;
+	void *mem = vmm_SysAlloc(pages);
+	if(mem == NULL)
+	{
+		printf("trace: Konnte keinen Speicher für den Puffer reservieren\n");
+		return;
+	}
+	memset(mem, 0, pages * MM_BLOCK_SIZE);
+	trace_buffer.commit = mem + TRACE_BUFFER_SIZE * sizeof(trace_record_t);
+	trace_buffer.records = mem;
+
+	lockstat_register(&trace_read_lock, "trace");
+	vfs_RegisterInfoFile("trace", trace_infoRead, NULL);
+
+	vfs_device_t *dev = malloc(sizeof(vfs_device_t));
+	dev->opaque = &trace_buffer;
+	dev->read = trace_readHandler;
+	dev->write = trace_writeHandler;
+	dev->readv = NULL;
+	dev->writev = NULL;
+	dev->getValue = trace_getValue;
+	vfs_RegisterDevice(dev);
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * trace.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "stdint.h"
+#include "stddef.h"
+
+/*
+ * Statische Tracepoints. Ein Tracepoint schreibt einen Eintrag mit TSC-Zeitstempel in einen
+ * Ringpuffer, ohne ein Lock zu nehmen, und darf deshalb auch in Interrupthandlern verwendet werden.
+ * Die Kategorien werden zur Laufzeit einzeln eingeschaltet, ausgeschaltete Tracepoints kosten
+ * nur einen Vergleich.
+ * Über /dev/trace werden die Einträge als trace_record_t gelesen (gelesene Einträge werden
+ * entfernt). Durch Schreiben von Kategorienamen (z.B. "sched mm -vfs", "all" oder "none") werden
+ * Kategorien ein- oder ausgeschaltet. Der Zustand ist unter /sysinf/trace abrufbar.
+ */
+
+typedef enum{
+	TRACE_CAT_SCHED,
+	TRACE_CAT_MM,
+	TRACE_CAT_SYSCALL,
+	TRACE_CAT_CACHE,
+	TRACE_CAT_STORAGE,
+	TRACE_CAT_VFS,
+	TRACE_CAT_MAX
+}trace_category_t;
+
+//Die Kategorie steht im oberen Byte der Ereignisnummer
+#define TRACE_EVENT(category, nr)	(((category) << 8) | (nr))
+
+typedef enum{
+	TRACE_SCHED_SWITCH		= TRACE_EVENT(TRACE_CAT_SCHED, 0),		//arg0 = alter Thread, arg1 = neuer Thread
+	TRACE_PAGEFAULT			= TRACE_EVENT(TRACE_CAT_MM, 0),			//arg0 = Adresse, arg1 = Fehlercode
+	TRACE_SYSCALL_ENTER		= TRACE_EVENT(TRACE_CAT_SYSCALL, 0),	//arg0 = Funktion, arg1 = 1. Parameter
+	TRACE_SYSCALL_EXIT		= TRACE_EVENT(TRACE_CAT_SYSCALL, 1),	//arg0 = Funktion, arg1 = Rückgabewert
+	TRACE_CACHE_GET			= TRACE_EVENT(TRACE_CAT_CACHE, 0),		//arg0 = Blocknummer, arg1 = 1 wenn im Cache
+	TRACE_AHCI_REQUEST		= TRACE_EVENT(TRACE_CAT_STORAGE, 0),	//arg0 = LBA, arg1 = Anzahl Bytes
+	TRACE_AHCI_COMPLETE		= TRACE_EVENT(TRACE_CAT_STORAGE, 1),	//arg0 = LBA, arg1 = Rückgabewert
+	TRACE_VFS_READ			= TRACE_EVENT(TRACE_CAT_VFS, 0),		//arg0 = Stream, arg1 = Anzahl Bytes
+	TRACE_VFS_READ_DONE		= TRACE_EVENT(TRACE_CAT_VFS, 1)			//arg0 = Stream, arg1 = gelesene Bytes
+}trace_event_t;
+
+//Format eines Eintrags in /dev/trace
+typedef struct{
+	uint64_t tsc;
+	uint32_t tid;			//Aktueller Thread, 0 wenn keiner läuft
+	uint16_t event;			//trace_event_t
+	uint16_t cpu;
+	uint64_t arg0;
+	uint64_t arg1;
+}trace_record_t;
+
+//Bitmaske der eingeschalteten Kategorien
+extern volatile uint32_t trace_enabled;
+
+#define TRACE(event, arg0, arg1) do{\
+		if(__builtin_expect(trace_enabled & (1u << ((event) >> 8)), 0))\
+			trace_record((event), (uint64_t)(arg0), (uint64_t)(arg1));\
+	}while(0)
+
+void trace_Init(void);
+
+//Schreibt einen Eintrag. Sollte nur über das Makro TRACE aufgerufen werden.
+void trace_record(trace_event_t event, uint64_t arg0, uint64_t arg1);
+
+#endif /* TRACE_H_ */
+
+#endif
@@ -2,77 +2,157 @@
 #include <stdlib.h>
 #include <assert.h>
 
-static const uint64_t primes[] = {101, 211, 431, 863, 1733, 3467, 6947, 13901, 27803, 55609, 111227, 222461, 444929, 889871, 1779761, 3559537, 7119103, 14238221, 28476473, 56952947, 113905901, 227811809, 455623621, 911247257, 1822494581, 3644989199, 7289978407, 14579956817, 29159913637, 58319827297, 116639654657};
-static const uint64_t h_primes[] = {97, 199, 421, 859, 1723, 3463, 6917, 13883, 27799, 55603, 111217, 222437, 444901, 889829, 1779709, 3559519, 7119067, 14238199, 28476439, 56952943, 113905877, 227811797, 455623607, 911247199, 1822494511, 3644989099, 7289978357, 14579956813, 29159913623, 58319827273, 116639654581};
-static const uint8_t prime_count = sizeof(primes) / sizeof(uint64_t);
+/*
+ * Open addressing with robin hood linear probing over a power of two sized table.
+ * Growing the table allocates the new table and then migrates a few entries of the old one
+ * with every modifying operation, so no single insertion pays for a full rehash.
+ * Lookups check the new table first and then the remaining part of the old one.
+ */
 
-typedef enum {
-	entry_state_empty,
-	entry_state_in_use,
-	entry_state_deleted = 0
-} _hash_map_entry_state_e;
+#define HASH_USED (1ull << 63) /*set in every stored hash, so 0 marks an empty entry*/
+#define HASH_MIGRATED 1 /*entry of the old table which has been migrated or deleted*/
+#define MIGRATE_STEP 8 /*old entries migrated per modifying operation*/
+#define MIN_SIZE 16
 
 struct _hash_map_entry {
+	uint64_t hash;
 	const void* key;
 	const void* entry;
-	_hash_map_entry_state_e state;
 };
 
+static uint64_t _hash(hashmap_t* map, const void* key) {
+	/*Mix the bits since only the lower ones select the bucket*/
+	uint64_t hash = map->hash(key, map->context);
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	return hash | HASH_USED;
+}
+
+static uint64_t _distance(uint64_t hash, uint64_t index, uint64_t mask) {
+	return (index - hash) & mask;
+}
+
 static _hash_map_entry_t* _cleared_entry_array(size_t size) {
 	 _hash_map_entry_t* ret = calloc(size, sizeof(_hash_map_entry_t));
 	return ret;
 }
 
-static void _insert_no_check_empty(hashmap_t* map, const void* key, const void* obj) {
-	uint64_t hash = map->hash1(key, map->context) % primes[map->prime_index];
-	uint64_t hash2 = map->hash2(key, map->context) % h_primes[map->prime_index] + 1;
-	_hash_map_entry_t* entry = &(map->entries[hash]);
-	while (entry->state != entry_state_empty) {
-		hash = (hash + hash2) % primes[map->prime_index];
-		entry = &(map->entries[hash]);
+static void _insert_no_check(_hash_map_entry_t* entries, uint64_t mask, uint64_t hash, const void* key, const void* obj) {
+	uint64_t index = hash & mask;
+	uint64_t dist = 0;
+	while (entries[index].hash) {
+		uint64_t existing_dist = _distance(entries[index].hash, index, mask);
+		if (existing_dist < dist) {
+			/*Take the place of the richer entry and continue with it*/
+			_hash_map_entry_t tmp = entries[index];
+			entries[index].hash = hash;
+			entries[index].key = key;
+			entries[index].entry = obj;
+			hash = tmp.hash;
+			key = tmp.key;
+			obj = tmp.entry;
+			dist = existing_dist;
+		}
+		index = (index + 1) & mask;
+		dist++;
+	}
+	entries[index].hash = hash;
+	entries[index].key = key;
+	entries[index].entry = obj;
+}
+
+static _hash_map_entry_t* _find(hashmap_t* map, _hash_map_entry_t* entries, uint64_t mask, uint64_t hash, const void* key) {
+	uint64_t index = hash & mask;
+	uint64_t dist = 0;
+	while (entries[index].hash) {
+		if (entries[index].hash == hash) {
+			if (map->equal(key, entries[index].key, map->context)) return &entries[index];
+		} else if (entries[index].hash != HASH_MIGRATED && _distance(entries[index].hash, index, mask) < dist) {
+			/*The key would have displaced this entry*/
+			break;
+		}
+		index = (index + 1) & mask;
+		dist++;
+	}
+	return NULL;
+}
+
+static _hash_map_entry_t* _lookup(hashmap_t* map, uint64_t hash, const void* key, bool* old) {
+	_hash_map_entry_t* entry = _find(map, map->entries, map->mask, hash, key);
+	*old = false;
+	if (!entry && map->old_entries) {
+		entry = _find(map, map->old_entries, map->old_mask, hash, key);
+		*old = true;
+	}
+	return entry;
+}
+
+/*Backward shift deletion, keeps the table free of tombstones.*/
+static void _remove(_hash_map_entry_t* entries, uint64_t mask, _hash_map_entry_t* entry) {
+	uint64_t index = entry - entries;
+	uint64_t next = (index + 1) & mask;
+	while (entries[next].hash && _distance(entries[next].hash, next, mask) > 0) {
+		entries[index] = entries[next];
+		index = next;
+		next = (next + 1) & mask;
 	}
-	entry->state = entry_state_in_use;
-	entry->entry = obj;
-	entry->key = key;
-}
-
-static void _rehash(hashmap_t* map) {
-	size_t old_size = primes[map->prime_index];
-	size_t new_size = primes[++(map->prime_index)];
-	_hash_map_entry_t* old_entries = map->entries;
-	map->entries = _cleared_entry_array(new_size);
-	size_t i;
-	for (i = 0; i < old_size; i++) {
-		if (old_entries[i].state == entry_state_in_use) {
-			_insert_no_check_empty(map, old_entries[i].key, old_entries[i].entry);
+	entries[index].hash = 0;
+}
+
+static void _migrate(hashmap_t* map, uint64_t steps) {
+	while (map->old_entries && steps--) {
+		_hash_map_entry_t* entry = &map->old_entries[map->migrate_index];
+		if (entry->hash & HASH_USED) {
+			_insert_no_check(map->entries, map->mask, entry->hash, entry->key, entry->entry);
+			entry->hash = HASH_MIGRATED;
+		}
+		if (map->migrate_index++ == map->old_mask) {
+			free(map->old_entries);
+			map->old_entries = NULL;
 		}
 	}
 }
 
+static bool _grow(hashmap_t* map) {
+	/*Finish a running migration first, there can only be one old table*/
+	_migrate(map, UINT64_MAX);
+	uint64_t new_size = (map->mask + 1) * 2;
+	_hash_map_entry_t* new_entries = _cleared_entry_array(new_size);
+	if (!new_entries) return false;
+	map->old_entries = map->entries;
+	map->old_mask = map->mask;
+	map->migrate_index = 0;
+	map->entries = new_entries;
+	map->mask = new_size - 1;
+	return true;
+}
+
 hashmap_t* hashmap_create(
-	uint64_t (*hash1)(const void* key, void* context), /*Hash function used for lookup / insertion. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
-	uint64_t (*hash2)(const void* key, void* context), /*Hash function used for collision resolution. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
+	uint64_t (*hash)(const void* key, void* context), /*Hash function used for lookup / insertion. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
 	bool (*equal)(const void* key1, const void* key2, void* context), /*Function used to test for key equality.*/
 	void (*free_key)(const void* key),
 	void (*free_obj)(const void* obj),
 	void* context, /*value passed to hash and equality functions as context parameter*/
 	size_t min_size /*expected amount of entries in hashtable*/
 ) {
-	assert(min_size < UINT64_MAX / 2 && "Requested size too large");
+	assert(min_size < UINT64_MAX / 4 && "Requested size too large");
 	min_size *= 2;
-	assert(hash1 && "Hash functions need to be defined.");
-	assert(hash2 && "Hash functions need to be defined.");
+	assert(hash && "Hash function needs to be defined.");
 	assert(equal && "Equal function needs to be defined.");
-	assert(min_size <= primes[prime_count - 1] && "Requested size exeeds maximum supported size.");
 	hashmap_t* ret = malloc(sizeof(hashmap_t));
 	if (!ret) goto ret_alloc_failed;
-	for (ret->prime_index = 0; ret->prime_index < prime_count && primes[ret->prime_index] < min_size; ret->prime_index++);
-	ret->entries = _cleared_entry_array(primes[ret->prime_index]);
+	uint64_t size;
+	for (size = MIN_SIZE; size < min_size; size *= 2);
+	ret->entries = _cleared_entry_array(size);
 	if (!ret->entries) goto entry_alloc_failed;
+	ret->mask = size - 1;
+	ret->old_entries = NULL;
+	ret->old_mask = 0;
+	ret->migrate_index = 0;
 	ret->context = context;
 	ret->equal = equal;
-	ret->hash1 = hash1;
-	ret->hash2 = hash2;
+	ret->hash = hash;
 	ret->count = 0;
 	ret->free_key = free_key;
 	ret->free_obj = free_obj;
@@ -87,69 +167,95 @@ hashmap_t* hashmap_create_min(
 	uint64_t (*hash)(const void* key, void* context), /*Hash function used for lookup / insertion. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
 	bool (*equal)(const void* key1, const void* key2, void* context) /*Function used to test for key equality.*/
 ) {
-	return hashmap_create(hash, hash, equal, NULL, NULL, NULL, 0);
+	return hashmap_create(hash, equal, NULL, NULL, NULL, 0);
 }
 
-int hashmap_search(hashmap_t* map, const void* key, void** result) {
-	uint64_t hash = map->hash1(key, map->context) % primes[map->prime_index];
-	uint64_t hash2 = map->hash2(key, map->context) % h_primes[map->prime_index] + 1;
-	_hash_map_entry_t* entry = &(map->entries[hash]);
-	while (entry->state != entry_state_empty) {
-		if (entry->state == entry_state_in_use) {
-			if (map->equal(key, entry->key, map->context)) {
-				if (result) *result = (void*)entry->entry;
-				return 1;
-			}
-		}
-		hash = (hash + hash2) % primes[map->prime_index];
-		entry = &(map->entries[hash]);
+void hashmap_destroy(hashmap_t* map) {
+	hashmap_iterator_t it;
+	const void* key;
+	void* obj;
+	hashmap_iterator_init(map, &it);
+	while (hashmap_iterator_next(&it, &key, &obj)) {
+		if (map->free_key) map->free_key(key);
+		if (map->free_obj) map->free_obj(obj);
 	}
-	return 0;
+	free(map->old_entries);
+	free(map->entries);
+	free(map);
+}
+
+int hashmap_search(hashmap_t* map, const void* key, void** result) {
+	bool old;
+	_hash_map_entry_t* entry = _lookup(map, _hash(map, key), key, &old);
+	if (!entry) return 0;
+	if (result) *result = (void*)entry->entry;
+	return 1;
 }
 
 int hashmap_delete(hashmap_t* map, const void* key) {
-	uint64_t hash = map->hash1(key, map->context) % primes[map->prime_index];
-	uint64_t hash2 = map->hash2(key, map->context) % h_primes[map->prime_index] + 1;
-	_hash_map_entry_t* entry = &(map->entries[hash]);
-	while (entry->state != entry_state_empty) {
-		if (entry->state == entry_state_in_use) {
-			if (map->equal(key, entry->key, map->context)) {
-				if (map->free_key) map->free_key(entry->key);
-				if (map->free_obj) map->free_obj(entry->entry);
-				entry->state = entry_state_deleted;
-				map->count++;
-				return 1;
-			}
-		}
-		hash = (hash + hash2) % primes[map->prime_index];
-		entry = &(map->entries[hash]);
-	}
-	return 0;
+	uint64_t hash = _hash(map, key);
+	bool old;
+	_migrate(map, MIGRATE_STEP);
+	_hash_map_entry_t* entry = _lookup(map, hash, key, &old);
+	if (!entry) return 0;
+	if (map->free_key) map->free_key(entry->key);
+	if (map->free_obj) map->free_obj(entry->entry);
+	/*Entries of the old table must stay where they are until they are migrated*/
+	if (old) entry->hash = HASH_MIGRATED;
+	else _remove(map->entries, map->mask, entry);
+	map->count--;
+	return 1;
 }
 
 int hashmap_set(hashmap_t* map, const void* key, const void* obj) {
-	uint64_t hash = map->hash1(key, map->context) % primes[map->prime_index];
-	uint64_t hash2 = map->hash2(key, map->context) % h_primes[map->prime_index] + 1;
-	_hash_map_entry_t* entry = &(map->entries[hash]);
-	_hash_map_entry_t* del_entry = NULL;
-	while (entry->state != entry_state_empty) {
-		if (entry->state == entry_state_in_use) {
-			if (map->equal(key, entry->key, map->context)) {
-				if (map->free_obj) map->free_obj(entry->entry);
-				entry->entry = obj;
-				return 1;
+	uint64_t hash = _hash(map, key);
+	bool old;
+	_migrate(map, MIGRATE_STEP);
+	_hash_map_entry_t* entry = _lookup(map, hash, key, &old);
+	if (entry) {
+		if (map->free_obj) map->free_obj(entry->entry);
+		entry->entry = obj;
+		return HASH_MAP_SUCCESS_FOUND;
+	}
+	if (map->count + 1 > (map->mask + 1) / 8 * 7 && !_grow(map)) return HASH_MAP_NO_MEMORY;
+	_insert_no_check(map->entries, map->mask, hash, key, obj);
+	map->count++;
+	return HASH_MAP_SUCCESS;
+}
+
+size_t hashmap_count(hashmap_t* map) {
+	return map->count;
+}
+
+void hashmap_iterator_init(hashmap_t* map, hashmap_iterator_t* it) {
+	it->map = map;
+	it->old = map->old_entries != NULL;
+	it->index = it->old ? map->migrate_index : 0;
+}
+
+bool hashmap_iterator_next(hashmap_iterator_t* it, const void** key, void** obj) {
+	hashmap_t* map = it->map;
+	if (it->old) {
+		for (; it->index <= map->old_mask; it->index++) {
+			_hash_map_entry_t* entry = &map->old_entries[it->index];
+			if (entry->hash & HASH_USED) {
+				if (key) *key = entry->key;
+				if (obj) *obj = (void*)entry->entry;
+				it->index++;
+				return true;
 			}
-		} else if (!del_entry) {
-			del_entry = entry;
 		}
-		hash = (hash + hash2) % primes[map->prime_index];
-		entry = &(map->entries[hash]);
+		it->old = false;
+		it->index = 0;
 	}
-	if (del_entry) entry = del_entry;
-	entry->state = entry_state_in_use;
-	entry->entry = obj;
-	entry->key = key;
-	map->count++;
-	if (map->count > 3 * primes[map->prime_index] / 4) _rehash(map);
-	return 0;
+	for (; it->index <= map->mask; it->index++) {
+		_hash_map_entry_t* entry = &map->entries[it->index];
+		if (entry->hash) {
+			if (key) *key = entry->key;
+			if (obj) *obj = (void*)entry->entry;
+			it->index++;
+			return true;
+		}
+	}
+	return false;
 }
@@ -23,20 +23,27 @@ struct _hash_map_entry;
 typedef struct _hash_map_entry _hash_map_entry_t;
 
 typedef struct {
-	uint64_t (*hash1)(const void* key, void* context);
-	uint64_t (*hash2)(const void* key, void* context);
+	uint64_t (*hash)(const void* key, void* context);
 	void (*free_key)(const void* key);
 	void (*free_obj)(const void* obj);
 	bool (*equal)(const void* key1, const void* key2, void* context);
 	void* context;
 	_hash_map_entry_t* entries;
+	uint64_t mask; /*size of entries - 1, size is always a power of two*/
+	_hash_map_entry_t* old_entries; /*table which is still being migrated after a resize, NULL otherwise*/
+	uint64_t old_mask;
+	uint64_t migrate_index; /*entries of old_entries below this index are already migrated*/
 	uint64_t count;
-	uint8_t prime_index;
 } hashmap_t;
 
+typedef struct {
+	hashmap_t* map;
+	bool old; /*currently iterating over old_entries*/
+	uint64_t index;
+} hashmap_iterator_t;
+
 hashmap_t* hashmap_create(
-	uint64_t (*hash1)(const void* key, void* context), /*Hash function used for lookup / insertion. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
-	uint64_t (*hash2)(const void* key, void* context), /*Hash function used for collision resolution. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
+	uint64_t (*hash)(const void* key, void* context), /*Hash function used for lookup / insertion. Has to satisfy equal(key1, key2) => hash(key1) == hash(key2).*/
 	bool (*equal)(const void* key1, const void* key2, void* context), /*Function used to test for key equality.*/
 	void (*free_key)(const void* key),
 	void (*free_obj)(const void* obj),
@@ -49,10 +56,20 @@ hashmap_t* hashmap_create_min(
 	bool (*equal)(const void* key1, const void* key2, void* context) /*Function used to test for key equality.*/
 );
 
+void hashmap_destroy(hashmap_t* map);
+
 int hashmap_search(hashmap_t* map, const void* key, void** result);
 
 int hashmap_delete(hashmap_t* map, const void* key);
 
 int hashmap_set(hashmap_t* map, const void* key, const void* obj);
 
+size_t hashmap_count(hashmap_t* map);
+
+/*The map must not be modified while iterating over it.*/
+void hashmap_iterator_init(hashmap_t* map, hashmap_iterator_t* it);
+
+/*Returns false when all entries have been visited. key and obj may be NULL.*/
+bool hashmap_iterator_next(hashmap_iterator_t* it, const void** key, void** obj);
+
 #endif /* HASHMAP_H_ */
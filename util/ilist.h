@@ -0,0 +1,111 @@
+/*
+ * ilist.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifndef ILIST_H_
+#define ILIST_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+/*
+ * Intrusive, doppelt verkettete Liste. Die Knoten sind direkt in den Elementen eingebettet,
+ * dadurch braucht Einfügen und Entfernen keinen Speicher und geht in O(1).
+ * Die Liste ist ringförmig mit dem Kopf als Wächterknoten.
+ */
+typedef struct ilist_node{
+	struct ilist_node *prev;
+	struct ilist_node *next;
+}ilist_node_t;
+
+typedef struct{
+	ilist_node_t head;
+	size_t size;
+}ilist_t;
+
+//Statische Initialisierung einer Liste: ilist_t list = ILIST_INIT(list);
+#define ILIST_INIT(list)	{.head = {.prev = &(list).head, .next = &(list).head}, .size = 0}
+
+//Gibt das Element zurück, in dem der Knoten eingebettet ist
+#define ILIST_ENTRY(node, type, member)	((type*)((uintptr_t)(node) - offsetof(type, member)))
+
+//Iteriert über alle Knoten. Der aktuelle Knoten darf nicht entfernt werden.
+#define ilist_foreach(node, list) \
+	for((node) = (list)->head.next; (node) != &(list)->head; (node) = (node)->next)
+
+//Iteriert über alle Knoten. Der aktuelle Knoten darf entfernt werden.
+#define ilist_foreach_safe(node, tmp, list) \
+	for((node) = (list)->head.next, (tmp) = (node)->next; (node) != &(list)->head; (node) = (tmp), (tmp) = (node)->next)
+
+static inline void ilist_init(ilist_t *list)
+{
+	list->head.prev = list->head.next = &list->head;
+	list->size = 0;
+}
+
+static inline bool ilist_empty(const ilist_t *list)
+{
+	return list->head.next == &list->head;
+}
+
+static inline size_t ilist_size(const ilist_t *list)
+{
+	return list->size;
+}
+
+/*
+ * Fügt node vor pos ein. pos kann auch der Kopf der Liste sein (Einfügen am Ende).
+ */
+static inline void ilist_insert_before(ilist_t *list, ilist_node_t *pos, ilist_node_t *node)
+{
+	node->next = pos;
+	node->prev = pos->prev;
+	pos->prev->next = node;
+	pos->prev = node;
+	list->size++;
+}
+
+static inline void ilist_push_front(ilist_t *list, ilist_node_t *node)
+{
+	ilist_insert_before(list, list->head.next, node);
+}
+
+static inline void ilist_push_back(ilist_t *list, ilist_node_t *node)
+{
+	ilist_insert_before(list, &list->head, node);
+}
+
+static inline void ilist_remove(ilist_t *list, ilist_node_t *node)
+{
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	node->prev = node->next = NULL;
+	list->size--;
+}
+
+//Gibt den ersten Knoten zurück oder NULL, wenn die Liste leer ist
+static inline ilist_node_t *ilist_first(const ilist_t *list)
+{
+	return ilist_empty(list) ? NULL : list->head.next;
+}
+
+//Gibt den letzten Knoten zurück oder NULL, wenn die Liste leer ist
+static inline ilist_node_t *ilist_last(const ilist_t *list)
+{
+	return ilist_empty(list) ? NULL : list->head.prev;
+}
+
+//Entfernt den ersten Knoten und gibt ihn zurück oder NULL, wenn die Liste leer ist
+static inline ilist_node_t *ilist_pop_front(ilist_t *list)
+{
+	ilist_node_t *node = ilist_first(list);
+	if(node != NULL)
+		ilist_remove(list, node);
+	return node;
+}
+
+#endif /* ILIST_H_ */
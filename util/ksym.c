@@ -0,0 +1,48 @@
+/*
+ * ksym.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "ksym.h"
+
+//Werden beim zweiten Linkschritt definiert, sonst sind die Adressen 0
+extern const ksym_t kernel_symbols[] __attribute__((weak));
+extern const size_t kernel_symbols_count __attribute__((weak));
+
+extern uint8_t kernel_code_start, kernel_code_end;
+
+size_t ksym_count(void)
+{
+	return (&kernel_symbols_count != NULL && kernel_symbols != NULL) ? kernel_symbols_count : 0;
+}
+
+const ksym_t *ksym_get(size_t index)
+{
+	return (index < ksym_count()) ? &kernel_symbols[index] : NULL;
+}
+
+size_t ksym_find(uintptr_t address)
+{
+	size_t low = 0, high = ksym_count();
+
+	if(high == 0 || address < kernel_symbols[0].address
+			|| address < (uintptr_t)&kernel_code_start || address >= (uintptr_t)&kernel_code_end)
+		return KSYM_UNKNOWN;
+
+	//Binäre Suche nach dem letzten Symbol mit address <= Adresse
+	while(high - low > 1)
+	{
+		size_t mid = low + (high - low) / 2;
+		if(kernel_symbols[mid].address <= address)
+			low = mid;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * ksym.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef KSYM_H_
+#define KSYM_H_
+
+#include "stdint.h"
+#include "stddef.h"
+
+/*
+ * Symboltabelle des Kernels. Die Tabelle wird beim Bauen in einem zweiten Linkschritt hinzugefügt:
+ * mksyms.sh erzeugt aus den Codesymbolen (Typ t und T) von "nm -n" über den zuerst gelinkten Kernel
+ * eine Quelldatei mit dem nach Adressen sortierten Array kernel_symbols und dessen Länge
+ * kernel_symbols_count, die mitgelinkt wird. Ohne diese Datei ist die Tabelle leer und es
+ * werden keine Adressen aufgelöst.
+ */
+
+typedef struct{
+	uintptr_t address;
+	const char *name;
+}ksym_t;
+
+#define KSYM_UNKNOWN	((size_t)-1)
+
+//Anzahl Symbole in der Tabelle
+size_t ksym_count(void);
+
+//Gibt das Symbol mit dem Index index zurück
+const ksym_t *ksym_get(size_t index);
+
+/*
+ * Sucht das Symbol, in dem eine Adresse liegt
+ * Parameter:	address = Codeadresse
+ * Rückgabe:	Index des Symbols oder KSYM_UNKNOWN
+ */
+size_t ksym_find(uintptr_t address);
+
+#endif /* KSYM_H_ */
+
+#endif
@@ -228,3 +228,64 @@ size_t list_size(list_t list)
 
 	return list->Size;
 }
+
+/*
+ * Initialisiert einen Iterator, der beim ersten Element (Index 0) beginnt
+ *
+ * @param list Liste, über die iteriert werden soll
+ * @param it Zu initialisierender Iterator
+ */
+void list_iterator_init(list_t list, list_iterator_t *it)
+{
+	it->list = list;
+	it->prev = NULL;
+	it->node = NULL;
+}
+
+/*
+ * Geht zum nächsten Element weiter und gibt dessen Wert zurück
+ *
+ * @param it Iterator
+ * @return Wert des nächsten Elements oder NULL, wenn das Ende der Liste erreicht ist
+ */
+void* list_iterator_next(list_iterator_t *it)
+{
+	if(!it->list) return NULL;
+
+	struct list_node *next;
+	if(it->node != NULL)
+	{
+		it->prev = it->node;
+		next = it->node->Next;
+	}
+	else
+		next = (it->prev != NULL) ? it->prev->Next : it->list->Anchor;
+
+	it->node = next;
+	return (next != NULL) ? next->Value : NULL;
+}
+
+/*
+ * Entfernt das aktuelle Element (das zuletzt von list_iterator_next zurückgegebene) in O(1).
+ * Danach kann normal mit list_iterator_next weiteriteriert werden.
+ *
+ * @param it Iterator
+ * @return Wert des entfernten Elements oder NULL, wenn es kein aktuelles Element gibt
+ */
+void* list_iterator_remove(list_iterator_t *it)
+{
+	struct list_node *Node = it->node;
+	if(Node == NULL) return NULL;
+
+	void *value = Node->Value;
+	if(it->prev != NULL)
+		it->prev->Next = Node->Next;
+	else
+		it->list->Anchor = Node->Next;
+	free(Node);
+
+	it->list->Size--;
+	it->node = NULL;
+
+	return value;
+}
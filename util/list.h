@@ -28,6 +28,28 @@
  */
 typedef struct list_implementation* list_t;
 
+struct list_node;
+
+/*
+ * Iterator über eine Liste. Die Felder dürfen nur von den list_iterator_*-Funktionen
+ * verwendet werden.
+ */
+typedef struct{
+	list_t list;
+	struct list_node *prev;		//Knoten vor dem aktuellen Knoten
+	struct list_node *node;		//Aktueller Knoten (zuletzt von list_iterator_next zurückgegeben)
+}list_iterator_t;
+
+/*
+ * Iteriert über alle Werte einer Liste
+ *
+ * @param list Liste, über die iteriert werden soll
+ * @param it Iterator (list_iterator_t)
+ * @param value Variable, in der der aktuelle Wert gespeichert wird
+ */
+#define list_foreach(list, it, value) \
+	for(list_iterator_init(list, &(it)); ((value) = list_iterator_next(&(it))) != NULL;)
+
 
 /*
  * Erzeugt eine neue Liste
@@ -114,4 +136,29 @@ void* list_remove(list_t list, size_t index);
  */
 size_t list_size(list_t list);
 
+/*
+ * Initialisiert einen Iterator, der beim ersten Element (Index 0) beginnt
+ *
+ * @param list Liste, über die iteriert werden soll
+ * @param it Zu initialisierender Iterator
+ */
+void list_iterator_init(list_t list, list_iterator_t *it);
+
+/*
+ * Geht zum nächsten Element weiter und gibt dessen Wert zurück
+ *
+ * @param it Iterator
+ * @return Wert des nächsten Elements oder NULL, wenn das Ende der Liste erreicht ist
+ */
+void* list_iterator_next(list_iterator_t *it);
+
+/*
+ * Entfernt das aktuelle Element (das zuletzt von list_iterator_next zurückgegebene) in O(1).
+ * Danach kann normal mit list_iterator_next weiteriteriert werden.
+ *
+ * @param it Iterator
+ * @return Wert des entfernten Elements oder NULL, wenn es kein aktuelles Element gibt
+ */
+void* list_iterator_remove(list_iterator_t *it);
+
 #endif /* LIST_H_ */
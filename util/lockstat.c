@@ -0,0 +1,189 @@
+/*
+ * lockstat.c
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#include "lockstat.h"
+#include "config.h"
+#include "cpu.h"
+#include "vfs.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#ifdef LOCK_PROFILING
+
+#define LOCKSTAT_MAX	64		//Maximale Anzahl angemeldeter Locks (Zweierpotenz)
+
+typedef struct{
+	lock_t *lock;
+	const char *name;
+	uint64_t acquired;		//Anzahl, wie oft der Lock geholt wurde
+	uint64_t contended;		//Anzahl, wie oft dabei gewartet werden musste
+	uint64_t spins;			//Anzahl Warteschleifen insgesamt
+	uint64_t max_hold;		//Längste Haltezeit in TSC-Ticks
+	uint64_t hold_start;	//TSC beim Holen des Locks
+}lockstat_t;
+
+//Die Statistik eines Locks wird nur verändert, während der Lock gehalten wird
+static lockstat_t lockstat_table[LOCKSTAT_MAX];
+static volatile uint64_t lockstat_reg_lock = 0;
+
+static inline size_t lockstat_hash(const lock_t *l)
+{
+	return (((uintptr_t)l >> 3) * 0x9E3779B97F4A7C15ul) >> 58;
+}
+
+/*
+ * Sucht den Eintrag eines Locks
+ * Rückgabe:	Eintrag oder NULL, wenn der Lock nicht angemeldet ist
+ */
+static lockstat_t *lockstat_find(const lock_t *l)
+{
+	size_t i, index = lockstat_hash(l);
+	for(i = 0; i < LOCKSTAT_MAX; i++)
+	{
+		lockstat_t *entry = &lockstat_table[(index + i) & (LOCKSTAT_MAX - 1)];
+		if(entry->lock == l)
+			return entry;
+		if(entry->lock == NULL)
+			break;
+	}
+	return NULL;
+}
+
+void lockstat_register(lock_t *l, const char *name)
+{
+	size_t i, index = lockstat_hash(l);
+
+	//Hier kein lock() verwenden, sonst würde die Statistik rekursiv aufgerufen
+	while(!__sync_bool_compare_and_swap(&lockstat_reg_lock, 0, 1))
+		asm volatile("pause");
+
+	for(i = 0; i < LOCKSTAT_MAX; i++)
+	{
+		lockstat_t *entry = &lockstat_table[(index + i) & (LOCKSTAT_MAX - 1)];
+		if(entry->lock == l)
+			break;
+		if(entry->lock == NULL)
+		{
+			entry->name = name;
+			//Der Lock darf erst sichtbar werden, wenn der Eintrag vollständig ist
+			asm volatile("" : : : "memory");
+			entry->lock = l;
+			break;
+		}
+	}
+
+	asm volatile("" : : : "memory");
+	lockstat_reg_lock = 0;
+}
+
+void lockstat_acquired(lock_t *l, bool contended, uint64_t spins)
+{
+	lockstat_t *entry = lockstat_find(l);
+	if(entry == NULL)
+		return;
+
+	entry->acquired++;
+	if(contended)
+		entry->contended++;
+	entry->spins += spins;
+	entry->hold_start = cpu_rdtsc();
+}
+
+void lockstat_released(lock_t *l)
+{
+	lockstat_t *entry = lockstat_find(l);
+	if(entry == NULL || entry->hold_start == 0)
+		return;
+
+	uint64_t hold = cpu_rdtsc() - entry->hold_start;
+	if(hold > entry->max_hold)
+		entry->max_hold = hold;
+	entry->hold_start = 0;
+}
+
+/*
+ * Gibt die Statistik als Text aus, nach Anzahl Wartefälle absteigend sortiert
+ */
+static size_t lockstat_read(const char *name, uint64_t start, size_t length, void *buffer)
+{
+	size_t count = 0, i, j;
+
+	lockstat_t *snapshot = malloc(LOCKSTAT_MAX * sizeof(lockstat_t));
+	if(snapshot == NULL)
+		return 0;
+
+	for(i = 0; i < LOCKSTAT_MAX; i++)
+	{
+		if(lockstat_table[i].lock == NULL)
+			continue;
+		lockstat_t entry = lockstat_table[i];
+
+		//Insertion sort
+		for(j = count; j > 0 && snapshot[j - 1].contended < entry.contended; j--)
+			snapshot[j] = snapshot[j - 1];
+		snapshot[j] = entry;
+		count++;
+	}
+
+	//Jede Zeile ist höchstens 24 + 4 * 21 Zeichen lang
+	char *text = malloc(80 + count * 110);
+	if(text == NULL)
+	{
+		free(snapshot);
+		return 0;
+	}
+
+	size_t size = sprintf(text, "%-24s %20s %20s %20s %20s\n", "name", "acquired", "contended", "spins", "max hold (tsc)");
+	for(i = 0; i < count; i++)
+	{
+		size += sprintf(text + size, "%-24s %20lu %20lu %20lu %20lu\n", snapshot[i].name, snapshot[i].acquired,
+				snapshot[i].contended, snapshot[i].spins, snapshot[i].max_hold);
+	}
+	free(snapshot);
+
+	size_t read = 0;
+	if(start < size)
+	{
+		read = (length < size - start) ? length : size - start;
+		memcpy(buffer, text + start, read);
+	}
+	free(text);
+	return read;
+}
+
+void lockstat_Init(void)
+{
+	extern void heap_registerLock(void);
+	heap_registerLock();
+
+	vfs_RegisterInfoFile("locks", lockstat_read, NULL);
+}
+
+#else
+
+void lockstat_Init(void)
+{
+}
+
+void lockstat_register(lock_t *l, const char *name)
+{
+}
+
+void lockstat_acquired(lock_t *l, bool contended, uint64_t spins)
+{
+}
+
+void lockstat_released(lock_t *l)
+{
+}
+
+#endif
+
+#endif
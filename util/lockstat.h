@@ -0,0 +1,39 @@
+/*
+ * lockstat.h
+ *
+ *  Created on: 19.10.2026
+ *      Author: pascal
+ */
+
+#ifdef BUILD_KERNEL
+
+#ifndef LOCKSTAT_H_
+#define LOCKSTAT_H_
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "lock.h"
+
+/*
+ * Statistik über die Verwendung von Locks. Wird nur gesammelt, wenn in config.h LOCK_PROFILING
+ * definiert ist. Sonst machen alle Funktionen nichts.
+ * Die Statistik ist unter /sysinf/locks abrufbar.
+ */
+
+void lockstat_Init(void);
+
+/*
+ * Meldet einen Lock für die Statistik an
+ * Parameter:	l = Lock
+ * 				name = Name, unter dem der Lock angezeigt wird (wird nicht kopiert)
+ */
+void lockstat_register(lock_t *l, const char *name);
+
+//Wird von lock.c aufgerufen, nachdem ein Lock geholt wurde
+void lockstat_acquired(lock_t *l, bool contended, uint64_t spins);
+//Wird von lock.c aufgerufen, bevor ein Lock freigegeben wird
+void lockstat_released(lock_t *l);
+
+#endif /* LOCKSTAT_H_ */
+
+#endif
@@ -7,8 +7,8 @@
 
 #include "system.h"
 #include "pmm.h"
+#include "pit.h"
 
-extern uint64_t Uptime;
 /*
  * Speichert Systeminformationen in die übergebene Struktur
  * Parameter:	Adresse auf die Systeminformationen-Struktur
@@ -17,5 +17,5 @@ void getSystemInformation(SIS *Struktur)
 {
 	Struktur->physSpeicher = pmm_getTotalPages() * 4096;
 	Struktur->physFree = pmm_getFreePages() * 4096;
-	Struktur->Uptime = Uptime;
+	Struktur->Uptime = pit_getUptime();
 }
@@ -79,10 +79,10 @@ void IntToHex(uint64_t Value, char *Destination)
 
 void Sleep(uint64_t msec)
 {
-	uint64_t start = Uptime;
+	uint64_t start = pit_getUptime();
 	while(1)
 	{
-		if(start + msec <= Uptime)
+		if(start + msec <= pit_getUptime())
 			break;
 		asm volatile("hlt");
 	}
@@ -12,16 +12,31 @@
 #include "stddef.h"
 #include "string.h"
 #include "stdlib.h"
-#include "list.h"
 #include "display.h"
 #include "stdio.h"
 #include "lock.h"
+#include "lockstat.h"
 #include "assert.h"
 #include "pm.h"
 #include "hashmap.h"
 #include "refcount.h"
+#include "dcache.h"
+#include "pagecache.h"
+#include "vmm.h"
+#include "memory.h"
+#include "ilist.h"
+#include "pmm.h"
+#include "semaphore.h"
+#include "scheduler.h"
+#include "trace.h"
 
-#define MAX_RES_BUFFER	100		//Anzahl an Ressourcen, die maximal geladen werden. Wenn der Buffer voll ist werden nicht benötigte Ressourcen überschrieben
+#define RES_CACHE_MIN			64		//Minimale Anzahl an Ressourcen, die gleichzeitig geladen sein dürfen
+#define RES_CACHE_PAGES_PER_RES	16		//Pro 16 physische Pages darf eine Ressource geladen sein
+#define RES_CACHE_LOW_MEMORY	16		//Wenn weniger als 1/16 des Speichers frei ist, wird nur das Minimum gecacht
+
+#define VFS_FD_TABLE_MIN	16		//Anfangsgrösse der Deskriptortabelle
+
+#define VFS_SPLICE_BUFFER	(16 * MM_BLOCK_SIZE)	//Grösse des Zwischenpuffers, wenn nicht aus dem Page-Cache übertragen werden kann
 
 #define VFS_MODE_READ	0x1
 #define VFS_MODE_WRITE	0x2
@@ -63,88 +78,245 @@ typedef struct vfs_node{
 		union{
 			vfs_device_t *dev;			//TYPE_DEVICE
 			struct cdi_fs_filesystem *fs;	//TYPE_MOUNT
-			size_t (*handler)(char *name, uint64_t start, size_t length, const void *buffer);
+			struct{
+				vfs_file_read_handler_t *read;
+				vfs_file_write_handler_t *write;
+			}file;								//TYPE_FILE
 		};
 		struct vfs_stream *stream;	//Stream, in dem die Node geöffnet ist
 }vfs_node_t;
 
+//Eintrag im Ressourcencache
+typedef struct{
+	struct cdi_fs_res *res;
+	struct cdi_fs_filesystem *fs;
+	ilist_node_t lru;	//Nur in der LRU-Liste eingehängt, wenn die Ressource nicht verwendet wird
+	bool evicting;		//Wird gerade entladen, loadRes muss warten
+}res_cache_entry_t;
+
 typedef struct vfs_stream{
 	struct cdi_fs_stream stream;
 	vfs_file_t id;
 	vfs_mode_t mode;
 
 	vfs_node_t *node;
+	semaphore_t lock;	//Serialisiert die Zugriffe des Treibers auf den Stream (nur TYPE_MOUNT)
 	REFCOUNT_FIELD;
 }vfs_stream_t;
 
-//Ein Stream vom Userspace hat eine ID, der auf einen Stream des Kernels gemappt ist
+/*
+ * Deskriptortabelle eines Prozesses. Ein Deskriptor ist der Index in das Array, die Einträge
+ * sind reservierte Streams. Das Array wird beim Vergrössern ersetzt.
+ */
 typedef struct{
-	vfs_file_t id;
-	vfs_file_t stream;
-	vfs_mode_t mode;
-}vfs_userspace_stream_t;
+	size_t size;
+	vfs_stream_t *streams[];
+}vfs_fd_array_t;
+
+typedef struct vfs_fd_table{
+	vfs_fd_array_t *volatile array;
+	volatile uint64_t readers;	//Anzahl laufender Lookups. Entfernte Einträge werden erst freigegeben, wenn keiner mehr läuft.
+	lock_t lock;				//Für Änderungen an der Tabelle
+}vfs_fd_table_t;
+
+//Page einer privaten Abbildung, die schon kopiert wurde
+#define MAPPING_PAGE_COPIED	((pagecache_page_t*)1)
+
+/*
+ * In einen Prozess gemappte Datei. Die Pages werden erst beim ersten Zugriff aus dem Page-Cache
+ * eingeblendet. Bei privaten Abbildungen wird eine Page beim ersten Schreibzugriff kopiert.
+ */
+typedef struct{
+	void *start;
+	size_t size;				//Anzahl Pages
+	uint64_t index;				//Index der ersten Page in der Datei
+	bool private;
+	vfs_stream_t *stream;		//Reservierter Stream
+	semaphore_t lock;			//Serialisiert die Page Faults
+	ilist_node_t node;			//In process_t.mappings
+	pagecache_page_t *pages[];	//Eingeblendete Pages aus dem Cache, NULL wenn noch nicht eingeblendet
+}vfs_mapping_t;
 
 static vfs_node_t root;
 static uint8_t nextPartID = 0;
-static list_t res_list;
+static hashmap_t *res_cache = NULL;	//Geladene Ressourcen: struct cdi_fs_res* -> res_cache_entry_t*
+static ilist_t res_lru = ILIST_INIT(res_lru);	//Unbenutzte Ressourcen, am längsten nicht verwendete zuerst
+static lock_t res_lock = LOCK_UNLOCKED;
 static hashmap_t *streams = NULL;	//geöffnete Streams
 static lock_t vfs_lock = LOCK_LOCKED;
+static rwlock_t streams_lock = RWLOCK_WRITE_LOCKED;
 
-static size_t getDirs(char ***Dirs, const char *Path)
+/*
+ * Gibt die nächste Komponente eines Pfades zurück, ohne den Pfad zu kopieren.
+ * Parameter:	path = restlicher Pfad, wird hinter die Komponente verschoben
+ * 				len = Länge der Komponente
+ * Rückgabe:	Anfang der Komponente oder NULL, wenn keine mehr vorhanden ist
+ */
+static const char *nextComponent(const char **path, size_t *len)
 {
-	size_t i;
-	char *tmp;
-	//Erst Pfad sichern
-	char *path_copy = strdup(Path);
-	char *tmpPath = path_copy;
+	const char *component = *path;
+	const char *end;
+
+	while(*component == VFS_SEPARATOR)
+		component++;
+	if(*component == '\0')
+		return NULL;
+
+	for(end = component; *end != '\0' && *end != VFS_SEPARATOR; end++);
 
-	if(!*Dirs)
-		*Dirs = malloc(sizeof(char*));
+	*len = end - component;
+	*path = end;
+	return component;
+}
+
+//Vergleicht einen nullterminierten Namen mit einer Pfadkomponente
+static inline bool nameEqual(const char *name, const char *component, size_t len)
+{
+	return strncmp(name, component, len) == 0 && name[len] == '\0';
+}
 
-	char *first_token = strtok_s(&tmpPath, VFS_ROOT);
-	if(first_token == NULL) return 0;
+/*
+ * Entfernt den Eintrag einer Ressource aus dem Ressourcencache
+ * Parameter:	res = Ressource
+ */
+static void removeResEntry(struct cdi_fs_res *res)
+{
+	res_cache_entry_t *entry;
 
-	(*Dirs)[0] = strdup(first_token);
-	for(i = 1; ; i++)
+	lock(&res_lock);
+	if(hashmap_search(res_cache, res, (void**)&entry) == HASH_MAP_SUCCESS_FOUND)
 	{
-		if((tmp = strtok_s(&tmpPath, VFS_ROOT)) == NULL)
-			break;
-		*Dirs = realloc(*Dirs, sizeof(char*) * (i + 1));
-		(*Dirs)[i] = strdup(tmp);
+		hashmap_delete(res_cache, res);
+		if(entry->lru.next != NULL)
+			ilist_remove(&res_lru, &entry->lru);
+		free(entry);
 	}
-	free(path_copy);
-	return i;
+	unlock(&res_lock);
 }
 
-static void freeDirs(char ***Dirs, size_t size)
+/*
+ * Entfernt eine Ressource und alle ihre Kinder aus dem Ressourcen- und dem Verzeichniscache.
+ * Muss aufgerufen werden, bevor die Ressourcen vom Treiber zerstört werden.
+ * Parameter:	res = Ressource
+ */
+static void forgetRes(struct cdi_fs_res *res)
 {
-	size_t i;
-	for(i = 0; i < size; i++)
-		free((*Dirs)[i]);
-	free(*Dirs);
+	cdi_list_iterator_t it;
+	struct cdi_fs_res *child;
+
+	if(res->loaded)
+	{
+		cdi_list_iterator_init(res->children, &it);
+		while((child = cdi_list_iterator_next(&it)))
+			forgetRes(child);
+	}
+	dcache_purge(res);
+	pagecache_purge(res);
+	removeResEntry(res);
+}
+
+/*
+ * Maximale Anzahl gleichzeitig geladener Ressourcen. Richtet sich nach der Grösse des
+ * physischen Speichers. Wenn der Speicher knapp wird, werden nur noch wenige Ressourcen gecacht.
+ */
+static size_t resCacheLimit(void)
+{
+	uint64_t total = pmm_getTotalPages();
+	size_t limit = total / RES_CACHE_PAGES_PER_RES;
+
+	if(limit < RES_CACHE_MIN || pmm_getFreePages() < total / RES_CACHE_LOW_MEMORY)
+		limit = RES_CACHE_MIN;
+	return limit;
+}
+
+/*
+ * Sammelt alle geladenen Nachkommen einer Ressource, damit sie nach dem Entladen aus den Caches
+ * entfernt werden können. Die Ressourcen selbst sind dann schon zerstört.
+ */
+static void collectChildren(struct cdi_fs_res *res, cdi_list_t list)
+{
+	cdi_list_iterator_t it;
+	struct cdi_fs_res *child;
+
+	if(!res->loaded || res->children == NULL)
+		return;
+	cdi_list_iterator_init(res->children, &it);
+	while((child = cdi_list_iterator_next(&it)))
+	{
+		cdi_list_push(list, child);
+		collectChildren(child, list);
+	}
 }
 
-static void removeChilds(cdi_list_t childs)
+/*
+ * Entlädt die am längsten nicht verwendeten Ressourcen, bis im Cache Platz für eine weitere ist
+ * Rückgabe:	true = Platz vorhanden
+ * 				false = Cache voll und keine Ressource konnte entladen werden
+ */
+static bool shrinkResCache(void)
 {
-	struct cdi_fs_res *res, *res2;
-	size_t i = 0;
-	while((res = cdi_list_get(childs, i++)))
+	size_t limit = resCacheLimit();
+	size_t tries;
+
+	lock(&res_lock);
+	tries = ilist_size(&res_lru);
+	while(hashmap_count(res_cache) >= limit)
 	{
-		removeChilds(res->children);
-		size_t j = 0;
-		while((res2 = list_get(res_list, j)))
+		if(tries-- == 0)
+		{
+			unlock(&res_lock);
+			return false;
+		}
+
+		res_cache_entry_t *entry = ILIST_ENTRY(ilist_pop_front(&res_lru), res_cache_entry_t, lru);
+		struct cdi_fs_res *res = entry->res;
+		struct cdi_fs_stream unload_stream = {
+				.fs = entry->fs,
+				.res = res
+		};
+		//Solange evicting gesetzt ist, kann loadRes die Ressource nicht mehr verwenden
+		if(res->stream_cnt > 0)
+			continue;
+		entry->evicting = true;
+		unlock(&res_lock);
+
+		//Die Kinder werden vom Treiber mit zerstört, deshalb vorher merken
+		cdi_list_t children = cdi_list_create();
+		collectChildren(res, children);
+
+		if(res->res->unload(&unload_stream))
+		{
+			struct cdi_fs_res *child;
+			while((child = cdi_list_pop(children)))
+			{
+				dcache_purge(child);
+				pagecache_purge(child);
+				removeResEntry(child);
+			}
+			dcache_purge(res);
+			pagecache_purge(res);
+			removeResEntry(res);
+		}
+		else
 		{
-			if(res2 == res)
-				list_remove(res_list, j);
-			j++;
+			//Konnte nicht entladen werden, wieder hinten einreihen
+			lock(&res_lock);
+			entry->evicting = false;
+			if(res->stream_cnt <= 0 && entry->lru.next == NULL)
+				ilist_push_back(&res_lru, &entry->lru);
+			unlock(&res_lock);
 		}
+		cdi_list_destroy(children);
+
+		lock(&res_lock);
 	}
+	unlock(&res_lock);
+	return true;
 }
 
-//TODO: Wenn der RAM voll ist werden weniger Ressourcen gecacht
 //TODO: Wenn der RAM knapp wird kann die Speicherverwaltung das VFS auffordern den RAM ein bisschen frei zu machen
 /*
- * Lädt wenn nötig eine Ressource
+ * Lädt wenn nötig eine Ressource und markiert sie als verwendet
  * Parameter:	res = Ressource, die geladen werden soll
  * 				stream = Zu verwendenden Stream
  * Rückgabe:	false = Fehler / Ressource konnte nicht geladen werden
@@ -156,68 +328,98 @@ static bool loadRes(struct cdi_fs_res *res, struct cdi_fs_stream *stream)
 			.fs = stream->fs,
 			.res = res
 	};
+	res_cache_entry_t *entry;
 
-	if(!res->loaded)
+	//Ressource wird wieder verwendet, darf also nicht mehr verdrängt werden. Wird sie gerade
+	//entladen, warten, bis das erledigt ist, und sie danach neu laden.
+	lock(&res_lock);
+	while(hashmap_search(res_cache, res, (void**)&entry) == HASH_MAP_SUCCESS_FOUND && entry->evicting)
 	{
-		if(list_size(res_list) >= MAX_RES_BUFFER)
-		{
-			struct cdi_fs_res *tmpRes;
-			size_t i = 0;
-			while((tmpRes = list_get(res_list, i)) != NULL)
-			{
-				//Wenn die Ressource nicht geladen ist löschen wir sie einfach aus der Liste
-				if(!tmpRes->loaded)
-				{
-					list_remove(res_list, i);
-					break;
-				}
+		unlock(&res_lock);
+		yield();
+		lock(&res_lock);
+	}
+	if(res->loaded)
+	{
+		if(res->stream_cnt++ <= 0 && hashmap_search(res_cache, res, (void**)&entry) == HASH_MAP_SUCCESS_FOUND
+				&& entry->lru.next != NULL)
+			ilist_remove(&res_lru, &entry->lru);
+		unlock(&res_lock);
+		return true;
+	}
+	unlock(&res_lock);
 
-				//Wenn die Ressource nirgends verwendet wird, können wir sie entladen
-				if(tmpRes->stream_cnt <= 0)
-				{
-					struct cdi_fs_stream unload_stream = {
-							.fs = stream->fs,
-							.res = res
-					};
-
-					//Erst müssen wir alle Kinder noch von der Liste entfernen, da diese auch zerstört werden
-					removeChilds(tmpRes->children);
-
-					if(tmpRes->res->unload(&unload_stream))
-					{
-						list_remove(res_list, i);
-						break;
-					}
-				}
-				i++;
-			}
-			//Wenn keine Ressource freigegeben werden konnte, dann kann die neue Ressource nicht geladen werden
-			if(i >= list_size(res_list))
-				return false;
-		}
+	if(!shrinkResCache())
+		return false;
 
-		if(!res->res->load(&tmpStream))
-			return false;
-		list_push(res_list, res);
+	entry = malloc(sizeof(res_cache_entry_t));
+	if(entry == NULL)
+		return false;
+
+	if(!res->res->load(&tmpStream))
+	{
+		free(entry);
+		return false;
 	}
+
+	entry->res = res;
+	entry->fs = stream->fs;
+	entry->lru.prev = entry->lru.next = NULL;
+	entry->evicting = false;
+
+	lock(&res_lock);
+	res_cache_entry_t *old;
+	if(hashmap_search(res_cache, res, (void**)&old) == HASH_MAP_SUCCESS_FOUND || hashmap_set(res_cache, res, entry) != HASH_MAP_SUCCESS)
+		free(entry);
 	res->stream_cnt++;
+	unlock(&res_lock);
 	return true;
 }
 
 static void freeRes(struct cdi_fs_res *res)
 {
-	//Referenzzähler decrementieren
+	res_cache_entry_t *entry;
+
+	//Referenzzähler decrementieren. Unbenutzte Ressourcen kommen ans Ende der LRU-Liste.
+	lock(&res_lock);
 	do
 	{
-		res->stream_cnt -= (res->stream_cnt > 0) ? 1 : 0;
+		if(res->stream_cnt > 0 && --res->stream_cnt == 0
+				&& hashmap_search(res_cache, res, (void**)&entry) == HASH_MAP_SUCCESS_FOUND && entry->lru.next == NULL)
+			ilist_push_back(&res_lru, &entry->lru);
 	}
 	while ((res = res->parent) != NULL);
+	unlock(&res_lock);
+}
+
+/*
+ * Sucht ein Kind einer Ressource, zuerst im Verzeichniscache
+ * Parameter:	parent = geladene Ressource
+ * 				name = Name des Kindes
+ * 				len = Länge des Namens
+ * Rückgabe:	Kind oder NULL, wenn es nicht existiert
+ */
+static struct cdi_fs_res *getChildRes(struct cdi_fs_res *parent, const char *name, size_t len)
+{
+	struct cdi_fs_res *res;
+	cdi_list_iterator_t it;
+
+	if(dcache_lookup(parent, name, len, (void**)&res))
+		return res;
+
+	cdi_list_iterator_init(parent->children, &it);
+	while((res = cdi_list_iterator_next(&it)) && !nameEqual(res->name, name, len));
+
+	dcache_insert(parent, name, len, res);
+	return res;
 }
 
 static struct cdi_fs_res *getRes(struct cdi_fs_stream *stream, const char *path)
 {
-	struct cdi_fs_res *res = NULL;
+	struct cdi_fs_res *res;
 	struct cdi_fs_res *prevRes = stream->fs->root_res;
+	const char *component;
+	size_t len;
 
 	if(!loadRes(prevRes, stream))
 		return NULL;
@@ -225,28 +427,18 @@ static struct cdi_fs_res *getRes(struct cdi_fs_stream *stream, const char *path)
 	if(path == NULL)
 		return prevRes;
 
-	char **dirs = NULL;
-	size_t dirSize = getDirs(&dirs, path);
-
-	size_t i = 0;
-	size_t j = 0;
-	while(j < dirSize && (res = cdi_list_get(prevRes->children, i++)))
+	while((component = nextComponent(&path, &len)) != NULL)
 	{
-		if(!strcmp(res->name, dirs[j]))
+		res = getChildRes(prevRes, component, len);
+		if(res == NULL || !loadRes(res, stream))
 		{
-			if(!loadRes(res, stream))
-			{
-				freeRes(res);
-				return NULL;
-			}
-			prevRes = res;
-			j++;
-			i = 0;
+			freeRes(prevRes);
+			return NULL;
 		}
+		prevRes = res;
 	}
-	freeDirs(&dirs, dirSize);
 
-	return res;
+	return prevRes;
 }
 
 static uint64_t streamid_hash(const void *key, __attribute__((unused)) void *context)
@@ -260,7 +452,7 @@ static bool streamid_equal(const void *a, const void *b, __attribute__((unused))
 }
 
 /*
- * Wird für die Hashtable verwendet. Darf nicht auf vfs_lock locken.
+ * Wird für die Hashtable verwendet. Darf nicht auf streams_lock locken.
  */
 static void vfs_stream_free(const void *s)
 {
@@ -277,6 +469,7 @@ static void vfs_stream_free(const void *s)
 			//Nichts machen
 		break;
 	}
+	semaphore_destroy(&stream->lock);
 	free(stream);
 }
 
@@ -289,18 +482,8 @@ static void vfs_stream_closed(const void *s)
 	vfs_file_t streamid = stream->id;
 
 	//Stream wird nicht mehr verwendet
-	LOCKED_TASK(vfs_lock, hashmap_delete(streams, (void*)streamid));
-	assert(!LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)streamid, NULL)));
-}
-
-/*
- * Wird für die Userspace Hashtable verwendet. Darf nicht auf current_thread->lock locken.
- */
-static void vfs_userspace_stream_free(const void *s)
-{
-	vfs_userspace_stream_t *stream = (vfs_userspace_stream_t*)s;
-	vfs_Close(stream->stream);
-	free(stream);
+	WLOCKED_TASK(streams_lock, hashmap_delete(streams, (void*)streamid));
+	assert(!RLOCKED_RESULT(streams_lock, hashmap_search(streams, (void*)streamid, NULL)));
 }
 
 static vfs_file_t getNextStreamID()
@@ -311,18 +494,173 @@ static vfs_file_t getNextStreamID()
 	{
 		id = __sync_fetch_and_add(&nextFileID, 1);
 	}
-	while(id == -1ul || LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)id, NULL)));
+	while(id == -1ul || RLOCKED_RESULT(streams_lock, hashmap_search(streams, (void*)id, NULL)));
 	return id;
 }
 
-static vfs_file_t getNextUserspaceStreamID(process_t *p)
+/*
+ * Sucht einen Stream anhand seiner ID und reserviert ihn
+ * Rückgabe:	Stream oder NULL, wenn er nicht existiert oder gerade geschlossen wird
+ */
+static vfs_stream_t *getStream(vfs_file_t streamid)
+{
+	vfs_stream_t *stream = NULL;
+
+	read_lock(&streams_lock);
+	if(hashmap_search(streams, (void*)streamid, (void**)&stream) == HASH_MAP_SUCCESS_FOUND)
+		stream = REFCOUNT_RETAIN(stream);
+	else
+		stream = NULL;
+	read_unlock(&streams_lock);
+
+	return stream;
+}
+
+/*
+ * Erhöht den Referenzzähler einer Ressource und aller ihrer Eltern (Gegenstück zu freeRes)
+ */
+static void retainRes(struct cdi_fs_res *res)
 {
-	vfs_file_t id = 0;
-	while(id == -1ul || LOCKED_RESULT(vfs_lock, hashmap_search(p->streams, (void*)id, NULL)))
+	lock(&res_lock);
+	do
 	{
-		id++;
+		res->stream_cnt++;
 	}
-	return id;
+	while((res = res->parent) != NULL);
+	unlock(&res_lock);
+}
+
+static vfs_fd_table_t *fdCreateTable(void)
+{
+	vfs_fd_table_t *table = malloc(sizeof(vfs_fd_table_t));
+	if(table == NULL)
+		return NULL;
+
+	table->array = calloc(1, sizeof(vfs_fd_array_t) + VFS_FD_TABLE_MIN * sizeof(vfs_stream_t*));
+	if(table->array == NULL)
+	{
+		free(table);
+		return NULL;
+	}
+	table->array->size = VFS_FD_TABLE_MIN;
+	table->readers = 0;
+	table->lock = LOCK_UNLOCKED;
+
+	return table;
+}
+
+//Wartet bis alle Lookups beendet sind, die noch einen alten Eintrag sehen könnten
+static void fdWaitReaders(vfs_fd_table_t *table)
+{
+	__sync_synchronize();
+	while(table->readers > 0)
+		yield();
+}
+
+/*
+ * Sucht einen Deskriptor und reserviert den Stream. Braucht keinen Lock.
+ * Rückgabe:	Stream oder NULL, wenn der Deskriptor ungültig ist
+ */
+static vfs_stream_t *fdGet(vfs_fd_table_t *table, vfs_file_t fd)
+{
+	vfs_stream_t *stream = NULL;
+
+	__sync_fetch_and_add(&table->readers, 1);
+	vfs_fd_array_t *array = table->array;
+	if(fd < array->size && (stream = array->streams[fd]) != NULL)
+		stream = REFCOUNT_RETAIN(stream);
+	__sync_fetch_and_sub(&table->readers, 1);
+
+	return stream;
+}
+
+/*
+ * Trägt einen Stream unter dem kleinsten freien Deskriptor ein. Die Referenz geht an die Tabelle über.
+ * Rückgabe:	Deskriptor oder -1 bei Fehler
+ */
+static vfs_file_t fdAlloc(vfs_fd_table_t *table, vfs_stream_t *stream)
+{
+	vfs_fd_array_t *old_array = NULL;
+	vfs_file_t fd;
+
+	lock(&table->lock);
+	vfs_fd_array_t *array = table->array;
+	for(fd = 0; fd < array->size && array->streams[fd] != NULL; fd++);
+
+	if(fd == array->size)
+	{
+		//Tabelle verdoppeln
+		size_t size = array->size * 2;
+		vfs_fd_array_t *new_array = calloc(1, sizeof(vfs_fd_array_t) + size * sizeof(vfs_stream_t*));
+		if(new_array == NULL)
+		{
+			unlock(&table->lock);
+			return -1;
+		}
+		new_array->size = size;
+		memcpy(new_array->streams, array->streams, array->size * sizeof(vfs_stream_t*));
+		table->array = new_array;
+		old_array = array;
+		array = new_array;
+	}
+	array->streams[fd] = stream;
+	unlock(&table->lock);
+
+	if(old_array != NULL)
+	{
+		fdWaitReaders(table);
+		free(old_array);
+	}
+
+	return fd;
+}
+
+/*
+ * Entfernt einen Deskriptor aus der Tabelle
+ * Rückgabe:	Stream (die Referenz geht an den Aufrufer über) oder NULL, wenn der Deskriptor ungültig ist
+ */
+static vfs_stream_t *fdRemove(vfs_fd_table_t *table, vfs_file_t fd)
+{
+	vfs_stream_t *stream = NULL;
+
+	lock(&table->lock);
+	vfs_fd_array_t *array = table->array;
+	if(fd < array->size)
+	{
+		stream = array->streams[fd];
+		array->streams[fd] = NULL;
+	}
+	unlock(&table->lock);
+
+	//Ein laufender Lookup könnte den Stream noch nicht reserviert haben
+	if(stream != NULL)
+		fdWaitReaders(table);
+
+	return stream;
+}
+
+/*
+ * Sucht ein Kind einer Node, zuerst im Verzeichniscache. vfs_lock muss gehalten werden.
+ * Parameter:	parent = Node
+ * 				name = Name des Kindes
+ * 				len = Länge des Namens
+ * Rückgabe:	Kind oder NULL, wenn es nicht existiert
+ */
+static vfs_node_t *getChildNode(vfs_node_t *parent, const char *name, size_t len)
+{
+	vfs_node_t *node;
+
+	//Nur Ordner haben Kinder in der Node-Struktur
+	if(parent->type != TYPE_DIR)
+		return NULL;
+
+	if(dcache_lookup(parent, name, len, (void**)&node))
+		return node;
+
+	for(node = parent->childs; node != NULL && !nameEqual(node->name, name, len); node = node->next);
+
+	dcache_insert(parent, name, len, node);
+	return node;
 }
 
 /*
@@ -333,39 +671,22 @@ static vfs_file_t getNextUserspaceStreamID(process_t *p)
 static vfs_node_t *getLastNode(const char *Path, char **remPath)
 {
 	vfs_node_t *Node = &root;
-	vfs_node_t *oldNode = NULL;	//Ohne Initialisierung meckert der Compiler
-	char **Dirs = NULL;
-	size_t NumDirs, i;
+	vfs_node_t *child;
+	const char *component;
+	size_t len;
 
-	//Welche Ordner?
-	NumDirs = getDirs(&Dirs, Path);
-	for(i = 0; i < NumDirs; i++)
-	{
-		oldNode = Node;
-		Node = Node->childs;
-		while(Node && strcmp(Node->name, Dirs[i]))
-			Node = Node->next;
-		if(!Node) break;
-	}
-	if(!Node)
+	lock(&vfs_lock);
+	while((component = nextComponent(&Path, &len)) != NULL)
 	{
-		Node = oldNode;
+		if((child = getChildNode(Node, component, len)) == NULL)
+			break;
+		Node = child;
 	}
+	unlock(&vfs_lock);
+
 	if(remPath != NULL)
-	{
-		*remPath = NULL;
-		size_t size = 0;
-		size_t j;
-		for(j = 1; i < NumDirs; i++, j++)
-		{
-			size += strlen(Dirs[i]);
-			*remPath = realloc(*remPath, size + j + 1);
-			strcpy(*remPath + size - strlen(Dirs[i]) + j - 1, "/");
-			strcpy(*remPath + size - strlen(Dirs[i]) + j, Dirs[i]);
-		}
-	}
+		*remPath = (component != NULL) ? strdup(component) : NULL;
 
-	freeDirs(&Dirs, NumDirs);
 	return Node;
 }
 
@@ -376,20 +697,14 @@ static vfs_node_t *getLastNode(const char *Path, char **remPath)
 static vfs_node_t *getNode(const char *Path)
 {
 	vfs_node_t *Node = &root;
-	char **Dirs = NULL;
-	size_t NumDirs, i;
+	const char *component;
+	size_t len;
 
-	//Welche Ordner?
-	NumDirs = getDirs(&Dirs, Path);
-	for(i = 0; i < NumDirs; i++)
-	{
-		Node = Node->childs;
-		while(Node && strcmp(Node->name, Dirs[i]))
-			Node = Node->next;
-		if(!Node) return NULL;
-	}
+	lock(&vfs_lock);
+	while(Node != NULL && (component = nextComponent(&Path, &len)) != NULL)
+		Node = getChildNode(Node, component, len);
+	unlock(&vfs_lock);
 
-	freeDirs(&Dirs, NumDirs);
 	return Node;
 }
 
@@ -415,6 +730,9 @@ static vfs_node_t *createBaseNode(vfs_node_t *parent, const char *name)
 	node->next = parent->childs;
 	parent->childs = node;
 
+	//Negativen Eintrag entfernen
+	dcache_invalidate(parent, name, strlen(name));
+
 	return node;
 }
 
@@ -450,6 +768,8 @@ static void deleteNode(vfs_node_t *node)
 				return;
 			}
 		}
+		dcache_invalidate(parentNode, node->name, strlen(node->name));
+		dcache_purge(node);
 		unlock(&vfs_lock);
 
 		free(node->name);
@@ -486,10 +806,11 @@ static vfs_node_t *createDirNode(vfs_node_t *parent, const char *name)
  * Erstelle eine Dateinode.
  * Parameter:	parent = Node zu welcher die neue Node hinzugefügt werden soll
  * 				name = Name der Node
- * 				handler = Handler für die Dateioperation
+ * 				read = Handler zum Lesen der Datei (kann NULL sein)
+ * 				write = Handler zum Schreiben der Datei (kann NULL sein)
  * Rückgabe:	Pointer zur neuen Node
  */
-static vfs_node_t *createFileNode(vfs_node_t *parent, const char *name, size_t (*handler)(char*, uint64_t, size_t, const void*))
+static vfs_node_t *createFileNode(vfs_node_t *parent, const char *name, vfs_file_read_handler_t *read, vfs_file_write_handler_t *write)
 {
 	lock(&vfs_lock);
 
@@ -502,7 +823,8 @@ static vfs_node_t *createFileNode(vfs_node_t *parent, const char *name, size_t (
 	}
 
 	node->type = TYPE_FILE;
-	node->handler = handler;
+	node->file.read = read;
+	node->file.write = write;
 
 	unlock(&vfs_lock);
 
@@ -607,8 +929,11 @@ static vfs_node_t *resolveLink(vfs_node_t *node)
 
 void vfs_Init(void)
 {
-	res_list = list_create();
-	streams = hashmap_create(streamid_hash, streamid_hash, streamid_equal, NULL, vfs_stream_free, NULL, 3);
+	lockstat_register(&vfs_lock, "vfs");
+	lockstat_register(&res_lock, "vfs res");
+	res_cache = hashmap_create(streamid_hash, streamid_equal, NULL, NULL, NULL, RES_CACHE_MIN);
+	assert(res_cache != NULL);
+	streams = hashmap_create(streamid_hash, streamid_equal, NULL, vfs_stream_free, NULL, 3);
 	assert(streams != NULL);
 
 	//Root
@@ -618,6 +943,7 @@ void vfs_Init(void)
 	root.parent = &root;
 	root.type = TYPE_DIR;
 
+	write_unlock(&streams_lock);
 	unlock(&vfs_lock);
 
 	//Virtuelle Ordner anlegen
@@ -629,22 +955,32 @@ void vfs_Init(void)
 
 	//Unterordner "mount" anlegen: für Mountpoints
 	createDirNode(&root, "mount");
+
+	dcache_Init();
+	pagecache_Init();
 }
 
 /*
  * Eine Datei öffnen
  * Parameter:	path = Pfad zur Datei
  * 				mode = Modus, in der die Datei geöffnet werden soll
+ * Rückgabe:	Reservierter Stream oder NULL bei Fehler
  */
-vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
+static vfs_stream_t *openStream(const char *path, vfs_mode_t mode)
 {
 	if(path == NULL || strlen(path) == 0 || (!mode.read && !mode.write) || (mode.write && mode.directory))
-		return -1;
+		return NULL;
 
 	char *remPath;
 	vfs_stream_t *stream;
 	vfs_node_t *node = getLastNode(path, &remPath);
 	stream = calloc(1, sizeof(*stream));
+	if(stream == NULL)
+	{
+		if(remPath)
+			free(remPath);
+		return NULL;
+	}
 	stream->id = getNextStreamID();
 	stream->mode = mode;
 
@@ -667,7 +1003,7 @@ vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
 				free(stream);
 				if(remPath)
 					free(remPath);
-				return -1;
+				return NULL;
 			}
 		break;
 		case TYPE_DIR:
@@ -676,7 +1012,7 @@ vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
 				free(stream);
 				if(remPath)
 					free(remPath);
-				return -1;
+				return NULL;
 			}
 		break;
 		case TYPE_DEV:
@@ -685,7 +1021,7 @@ vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
 				free(stream);
 				if(remPath)
 					free(remPath);
-				return -1;
+				return NULL;
 			}
 			stream->mode.empty = false;
 			stream->mode.append = false;
@@ -695,7 +1031,16 @@ vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
 			assert(false);
 		break;
 		case TYPE_FILE:
-			//Nichts zu tun
+			if(mode.directory)
+			{
+				free(stream);
+				if(remPath)
+					free(remPath);
+				return NULL;
+			}
+			stream->mode.empty = false;
+			stream->mode.append = false;
+			stream->mode.create = false;
 		break;
 	}
 
@@ -703,63 +1048,84 @@ vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
 	{
 		if(stream->stream.fs->read_only || !stream->stream.res->flags.write)
 		{
+			forgetRes(stream->stream.res);
 			stream->stream.res->res->unload(&stream->stream);
 			free(stream);
-			return -1;
+			return NULL;
 		}
 		stream->stream.res->file->truncate(&stream->stream, 0);
+		//Gemappte Pages bleiben bestehen, bis sie nicht mehr verwendet werden
+		pagecache_purge(stream->stream.res);
 	}
 	if(remPath)
 		free(remPath);
 
+	semaphore_init(&stream->lock, 1);
+
 	//In Hashtable einfügen
-	LOCKED_TASK(vfs_lock, hashmap_set(streams, (void*)stream->id, stream));
+	WLOCKED_TASK(streams_lock, hashmap_set(streams, (void*)stream->id, stream));
 
-	assert(LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)stream->id, NULL)));
+	assert(RLOCKED_RESULT(streams_lock, hashmap_search(streams, (void*)stream->id, NULL)));
 
-	return stream->id;
+	return stream;
 }
 
-vfs_file_t vfs_Reopen(const vfs_file_t streamid, vfs_mode_t mode)
+/*
+ * Eine Datei öffnen
+ * Parameter:	path = Pfad zur Datei
+ * 				mode = Modus, in der die Datei geöffnet werden soll
+ */
+vfs_file_t vfs_Open(const char *path, vfs_mode_t mode)
 {
-	vfs_stream_t *stream;
+	vfs_stream_t *stream = openStream(path, mode);
+	return (stream != NULL) ? stream->id : -1ul;
+}
 
+/*
+ * Öffnet einen Stream neu
+ * Parameter:	stream = reservierter Stream
+ * 				mode = Modus, in dem der Stream geöffnet werden soll
+ * Rückgabe:	Neu reservierter Stream (derselbe, wenn sich der Modus nicht unterscheidet) oder NULL bei Fehler
+ */
+static vfs_stream_t *reopenStream(vfs_stream_t *stream, vfs_mode_t mode)
+{
 	if((!mode.read && !mode.write))
-		return -1;
+		return NULL;
 
-	assert(streams != NULL);
-	if(!LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)streamid, (void**)&stream)))
-		return -1;
+	if(memcmp(&mode, &stream->mode, sizeof(vfs_mode_t)) == 0)
+		return REFCOUNT_RETAIN(stream);
 
-	//Stream reservieren
-	stream = REFCOUNT_RETAIN(stream);
-	if(stream == NULL)
-		return -1;
+	//Klone den Stream mit dem entsprechendem Modus
+	vfs_stream_t *new_stream = malloc(sizeof(vfs_stream_t));
+	if(new_stream == NULL)
+		return NULL;
 
-	if(memcmp(&mode, &stream->mode, sizeof(vfs_mode_t)) != 0)
-	{
-		//Klone den Stream mit dem entsprechendem Modus
-		vfs_stream_t *new_stream = malloc(sizeof(vfs_stream_t));
-		if(new_stream == NULL)
-			return -1;
+	memcpy(new_stream, stream, sizeof(vfs_stream_t));
 
-		memcpy(new_stream, stream, sizeof(vfs_stream_t));
+	new_stream->id = getNextStreamID();
+	new_stream->mode = mode;
+	semaphore_init(&new_stream->lock, 1);
+	REFCOUNT_INIT(new_stream, vfs_stream_closed);
+	if(new_stream->node->type == TYPE_MOUNT)
+		retainRes(new_stream->stream.res);
 
-		new_stream->id = getNextStreamID();
-		REFCOUNT_INIT(new_stream, vfs_stream_closed);
-		__sync_fetch_and_add(&new_stream->stream.res->stream_cnt, 1);
+	WLOCKED_TASK(streams_lock, hashmap_set(streams, (void*)new_stream->id, new_stream));
 
-		//Reservierten Stream wieder freigeben
-		REFCOUNT_RELEASE(stream);
+	return new_stream;
+}
 
-		stream = new_stream;
+vfs_file_t vfs_Reopen(const vfs_file_t streamid, vfs_mode_t mode)
+{
+	vfs_stream_t *stream, *new_stream;
 
-		LOCKED_TASK(vfs_lock, hashmap_set(streams, (void*)new_stream->id, new_stream));
-	}
+	assert(streams != NULL);
+	if((stream = getStream(streamid)) == NULL)
+		return -1;
 
-	assert(LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)stream->id, NULL)));
+	new_stream = reopenStream(stream, mode);
+	REFCOUNT_RELEASE(stream);
 
-	return stream->id;
+	return (new_stream != NULL) ? new_stream->id : -1ul;
 }
 
 /*
@@ -769,7 +1135,7 @@ vfs_file_t vfs_Reopen(const vfs_file_t streamid, vfs_mode_t mode)
 void vfs_Close(vfs_file_t streamid)
 {
 	vfs_stream_t *stream;
-	if(!LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)streamid, (void**)&stream)))
+	if(!RLOCKED_RESULT(streams_lock, hashmap_search(streams, (void*)streamid, (void**)&stream)))
 		return;
 
 	//Reservierten Stream freigeben
@@ -804,9 +1170,13 @@ static size_t ReadDir(vfs_stream_t *stream, uint64_t start, size_t size, vfs_use
 			cdi_list_t childs;
 			struct cdi_fs_res *child_res;
 			vfs_userspace_direntry_t *entry;
+			semaphore_acquire(&stream->lock);
 			childs = stream->stream.res->dir->list(&stream->stream);
 			if(childs == NULL || cdi_list_size(childs) == 0)
+			{
+				semaphore_release(&stream->lock);
 				return 0;
+			}
 			size_t i = start;
 			while((child_res = cdi_list_get(childs, i++)))
 			{
@@ -829,6 +1199,7 @@ static size_t ReadDir(vfs_stream_t *stream, uint64_t start, size_t size, vfs_use
 				strcpy((char*)&entry->name, child_res->name);
 				sizeRead += entry_size;
 			}
+			semaphore_release(&stream->lock);
 		}
 		break;
 		case TYPE_DIR:
@@ -885,23 +1256,103 @@ static size_t ReadDir(vfs_stream_t *stream, uint64_t start, size_t size, vfs_use
 }
 
 /*
- * Eine Datei lesen
- * Parameter:	Path = Pfad zur Datei als String
- * 				start = Anfangsbyte, an dem angefangen werden soll zu lesen
- * 				length = Anzahl der Bytes, die gelesen werden sollen
- * 				Buffer = Buffer in den die Bytes geschrieben werden
+ * Lädt eine Page einer Datei in den Page-Cache. Der Treiber wird unter dem Lock des Streams
+ * aufgerufen, da er nicht reentrant ist.
+ * Parameter:	opaque = Stream der Datei (TYPE_MOUNT), dessen Lock nicht gehalten werden darf
+ * 				index = Index der Page
+ * 				data = Page
+ * Rückgabe:	Anzahl gelesener Bytes
  */
-size_t vfs_Read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer)
+static size_t fillCachePage(void *opaque, uint64_t index, void *data)
 {
-	vfs_stream_t *stream;
+	vfs_stream_t *stream = opaque;
+	uint64_t offset = index * MM_BLOCK_SIZE;
+	size_t sizeRead = 0;
 
-	if(buffer == NULL)
-		return 0;
+	semaphore_acquire(&stream->lock);
+	uint64_t size = stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_SIZE);
+	if(offset < size)
+		sizeRead = stream->stream.res->file->read(&stream->stream, offset,
+				(size - offset < MM_BLOCK_SIZE) ? size - offset : MM_BLOCK_SIZE, data);
+	semaphore_release(&stream->lock);
 
-	assert(streams != NULL);
-	if(!LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)streamid, (void**)&stream)))
-		return 0;
+	return sizeRead;
+}
+
+/*
+ * Blendet die Pages eines Puffers im Userspace ein, die zu Abbildungen einer Datei gehören. Muss
+ * aufgerufen werden, bevor der Lock eines Streams genommen wird: Ein Page Fault im Treiber müsste
+ * sonst die Page laden und dafür den Lock des abgebildeten Streams nehmen, den der Thread
+ * vielleicht schon hält.
+ * Parameter:	buffer = Puffer
+ * 				length = Grösse des Puffers
+ * 				write = true, wenn der Treiber in den Puffer schreibt
+ */
+static void prefaultBuffer(const void *buffer, size_t length, bool write)
+{
+	uintptr_t address = (uintptr_t)buffer & ~(MM_BLOCK_SIZE - 1);
+	uintptr_t end = (uintptr_t)buffer + length;
 
+	if(length == 0 || (uintptr_t)buffer < USERSPACE_START || end < (uintptr_t)buffer)
+		return;
+
+	for(; address < end && address != 0; address += MM_BLOCK_SIZE)
+		vfs_HandlePageFault((void*)address, write);
+}
+
+static void prefaultIOVec(const vfs_iovec_t *iov, size_t count, bool write)
+{
+	size_t i;
+	for(i = 0; i < count; i++)
+		prefaultBuffer(iov[i].base, iov[i].length, write);
+}
+
+/*
+ * Liest eine Datei über den Page-Cache
+ * Parameter:	stream = reservierter Stream (TYPE_MOUNT)
+ * 				start = Anfangsbyte
+ * 				length = Anzahl Bytes
+ * 				buffer = Buffer in den die Bytes geschrieben werden
+ * Rückgabe:	Anzahl gelesener Bytes
+ */
+static size_t readCached(vfs_stream_t *stream, uint64_t start, size_t length, void *buffer)
+{
+	size_t sizeRead = 0;
+
+	while(sizeRead < length)
+	{
+		uint64_t offset = (start + sizeRead) % MM_BLOCK_SIZE;
+		size_t size = 0;
+		pagecache_page_t *page = pagecache_get(stream->stream.res, (start + sizeRead) / MM_BLOCK_SIZE, fillCachePage, stream);
+		if(page == NULL)
+			break;
+
+		if(offset < page->valid)
+		{
+			size = page->valid - offset;
+			if(size > length - sizeRead)
+				size = length - sizeRead;
+			memcpy(buffer + sizeRead, page->data + offset, size);
+		}
+		pagecache_put(page);
+
+		sizeRead += size;
+		//Dateiende erreicht
+		if(offset + size < MM_BLOCK_SIZE)
+			break;
+	}
+	return sizeRead;
+}
+
+/*
+ * Eine Datei lesen
+ * Parameter:	stream = reservierter Stream
+ * 				start = Anfangsbyte, an dem angefangen werden soll zu lesen
+ * 				length = Anzahl der Bytes, die gelesen werden sollen
+ * 				Buffer = Buffer in den die Bytes geschrieben werden
+ */
+static size_t readStream(vfs_stream_t *stream, uint64_t start, size_t length, void *buffer)
+{
 	size_t sizeRead = 0;
 
 	//Erst überprüfen ob der Stream zum lesen geöffnet wurde
@@ -922,7 +1373,11 @@ size_t vfs_Read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer
 		break;
 		case TYPE_MOUNT:
 			if(stream->stream.res->flags.read)
-				sizeRead = stream->stream.res->file->read(&stream->stream, start, length, buffer);
+				sizeRead = readCached(stream, start, length, buffer);
+		break;
+		case TYPE_FILE:
+			if(stream->node->file.read != NULL)
+				sizeRead = stream->node->file.read(stream->node->name, start, length, buffer);
 		break;
 		default:
 			assert(false);
@@ -931,16 +1386,33 @@ size_t vfs_Read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer
 	return sizeRead;
 }
 
-size_t vfs_Write(vfs_file_t streamid, uint64_t start, size_t length, const void *buffer)
+/*
+ * Eine Datei lesen
+ * Parameter:	streamid = ID des Streams
+ * 				start = Anfangsbyte, an dem angefangen werden soll zu lesen
+ * 				length = Anzahl der Bytes, die gelesen werden sollen
+ * 				Buffer = Buffer in den die Bytes geschrieben werden
+ */
+size_t vfs_Read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer)
 {
 	vfs_stream_t *stream;
 
 	if(buffer == NULL)
 		return 0;
 
-	 if(!LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)streamid, (void**)&stream)))
-		 return 0;
+	assert(streams != NULL);
+	if((stream = getStream(streamid)) == NULL)
+		return 0;
+
+	TRACE(TRACE_VFS_READ, streamid, length);
+	size_t sizeRead = readStream(stream, start, length, buffer);
+	REFCOUNT_RELEASE(stream);
+	TRACE(TRACE_VFS_READ_DONE, streamid, sizeRead);
+	return sizeRead;
+}
 
+static size_t writeStream(vfs_stream_t *stream, uint64_t start, size_t length, const void *buffer)
+{
 	size_t sizeWritten = 0;
 
 	//Erst überprüfen ob der Stream zum schreiben geöffnet wurde
@@ -958,12 +1430,18 @@ size_t vfs_Write(vfs_file_t streamid, uint64_t start, size_t length, const void
 		case TYPE_MOUNT:
 			//Überprüfen, ob auf das Dateisystem geschrieben werden darf
 			if(!stream->stream.fs->read_only && stream->stream.res->flags.write)
+			{
+				prefaultBuffer(buffer, length, false);
+				semaphore_acquire(&stream->lock);
 				sizeWritten = stream->stream.res->file->write(&stream->stream, start, length, buffer);
+				semaphore_release(&stream->lock);
+				pagecache_update(stream->stream.res, start, sizeWritten, buffer);
+			}
 		break;
 		case TYPE_FILE:
 			//Wenn ein Handler gesetzt ist, dann Handler aufrufen
-			if(stream->node->handler != NULL)
-				sizeWritten = stream->node->handler(stream->node->name, start, length, buffer);
+			if(stream->node->file.write != NULL)
+				sizeWritten = stream->node->file.write(stream->node->name, start, length, buffer);
 		break;
 		default:
 			assert(false);
@@ -972,122 +1450,458 @@ size_t vfs_Write(vfs_file_t streamid, uint64_t start, size_t length, const void
 	return sizeWritten;
 }
 
-//TODO: Erbe alle geöffneten Stream vom Vaterprozess
-int vfs_initUserspace(process_t *parent, process_t *p, const char *stdin, const char *stdout, const char *stderr)
+size_t vfs_Write(vfs_file_t streamid, uint64_t start, size_t length, const void *buffer)
 {
-	assert(p != NULL && ((parent == NULL && stdin != NULL && stdout != NULL && stderr != NULL) || parent != NULL));
-	if((p->streams = hashmap_create(streamid_hash, streamid_hash, streamid_equal, NULL, vfs_userspace_stream_free, NULL, 3)) == NULL)
-		return 1;
+	vfs_stream_t *stream;
 
-	vfs_file_t streamid;
-	vfs_userspace_stream_t *stream;
-	vfs_mode_t m = {
-			.read = true
-	};
-	if(parent != NULL && stdin == NULL)
+	if(buffer == NULL)
+		return 0;
+
+	if((stream = getStream(streamid)) == NULL)
+		return 0;
+
+	size_t sizeWritten = writeStream(stream, start, length, buffer);
+	REFCOUNT_RELEASE(stream);
+	return sizeWritten;
+}
+
+/*
+ * Liest zusammenhängende Daten in mehrere Puffer. Wenn der Treiber keine vektorisierte Funktion
+ * anbietet, wird für jeden Puffer einzeln gelesen.
+ * Parameter:	stream = reservierter Stream
+ * 				start = Anfangsbyte
+ * 				iov = Puffer
+ * 				count = Anzahl Puffer
+ * Rückgabe:	Anzahl gelesener Bytes
+ */
+static size_t readvStream(vfs_stream_t *stream, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	size_t sizeRead = 0;
+	size_t i;
+
+	if(!stream->mode.read || stream->mode.directory)
+		return 0;
+
+	switch(stream->node->type)
 	{
-		LOCKED_TASK(parent->lock, hashmap_search(parent->streams, (void*)0, (void**)&stream));
-		assert(stream != NULL);
-		streamid = vfs_Reopen(stream->stream, m);
+		case TYPE_DEV:
+			if(stream->node->dev->readv != NULL)
+				return stream->node->dev->readv(stream->node->dev->opaque, start, iov, count);
+		break;
+		case TYPE_MOUNT:
+			if(stream->stream.res->flags.read && stream->stream.res->file->readv != NULL)
+			{
+				prefaultIOVec(iov, count, true);
+				semaphore_acquire(&stream->lock);
+				sizeRead = stream->stream.res->file->readv(&stream->stream, start, iov, count);
+				semaphore_release(&stream->lock);
+				return sizeRead;
+			}
+		break;
+		default:
+		break;
 	}
-	else
+
+	for(i = 0; i < count; i++)
 	{
-		streamid = vfs_Open(stdin, m);
+		size_t size = readStream(stream, start + sizeRead, iov[i].length, iov[i].base);
+		sizeRead += size;
+		if(size < iov[i].length)
+			break;
 	}
-	if(streamid == -1ul)
-		return 0;
-	stream = malloc(sizeof(vfs_userspace_stream_t));
-	if(stream == NULL)
+	return sizeRead;
+}
+
+/*
+ * Schreibt zusammenhängende Daten aus mehreren Puffern. Wenn der Treiber keine vektorisierte Funktion
+ * anbietet, wird jeder Puffer einzeln geschrieben.
+ * Parameter:	stream = reservierter Stream
+ * 				start = Anfangsbyte
+ * 				iov = Puffer
+ * 				count = Anzahl Puffer
+ * Rückgabe:	Anzahl geschriebener Bytes
+ */
+static size_t writevStream(vfs_stream_t *stream, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	size_t sizeWritten = 0;
+	size_t i;
+
+	if(!stream->mode.write)
 		return 0;
-	stream->id = 0;
-	stream->mode = m;
-	stream->stream = streamid;
-	hashmap_set(p->streams, (void*)0, stream);
-
-	m.write = true;
-	m.read = false;
-	if(parent != NULL && stdout == NULL)
+
+	switch(stream->node->type)
 	{
-		LOCKED_TASK(parent->lock, hashmap_search(parent->streams, (void*)1, (void**)&stream));
-		assert(stream != NULL);
-		streamid = vfs_Reopen(stream->stream, m);
+		case TYPE_DEV:
+			if(stream->node->dev->writev != NULL)
+				return stream->node->dev->writev(stream->node->dev->opaque, start, iov, count);
+		break;
+		case TYPE_MOUNT:
+			if(!stream->stream.fs->read_only && stream->stream.res->flags.write && stream->stream.res->file->writev != NULL)
+			{
+				prefaultIOVec(iov, count, false);
+				semaphore_acquire(&stream->lock);
+				sizeWritten = stream->stream.res->file->writev(&stream->stream, start, iov, count);
+				semaphore_release(&stream->lock);
+				//Gecachte Pages aktualisieren
+				size_t done = 0;
+				for(i = 0; i < count && done < sizeWritten; i++)
+				{
+					size_t size = (iov[i].length < sizeWritten - done) ? iov[i].length : sizeWritten - done;
+					pagecache_update(stream->stream.res, start + done, size, iov[i].base);
+					done += size;
+				}
+				return sizeWritten;
+			}
+		break;
+		default:
+		break;
 	}
-	else
+
+	for(i = 0; i < count; i++)
 	{
-		streamid = vfs_Open(stdout, m);
+		size_t size = writeStream(stream, start + sizeWritten, iov[i].length, iov[i].base);
+		sizeWritten += size;
+		if(size < iov[i].length)
+			break;
 	}
-	if(streamid == -1ul)
+	return sizeWritten;
+}
+
+size_t vfs_Readv(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	vfs_stream_t *stream;
+
+	if(iov == NULL || count == 0 || count > VFS_IOV_MAX)
 		return 0;
-	stream = malloc(sizeof(vfs_userspace_stream_t));
-	if(stream == NULL)
+
+	if((stream = getStream(streamid)) == NULL)
+		return 0;
+
+	size_t sizeRead = readvStream(stream, start, iov, count);
+	REFCOUNT_RELEASE(stream);
+	return sizeRead;
+}
+
+size_t vfs_Writev(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	vfs_stream_t *stream;
+
+	if(iov == NULL || count == 0 || count > VFS_IOV_MAX)
+		return 0;
+
+	if((stream = getStream(streamid)) == NULL)
 		return 0;
-	stream->id = 1;
-	stream->mode = m;
-	stream->stream = streamid;
-	hashmap_set(p->streams, (void*)1, stream);
 
-	if(parent != NULL && stderr == NULL)
+	size_t sizeWritten = writevStream(stream, start, iov, count);
+	REFCOUNT_RELEASE(stream);
+	return sizeWritten;
+}
+
+/*
+ * Gibt die eingeblendeten Pages und den Stream einer Abbildung frei. Die Abbildung muss
+ * schon aus dem Adressraum entfernt sein.
+ */
+static void releaseMapping(vfs_mapping_t *mapping)
+{
+	size_t i;
+
+	for(i = 0; i < mapping->size; i++)
 	{
-		LOCKED_TASK(parent->lock, hashmap_search(parent->streams, (void*)2, (void**)&stream));
-		assert(stream != NULL);
-		streamid = vfs_Reopen(stream->stream, m);
+		if(mapping->pages[i] != NULL && mapping->pages[i] != MAPPING_PAGE_COPIED)
+			pagecache_put(mapping->pages[i]);
 	}
-	else
+	REFCOUNT_RELEASE(mapping->stream);
+	semaphore_destroy(&mapping->lock);
+	free(mapping);
+}
+
+/*
+ * Behandelt einen Page Fault in einer Abbildung
+ * Parameter:	mapping = Abbildung
+ * 				address = Adresse der Page
+ * 				write = Schreibzugriff
+ * Rückgabe:	true, wenn der Zugriff wiederholt werden kann
+ */
+static bool faultMapping(vfs_mapping_t *mapping, void *address, bool write)
+{
+	size_t i = (address - mapping->start) / MM_BLOCK_SIZE;
+	pagecache_page_t *page;
+	bool handled = true;
+
+	//Auf geteilte Abbildungen darf nicht geschrieben werden
+	if(write && !mapping->private)
+		return false;
+
+	semaphore_acquire(&mapping->lock);
+	page = mapping->pages[i];
+	if(page == NULL)
 	{
-		streamid = vfs_Open(stderr, m);
+		page = pagecache_get(mapping->stream->stream.res, mapping->index + i, fillCachePage, mapping->stream);
+		if(page == NULL)
+			handled = false;
+		else if(vmm_ChangeMap(address, page->phys, VMM_FLAGS_USER | VMM_FLAGS_NX, VMM_SHARED_PAGE) != 0)
+		{
+			pagecache_put(page);
+			handled = false;
+		}
+		else
+			mapping->pages[i] = page;
+	}
+
+	//Private Page beim ersten Schreibzugriff kopieren. Ist sie schon kopiert, hat ein anderer Thread den Fault behandelt.
+	if(handled && write && page != MAPPING_PAGE_COPIED)
+	{
+		void *copy = vmm_SysAlloc(1);
+		if(copy == NULL)
+			handled = false;
+		else
+		{
+			memcpy(copy, page->data, MM_BLOCK_SIZE);
+			paddr_t phys = vmm_getPhysAddress(copy);
+			vmm_SysUnMap(copy, 1);
+			if(vmm_ChangeMap(address, phys, VMM_FLAGS_USER | VMM_FLAGS_WRITE | VMM_FLAGS_NX, 0) != 0)
+			{
+				pmm_Free(phys);
+				handled = false;
+			}
+			else
+			{
+				mapping->pages[i] = MAPPING_PAGE_COPIED;
+				pagecache_put(page);
+			}
+		}
+	}
+	semaphore_release(&mapping->lock);
+
+	return handled;
+}
+
+bool vfs_HandlePageFault(void *address, bool write)
+{
+	process_t *p = currentProcess;
+	ilist_node_t *node;
+	bool handled = false;
+
+	if(p == NULL)
+		return false;
+
+	address = (void*)((uintptr_t)address & ~(MM_BLOCK_SIZE - 1));
+	read_lock(&p->mappings_lock);
+	ilist_foreach(node, &p->mappings)
+	{
+		vfs_mapping_t *mapping = ILIST_ENTRY(node, vfs_mapping_t, node);
+		if(address >= mapping->start && address < mapping->start + mapping->size * MM_BLOCK_SIZE)
+		{
+			handled = faultMapping(mapping, address, write);
+			break;
+		}
 	}
-	if(streamid == -1ul)
+	read_unlock(&p->mappings_lock);
+
+	return handled;
+}
+
+/*
+ * Überträgt Daten von einem Stream in einen anderen, ohne sie in den Userspace zu kopieren.
+ * Dateien auf gemounteten Dateisystemen werden direkt aus den Pages des Page-Caches geschrieben,
+ * sonst wird über einen Puffer im Kernel kopiert.
+ * Parameter:	dst = reservierter Zielstream
+ * 				dst_start = Anfangsbyte im Ziel
+ * 				src = reservierter Quellstream
+ * 				src_start = Anfangsbyte in der Quelle
+ * 				length = Anzahl Bytes
+ * Rückgabe:	Anzahl übertragener Bytes
+ */
+static size_t spliceStream(vfs_stream_t *dst, uint64_t dst_start, vfs_stream_t *src, uint64_t src_start, size_t length)
+{
+	size_t done = 0;
+
+	if(!src->mode.read || src->mode.directory || !dst->mode.write)
 		return 0;
-	stream = malloc(sizeof(vfs_userspace_stream_t));
-	if(stream == NULL)
+
+	//Wenn Quelle und Ziel dieselbe Datei sind, könnte das Schreiben die Page verändern, aus der gerade geschrieben wird
+	if(src->node->type == TYPE_MOUNT && src->stream.res->file != NULL && src->stream.res->flags.read
+			&& !(dst->node->type == TYPE_MOUNT && dst->stream.res == src->stream.res))
+	{
+		while(done < length)
+		{
+			uint64_t offset = (src_start + done) % MM_BLOCK_SIZE;
+			size_t size = 0, written = 0;
+			pagecache_page_t *page = pagecache_get(src->stream.res, (src_start + done) / MM_BLOCK_SIZE, fillCachePage, src);
+			if(page == NULL)
+				break;
+
+			if(offset < page->valid)
+			{
+				size = page->valid - offset;
+				if(size > length - done)
+					size = length - done;
+				written = writeStream(dst, dst_start + done, size, page->data + offset);
+			}
+			pagecache_put(page);
+
+			done += written;
+			//Dateiende erreicht oder Ziel voll
+			if(written < size || offset + size < MM_BLOCK_SIZE)
+				break;
+		}
+		return done;
+	}
+
+	void *buffer = malloc(VFS_SPLICE_BUFFER);
+	if(buffer == NULL)
 		return 0;
-	stream->id = 2;
-	stream->mode = m;
-	stream->stream = streamid;
-	hashmap_set(p->streams, (void*)2, stream);
+	while(done < length)
+	{
+		size_t size = (length - done < VFS_SPLICE_BUFFER) ? length - done : VFS_SPLICE_BUFFER;
+		size_t sizeRead = readStream(src, src_start + done, size, buffer);
+		size_t written = writeStream(dst, dst_start + done, sizeRead, buffer);
+		done += written;
+		if(sizeRead < size || written < sizeRead)
+			break;
+	}
+	free(buffer);
+	return done;
+}
+
+size_t vfs_Splice(vfs_file_t dst_id, uint64_t dst_start, vfs_file_t src_id, uint64_t src_start, size_t length)
+{
+	vfs_stream_t *dst, *src;
+	size_t done = 0;
+
+	if((dst = getStream(dst_id)) == NULL)
+		return 0;
+	if((src = getStream(src_id)) != NULL)
+	{
+		done = spliceStream(dst, dst_start, src, src_start, length);
+		REFCOUNT_RELEASE(src);
+	}
+	REFCOUNT_RELEASE(dst);
+	return done;
+}
+
+//TODO: Erbe alle geöffneten Stream vom Vaterprozess
+int vfs_initUserspace(process_t *parent, process_t *p, const char *stdin, const char *stdout, const char *stderr)
+{
+	assert(p != NULL && ((parent == NULL && stdin != NULL && stdout != NULL && stderr != NULL) || parent != NULL));
+	if((p->fd_table = fdCreateTable()) == NULL)
+		return 0;
+
+	const char *paths[] = {stdin, stdout, stderr};
+	const vfs_mode_t modes[] = {
+			{.read = true},
+			{.write = true},
+			{.write = true}
+	};
+	vfs_file_t fd;
+	for(fd = 0; fd < 3; fd++)
+	{
+		vfs_stream_t *stream;
+		if(parent != NULL && paths[fd] == NULL)
+		{
+			vfs_stream_t *parent_stream = fdGet(parent->fd_table, fd);
+			assert(parent_stream != NULL);
+			stream = reopenStream(parent_stream, modes[fd]);
+			REFCOUNT_RELEASE(parent_stream);
+		}
+		else
+		{
+			stream = openStream(paths[fd], modes[fd]);
+		}
+		if(stream == NULL)
+		{
+			vfs_deinitUserspace(p);
+			return 0;
+		}
+		p->fd_table->array->streams[fd] = stream;
+	}
 	return 1;
 }
 
+/*
+ * Schliesst alle Streams eines Prozesses und gibt die Deskriptortabelle frei
+ * Parameter:	p = Prozess
+ */
+void vfs_deinitUserspace(process_t *p)
+{
+	vfs_fd_table_t *table = p->fd_table;
+	vfs_file_t fd;
+	ilist_node_t *node;
+
+	//Der Adressraum wird danach zerstört, die geteilten Pages werden dabei nicht freigegeben
+	write_lock(&p->mappings_lock);
+	while((node = ilist_pop_front(&p->mappings)) != NULL)
+		releaseMapping(ILIST_ENTRY(node, vfs_mapping_t, node));
+	write_unlock(&p->mappings_lock);
+
+	if(table == NULL)
+		return;
+	p->fd_table = NULL;
+
+	for(fd = 0; fd < table->array->size; fd++)
+	{
+		if(table->array->streams[fd] != NULL)
+			REFCOUNT_RELEASE(table->array->streams[fd]);
+	}
+	free(table->array);
+	free(table);
+}
+
 /*
  * Gibt die Metainformationen einer Datei zurück
  * Parameter:	stream = stream dessen Grösse abgefragt wird (muss eine Datei sein)
  * Rückgabe:	Grösse des Streams oder 0 bei Fehler
  */
-uint64_t vfs_getFileinfo(vfs_file_t streamid, vfs_fileinfo_t info)
+static uint64_t getStreamInfo(vfs_stream_t *stream, vfs_fileinfo_t info)
 {
-	vfs_stream_t *stream;
-
-	if(!LOCKED_RESULT(vfs_lock, hashmap_search(streams, (void*)streamid, (void**)&stream)))
-		return 0;
-
 	if(stream->node->type == TYPE_MOUNT && stream->stream.res->file != NULL)
 	{
+		cdi_fs_meta_t meta;
 		switch(info)
 		{
 			case VFS_INFO_FILESIZE:
-				return stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_SIZE);
+				meta = CDI_FS_META_SIZE;
 			break;
 			case VFS_INFO_USEDBLOCKS:
-				return stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_USEDBLOCKS);
+				meta = CDI_FS_META_USEDBLOCKS;
 			break;
 			case VFS_INFO_BLOCKSIZE:
-				return stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_BLOCKSZ);
+				meta = CDI_FS_META_BLOCKSZ;
 			break;
 			case VFS_INFO_CREATETIME:
-				return stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_CREATETIME);
+				meta = CDI_FS_META_CREATETIME;
 			break;
 			case VFS_INFO_ACCESSTIME:
-				return stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_ACCESSTIME);
+				meta = CDI_FS_META_ACCESSTIME;
 			break;
 			case VFS_INFO_CHANGETIME:
-				return stream->stream.res->res->meta_read(&stream->stream, CDI_FS_META_CHANGETIME);
+				meta = CDI_FS_META_CHANGETIME;
 			break;
+			default:
+				return 0;
 		}
+
+		semaphore_acquire(&stream->lock);
+		uint64_t value = stream->stream.res->res->meta_read(&stream->stream, meta);
+		semaphore_release(&stream->lock);
+		return value;
 	}
 
 	return 0;
 }
 
+uint64_t vfs_getFileinfo(vfs_file_t streamid, vfs_fileinfo_t info)
+{
+	vfs_stream_t *stream;
+
+	if((stream = getStream(streamid)) == NULL)
+		return 0;
+
+	uint64_t value = getStreamInfo(stream, info);
+	REFCOUNT_RELEASE(stream);
+	return value;
+}
+
 
 /*
  * Mountet ein Dateisystem (fs) an den entsprechenden Mountpoint (Mount)
@@ -1140,6 +1954,7 @@ int vfs_Unmount(const char *Mount)
 		return 1;
 
 	//FS deinitialisieren
+	forgetRes(mount->fs->root_res);
 	mount->fs->driver->fs_destroy(mount->fs);
 
 	deleteNode(mount);
@@ -1205,66 +2020,228 @@ void vfs_RegisterDevice(vfs_device_t *dev)
 	createDeviceNode(tmp, dev->getValue(dev->opaque, FUNC_NAME), dev);
 }
 
+/*
+ * Registriert eine Datei mit Systeminformationen. Dazu wird eine Datei im Verzeichniss /sysinf angelegt.
+ * Parameter:	name = Name der Datei
+ * 				read = Handler zum Lesen der Datei (kann NULL sein)
+ * 				write = Handler zum Schreiben der Datei (kann NULL sein)
+ */
+void vfs_RegisterInfoFile(const char *name, vfs_file_read_handler_t *read, vfs_file_write_handler_t *write)
+{
+	const char *Path = "/sysinf";
+	vfs_node_t *tmp;
+	if(!(tmp = getNode(Path))) return;	//Fehler
+
+	createFileNode(tmp, name, read, write);
+}
+
 //Syscalls
 //TODO: Define errors correctly via macros
 vfs_file_t vfs_syscall_open(const char *path, vfs_mode_t mode)
 {
 	assert(currentProcess != NULL);
-	vfs_userspace_stream_t *stream = malloc(sizeof(vfs_userspace_stream_t));
+	vfs_stream_t *stream = openStream(path, mode);
 	if(stream == NULL)
 		return -1;
-	vfs_file_t streamid = vfs_Open(path, mode);
-	if(streamid == -1ul)
-	{
-		free(stream);
-		return -1;
-	}
-	stream->id = getNextUserspaceStreamID(currentProcess);
-	stream->mode = mode;
-	stream->stream = streamid;
-	LOCKED_TASK(currentProcess->lock, hashmap_set(currentProcess->streams, (void*)stream->id, stream));
-	assert(LOCKED_RESULT(currentProcess->lock, hashmap_search(currentProcess->streams, (void*)stream->id, NULL)));
-	return stream->id;
+
+	vfs_file_t fd = fdAlloc(currentProcess->fd_table, stream);
+	if(fd == -1ul)
+		REFCOUNT_RELEASE(stream);
+	return fd;
 }
 
 void vfs_syscall_close(vfs_file_t streamid)
 {
 	assert(currentProcess != NULL);
-	LOCKED_TASK(currentProcess->lock, hashmap_delete(currentProcess->streams, (void*)streamid));
+	vfs_stream_t *stream = fdRemove(currentProcess->fd_table, streamid);
+	if(stream != NULL)
+		REFCOUNT_RELEASE(stream);
 }
 
 size_t vfs_syscall_read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer)
 {
-	vfs_userspace_stream_t *stream;
+	vfs_stream_t *stream;
 	assert(currentProcess != NULL);
-	if(!LOCKED_RESULT(currentProcess->lock, hashmap_search(currentProcess->streams, (void*)streamid, (void**)&stream)))
+	if(buffer == NULL || !vmm_userspacePointerValid(buffer, length))
 		return 0;
-	if(!vmm_userspacePointerValid(buffer, length))
+	if((stream = fdGet(currentProcess->fd_table, streamid)) == NULL)
 		return 0;
-	if(!stream->mode.read)
-		return 0;
-	return vfs_Read(stream->stream, start, length, buffer);
+	size_t sizeRead = readStream(stream, start, length, buffer);
+	REFCOUNT_RELEASE(stream);
+	return sizeRead;
 }
 
 size_t vfs_syscall_write(vfs_file_t streamid, uint64_t start, size_t length, const void *buffer)
 {
-	vfs_userspace_stream_t *stream;
+	vfs_stream_t *stream;
 	assert(currentProcess != NULL);
-	if(!LOCKED_RESULT(currentProcess->lock, hashmap_search(currentProcess->streams, (void*)streamid, (void**)&stream)))
+	if(buffer == NULL || !vmm_userspacePointerValid(buffer, length))
 		return 0;
-	if(!vmm_userspacePointerValid(buffer, length))
+	if((stream = fdGet(currentProcess->fd_table, streamid)) == NULL)
 		return 0;
-	if(!stream->mode.write)
+	size_t sizeWritten = writeStream(stream, start, length, buffer);
+	REFCOUNT_RELEASE(stream);
+	return sizeWritten;
+}
+
+/*
+ * Kopiert die Pufferliste aus dem Userspace und prüft alle Puffer
+ * Rückgabe:	Kopie der Liste, die mit free freigegeben werden muss, oder NULL, wenn die Liste ungültig ist
+ */
+static vfs_iovec_t *copyUserspaceIovec(const vfs_iovec_t *iov, size_t count)
+{
+	vfs_iovec_t *dest;
+	size_t i;
+
+	if(iov == NULL || count == 0 || count > VFS_IOV_MAX || !vmm_userspacePointerValid(iov, count * sizeof(vfs_iovec_t)))
+		return NULL;
+
+	if((dest = malloc(count * sizeof(vfs_iovec_t))) == NULL)
+		return NULL;
+	memcpy(dest, iov, count * sizeof(vfs_iovec_t));
+	for(i = 0; i < count; i++)
+	{
+		if(dest[i].base == NULL || !vmm_userspacePointerValid(dest[i].base, dest[i].length))
+		{
+			free(dest);
+			return NULL;
+		}
+	}
+	return dest;
+}
+
+size_t vfs_syscall_readv(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	vfs_iovec_t *kernel_iov;
+	vfs_stream_t *stream;
+	assert(currentProcess != NULL);
+	if((kernel_iov = copyUserspaceIovec(iov, count)) == NULL)
+		return 0;
+	if((stream = fdGet(currentProcess->fd_table, streamid)) == NULL)
+	{
+		free(kernel_iov);
+		return 0;
+	}
+	size_t sizeRead = readvStream(stream, start, kernel_iov, count);
+	REFCOUNT_RELEASE(stream);
+	free(kernel_iov);
+	return sizeRead;
+}
+
+size_t vfs_syscall_writev(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count)
+{
+	vfs_iovec_t *kernel_iov;
+	vfs_stream_t *stream;
+	assert(currentProcess != NULL);
+	if((kernel_iov = copyUserspaceIovec(iov, count)) == NULL)
+		return 0;
+	if((stream = fdGet(currentProcess->fd_table, streamid)) == NULL)
+	{
+		free(kernel_iov);
 		return 0;
-	return vfs_Write(stream->stream, start, length, buffer);
+	}
+	size_t sizeWritten = writevStream(stream, start, kernel_iov, count);
+	REFCOUNT_RELEASE(stream);
+	free(kernel_iov);
+	return sizeWritten;
 }
 
 uint64_t vfs_syscall_getFileinfo(vfs_file_t streamid, vfs_fileinfo_t info)
 {
-	vfs_userspace_stream_t *stream;
+	vfs_stream_t *stream;
 	assert(currentProcess != NULL);
-	if(!LOCKED_RESULT(currentProcess->lock, hashmap_search(currentProcess->streams, (void*)streamid, (void**)&stream)))
+	if((stream = fdGet(currentProcess->fd_table, streamid)) == NULL)
 		return 0;
-	return vfs_getFileinfo(stream->stream, info);
+	uint64_t value = getStreamInfo(stream, info);
+	REFCOUNT_RELEASE(stream);
+	return value;
+}
+
+size_t vfs_syscall_splice(vfs_file_t dst_id, uint64_t dst_start, vfs_file_t src_id, uint64_t src_start, size_t length)
+{
+	vfs_stream_t *dst, *src;
+	size_t done = 0;
+	assert(currentProcess != NULL);
+	if((dst = fdGet(currentProcess->fd_table, dst_id)) == NULL)
+		return 0;
+	if((src = fdGet(currentProcess->fd_table, src_id)) != NULL)
+	{
+		done = spliceStream(dst, dst_start, src, src_start, length);
+		REFCOUNT_RELEASE(src);
+	}
+	REFCOUNT_RELEASE(dst);
+	return done;
+}
+
+void *vfs_syscall_mmap(vfs_file_t streamid, uint64_t offset, size_t length, uint64_t flags)
+{
+	vfs_stream_t *stream;
+	vfs_mapping_t *mapping;
+	assert(currentProcess != NULL);
+	if(length == 0 || offset % MM_BLOCK_SIZE != 0)
+		return NULL;
+	if((stream = fdGet(currentProcess->fd_table, streamid)) == NULL)
+		return NULL;
+
+	//Nur Dateien auf gemounteten Dateisystemen können gemappt werden
+	if(stream->node->type != TYPE_MOUNT || stream->mode.directory || !stream->mode.read
+			|| stream->stream.res->file == NULL || !stream->stream.res->flags.read)
+	{
+		REFCOUNT_RELEASE(stream);
+		return NULL;
+	}
+
+	size_t size = (length + MM_BLOCK_SIZE - 1) / MM_BLOCK_SIZE;
+	mapping = calloc(1, sizeof(vfs_mapping_t) + size * sizeof(pagecache_page_t*));
+	if(mapping == NULL)
+	{
+		REFCOUNT_RELEASE(stream);
+		return NULL;
+	}
+	//Die Pages werden erst beim ersten Zugriff eingeblendet
+	if((mapping->start = vmm_Alloc(size)) == NULL)
+	{
+		free(mapping);
+		REFCOUNT_RELEASE(stream);
+		return NULL;
+	}
+	mapping->size = size;
+	mapping->index = offset / MM_BLOCK_SIZE;
+	mapping->private = flags & VFS_MMAP_PRIVATE;
+	mapping->stream = stream;
+	semaphore_init(&mapping->lock, 1);
+
+	write_lock(&currentProcess->mappings_lock);
+	ilist_push_back(&currentProcess->mappings, &mapping->node);
+	write_unlock(&currentProcess->mappings_lock);
+
+	return mapping->start;
+}
+
+int vfs_syscall_munmap(void *address)
+{
+	vfs_mapping_t *mapping = NULL;
+	ilist_node_t *node;
+	assert(currentProcess != NULL);
+
+	write_lock(&currentProcess->mappings_lock);
+	ilist_foreach(node, &currentProcess->mappings)
+	{
+		if(ILIST_ENTRY(node, vfs_mapping_t, node)->start == address)
+		{
+			mapping = ILIST_ENTRY(node, vfs_mapping_t, node);
+			ilist_remove(&currentProcess->mappings, node);
+			break;
+		}
+	}
+	write_unlock(&currentProcess->mappings_lock);
+
+	if(mapping == NULL)
+		return -1;
+
+	//Gibt nur die kopierten Pages frei, die Pages aus dem Cache werden danach freigegeben
+	vmm_Free(mapping->start, mapping->size);
+	releaseMapping(mapping);
+	return 0;
 }
 #endif
@@ -18,6 +18,11 @@
 #define VFS_SEPARATOR	'/'
 #define VFS_ROOT		"/"
 
+#define VFS_IOV_MAX		64		//Maximale Anzahl Puffer für readv/writev
+
+#define VFS_MMAP_SHARED		0x0		//Abbildung zeigt direkt auf den Page-Cache, nur lesbar
+#define VFS_MMAP_PRIVATE	0x1		//Pages werden beim ersten Schreibzugriff kopiert
+
 #define VFS_DEVICE_STORAGE		"STORAGE"
 #define VFS_DEVICE_PARTITION	"PARTITION"
 #define VFS_DEVICE_VIRTUAL		"VIRTUAL"
@@ -35,15 +40,27 @@ typedef enum{
 	FUNC_TYPE, FUNC_NAME, FUNC_DATA
 }vfs_device_function_t;
 
+//Puffersegment für vektorisierte Ein-/Ausgabe
+typedef struct cdi_fs_iovec vfs_iovec_t;
+
 //Handler für Geräte
 typedef size_t (vfs_device_read_handler_t)(void *opaque, uint64_t start, size_t size, void *buffer);
 typedef size_t (vfs_device_write_handler_t)(void *opaque, uint64_t start, size_t size, const void *buffer);
+typedef size_t (vfs_device_readv_handler_t)(void *opaque, uint64_t start, const vfs_iovec_t *iov, size_t count);
+typedef size_t (vfs_device_writev_handler_t)(void *opaque, uint64_t start, const vfs_iovec_t *iov, size_t count);
 typedef void *(vfs_device_getValue_handler_t)(void *opaque, vfs_device_function_t function);
 
+//Handler für virtuelle Dateien
+typedef size_t (vfs_file_read_handler_t)(const char *name, uint64_t start, size_t length, void *buffer);
+typedef size_t (vfs_file_write_handler_t)(const char *name, uint64_t start, size_t length, const void *buffer);
+
 typedef struct{
 	//Functionen zum Lesen und Schreiben
 	vfs_device_read_handler_t *read;
 	vfs_device_write_handler_t *write;
+	//Vektorisiert (können NULL sein, dann wird read bzw. write für jeden Puffer aufgerufen)
+	vfs_device_readv_handler_t *readv;
+	vfs_device_writev_handler_t *writev;
 
 	//Hiermit können verschiedene Werte ausgelesen werden
 	vfs_device_getValue_handler_t *getValue;
@@ -84,14 +101,51 @@ void vfs_Close(vfs_file_t streamid);
 size_t vfs_Read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer);
 size_t vfs_Write(vfs_file_t streamid, uint64_t start, size_t length, const void *buffer);
 
+/*
+ * Liest zusammenhängende Daten ab start in mehrere Puffer bzw. schreibt sie aus mehreren Puffern
+ * Parameter:	streamid = Stream
+ * 				start = Anfangsbyte
+ * 				iov = Puffer, die nacheinander gefüllt bzw. geschrieben werden
+ * 				count = Anzahl Puffer (höchstens VFS_IOV_MAX)
+ * Rückgabe:	Anzahl gelesener bzw. geschriebener Bytes
+ */
+size_t vfs_Readv(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count);
+size_t vfs_Writev(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count);
+
+/*
+ * Überträgt Daten von einem Stream in einen anderen, ohne Umweg über einen Puffer des Aufrufers
+ * Parameter:	dst_id = Zielstream
+ * 				dst_start = Anfangsbyte im Ziel
+ * 				src_id = Quellstream
+ * 				src_start = Anfangsbyte in der Quelle
+ * 				length = Anzahl Bytes
+ * Rückgabe:	Anzahl übertragener Bytes
+ */
+size_t vfs_Splice(vfs_file_t dst_id, uint64_t dst_start, vfs_file_t src_id, uint64_t src_start, size_t length);
+
 /*
  * Initialisiert den Userspace des Prozesses p.
  * Parameter:	p = Prozess
- * Rückgabe:	0: kein Fehler
- * 				1: Fehler
+ * Rückgabe:	1: kein Fehler
+ * 				0: Fehler
  */
 int vfs_initUserspace(process_t *parent, process_t *p, const char *stdin, const char *stdout, const char *stderr);
 
+/*
+ * Schliesst alle Streams des Prozesses p und gibt seine Deskriptortabelle frei.
+ * Parameter:	p = Prozess
+ */
+void vfs_deinitUserspace(process_t *p);
+
+/*
+ * Behandelt einen Page Fault in einer gemappten Datei des aktuellen Prozesses. Kann auf das
+ * Laden der Page warten.
+ * Parameter:	address = Adresse, auf die zugegriffen wurde
+ * 				write = Schreibzugriff
+ * Rückgabe:	true, wenn der Fault behandelt wurde
+ */
+bool vfs_HandlePageFault(void *address, bool write);
+
 uint64_t vfs_getFileinfo(vfs_file_t streamid, vfs_fileinfo_t info);
 
 int vfs_Mount(const char *Mountpath, const char *Dev);
@@ -110,12 +164,25 @@ void vfs_RegisterDevice(vfs_device_t *dev);
  */
 void vfs_UnregisterDevice(vfs_device_t *dev);
 
+/*
+ * Datei mit Systeminformationen unter /sysinf anlegen
+ * Parameter:	name = Name der Datei
+ * 				read = Handler zum Lesen
+ * 				write = Handler zum Schreiben
+ */
+void vfs_RegisterInfoFile(const char *name, vfs_file_read_handler_t *read, vfs_file_write_handler_t *write);
+
 //Syscalls
 vfs_file_t vfs_syscall_open(const char *path, vfs_mode_t mode);
 void vfs_syscall_close(vfs_file_t streamid);
 size_t vfs_syscall_read(vfs_file_t streamid, uint64_t start, size_t length, void *buffer);
 size_t vfs_syscall_write(vfs_file_t streamid, uint64_t start, size_t length, const void *buffer);
+size_t vfs_syscall_readv(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count);
+size_t vfs_syscall_writev(vfs_file_t streamid, uint64_t start, const vfs_iovec_t *iov, size_t count);
 uint64_t vfs_syscall_getFileinfo(vfs_file_t streamid, vfs_fileinfo_t info);
+size_t vfs_syscall_splice(vfs_file_t dst_id, uint64_t dst_start, vfs_file_t src_id, uint64_t src_start, size_t length);
+void *vfs_syscall_mmap(vfs_file_t streamid, uint64_t offset, size_t length, uint64_t flags);
+int vfs_syscall_munmap(void *address);
 
 #endif /* VFS_H_ */
 